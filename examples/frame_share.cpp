@@ -0,0 +1,206 @@
+// Shared decoded frames: one process decodes a video and publishes every frame into a
+// shared-memory pool, any number of subscriber processes map the frames read-only.
+// Subscribers compute the mean luma of each frame in place as stand-in analytics work.
+//
+// Usage: frame_share.exe publish <video file> [--name N] [--slots N] [--loop] [--loglevel level]
+//        frame_share.exe subscribe [--name N] [--mode next|latest] [--work-ms N] [--loglevel level]
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <VideoCapture.h>
+#include <Logger.h>
+#include "../src/FramePublisher.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+using Microsoft::WRL::ComPtr;
+using Clock = std::chrono::steady_clock;
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+int RunPublisher(const std::string& filePath, const std::string& name, int slots, bool loop) {
+    // Headless D3D11 device for decoding
+    ComPtr<ID3D11Device> device;
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                                   nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+    if (FAILED(hr) || !VideoCapture::Initialize(device.Get())) {
+        std::cerr << "Failed to initialize D3D11 video decoding" << std::endl;
+        return 1;
+    }
+
+    VideoCapture capture;
+    if (!capture.open(filePath)) {
+        std::cerr << "Failed to open " << filePath << std::endl;
+        return 1;
+    }
+
+    int width = static_cast<int>(capture.get(CAP_PROP_FRAME_WIDTH));
+    int height = static_cast<int>(capture.get(CAP_PROP_FRAME_HEIGHT));
+    double fps = capture.get(CAP_PROP_FPS);
+    auto frameInterval = std::chrono::duration<double>(fps > 0.0 ? 1.0 / fps : 1.0 / 30.0);
+
+    FramePublisher publisher;
+    Clock::time_point start = Clock::now();
+    Clock::time_point lastReport = start;
+    uint64_t frames = 0;
+
+    std::cout << "Publishing " << width << "x" << height << " @ " << fps << " fps as " << name << std::endl;
+
+    while (true) {
+        ID3D11Texture2D* texture = nullptr;
+        bool isYUV = false;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        if (!capture.read(&texture, isYUV, format)) {
+            if (loop && capture.set(CAP_PROP_POS_FRAMES, 0)) {
+                continue;
+            }
+            break;
+        }
+
+        // The pool format follows the decoder output
+        if (!publisher.IsOpen() && !publisher.Create(name, width, height, format, slots)) {
+            texture->Release();
+            return 1;
+        }
+
+        bool published = publisher.PublishTexture(texture, capture.get(CAP_PROP_POS_MSEC) / 1000.0);
+        texture->Release();
+        if (!published) {
+            return 1;
+        }
+        frames++;
+
+        // Real-time pacing, so subscribers see a live stream
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(frameInterval * static_cast<double>(frames)));
+
+        if (Clock::now() - lastReport >= std::chrono::seconds(1)) {
+            FramePublisher::Stats stats = publisher.GetStats();
+            std::cout << "Published " << stats.framesPublished << " frames, readback "
+                      << std::fixed << std::setprecision(2) << stats.readbackMs / std::max<uint64_t>(1, stats.framesPublished)
+                      << " ms/frame" << std::endl;
+            lastReport = Clock::now();
+        }
+    }
+
+    publisher.Close();
+    std::cout << "Published " << frames << " frames" << std::endl;
+    return 0;
+}
+
+int RunSubscriber(const std::string& name, bool latestOnly, int workMs) {
+    FrameSubscriber subscriber;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(30);
+    while (!subscriber.Open(name)) {
+        if (Clock::now() > deadline) {
+            std::cerr << "No frame pool named " << name << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    Clock::time_point lastReport = Clock::now();
+    uint64_t processed = 0;
+    double lumaSum = 0.0;
+
+    while (subscriber.WaitForFrame(5000)) {
+        SharedFrame frame;
+        while (latestOnly ? subscriber.AcquireLatest(frame) : subscriber.AcquireNext(frame)) {
+            // Mean luma, read straight from shared memory (P010 keeps 10 bits in the high bits)
+            uint64_t sum = 0;
+            bool wide = frame.format == DXGI_FORMAT_P010;
+            for (int y = 0; y < frame.height; y++) {
+                const uint8_t* row = frame.planes[0] + static_cast<size_t>(y) * frame.strides[0];
+                for (int x = 0; x < frame.width; x++) {
+                    sum += wide ? (reinterpret_cast<const uint16_t*>(row)[x] >> 8) : row[x];
+                }
+            }
+            if (workMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(workMs));
+            }
+
+            // Discard the result if the publisher overwrote the slot meanwhile
+            if (subscriber.IsValid(frame)) {
+                lumaSum += static_cast<double>(sum) / (static_cast<double>(frame.width) * frame.height);
+                processed++;
+            }
+            if (latestOnly) {
+                break;
+            }
+        }
+
+        if (Clock::now() - lastReport >= std::chrono::seconds(1)) {
+            FrameSubscriber::Stats stats = subscriber.GetStats();
+            std::cout << "Processed " << processed << " frames (mean luma "
+                      << std::fixed << std::setprecision(1) << lumaSum / std::max<uint64_t>(1, processed)
+                      << "), skipped " << stats.framesSkipped << ", overwritten " << stats.framesTorn << std::endl;
+            lastReport = Clock::now();
+        }
+    }
+
+    std::cout << (subscriber.IsPublisherClosed() ? "Publisher closed" : "No frames for 5 s") << ", processed "
+              << processed << " frames" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: frame_share publish <video file> [--name N] [--slots N] [--loop] [--loglevel level]" << std::endl;
+        std::cerr << "       frame_share subscribe [--name N] [--mode next|latest] [--work-ms N] [--loglevel level]" << std::endl;
+        return 2;
+    }
+
+    std::string role = argv[1];
+    std::string filePath;
+    std::string name = "Local\\videocapture_frames";
+    int slots = 8;
+    bool loop = false;
+    bool latestOnly = false;
+    int workMs = 0;
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) {
+            name = argv[++i];
+        } else if (arg == "--slots" && i + 1 < argc) {
+            slots = atoi(argv[++i]);
+        } else if (arg == "--loop") {
+            loop = true;
+        } else if (arg == "--mode" && i + 1 < argc) {
+            latestOnly = std::string(argv[++i]) == "latest";
+        } else if (arg == "--work-ms" && i + 1 < argc) {
+            workMs = atoi(argv[++i]);
+        } else if (arg == "--loglevel" && i + 1 < argc) {
+            logLevel = ParseLogLevel(argv[++i]);
+        } else {
+            filePath = arg;
+        }
+    }
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    if (role == "publish" && !filePath.empty()) {
+        return RunPublisher(filePath, name, slots, loop);
+    }
+    if (role == "subscribe") {
+        return RunSubscriber(name, latestOnly, workMs);
+    }
+
+    std::cerr << "Unknown role or missing video file" << std::endl;
+    return 2;
+}
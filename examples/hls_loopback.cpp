@@ -0,0 +1,428 @@
+// Loopback HLS benchmark: serves a directory of HLS playlists and segments from an in-process
+// HTTP server with configurable per-request latency and bandwidth, then plays it twice in real
+// time, once through libavformat's hls demuxer (VideoCapture::open(url)) and once through
+// AdaptiveStreamDataSource, and compares startup time and stalls. Runs headless.
+//
+// Usage: hls_loopback.exe <directory> [--playlist name] [--seconds N] [--latency ms]
+//                         [--bandwidth mbit] [--prefetch N] [--port N] [--loglevel level]
+//
+// Create the directory with e.g.
+//   ffmpeg -i video.mp4 -c copy -f hls -hls_time 2 -hls_playlist_type vod dir/index.m3u8
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <VideoCapture.h>
+#include <Logger.h>
+#include "../src/AdaptiveStreamDataSource.h"
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+#pragma comment(lib, "ws2_32.lib")
+
+using Microsoft::WRL::ComPtr;
+using Clock = std::chrono::steady_clock;
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+// Minimal HTTP/1.1 file server: GET only, one thread and one request per connection, each
+// response delayed by a fixed latency and paced to a per-connection bandwidth
+class LoopbackHttpServer {
+public:
+    LoopbackHttpServer()
+        : m_listenSocket(INVALID_SOCKET)
+        , m_port(0)
+        , m_latencyMs(0)
+        , m_bandwidthMbit(0.0)
+        , m_running(false)
+        , m_requests(0)
+        , m_bytesSent(0)
+    {
+    }
+
+    ~LoopbackHttpServer() {
+        Stop();
+    }
+
+    bool Start(const std::string& directory, int port, int latencyMs, double bandwidthMbit) {
+        m_directory = directory;
+        m_port = port;
+        m_latencyMs = latencyMs;
+        m_bandwidthMbit = bandwidthMbit;
+
+        m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (m_listenSocket == INVALID_SOCKET) {
+            std::cerr << "socket() failed: " << WSAGetLastError() << std::endl;
+            return false;
+        }
+
+        BOOL reuse = TRUE;
+        setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<u_short>(port));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+            listen(m_listenSocket, SOMAXCONN) == SOCKET_ERROR) {
+            std::cerr << "Cannot listen on 127.0.0.1:" << port << ": " << WSAGetLastError() << std::endl;
+            closesocket(m_listenSocket);
+            m_listenSocket = INVALID_SOCKET;
+            return false;
+        }
+
+        m_running = true;
+        m_acceptThread = std::thread(&LoopbackHttpServer::AcceptLoop, this);
+        return true;
+    }
+
+    void Stop() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        closesocket(m_listenSocket);
+        if (m_acceptThread.joinable()) {
+            m_acceptThread.join();
+        }
+        m_listenSocket = INVALID_SOCKET;
+
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        for (std::thread& connection : m_connections) {
+            connection.join();
+        }
+        m_connections.clear();
+    }
+
+    std::string GetUrl(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(m_port) + "/" + path;
+    }
+
+    uint64_t GetRequests() const { return m_requests; }
+    uint64_t GetBytesSent() const { return m_bytesSent; }
+
+private:
+    SOCKET m_listenSocket;
+    std::string m_directory;
+    int m_port;
+    int m_latencyMs;
+    double m_bandwidthMbit;
+    std::atomic<bool> m_running;
+    std::thread m_acceptThread;
+    std::mutex m_connectionsMutex;
+    std::vector<std::thread> m_connections;
+    std::atomic<uint64_t> m_requests;
+    std::atomic<uint64_t> m_bytesSent;
+
+    void AcceptLoop() {
+        while (m_running) {
+            SOCKET client = accept(m_listenSocket, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_connectionsMutex);
+            m_connections.emplace_back(&LoopbackHttpServer::HandleConnection, this, client);
+        }
+    }
+
+    void HandleConnection(SOCKET client) {
+        std::string request;
+        char buffer[4096];
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            int received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                closesocket(client);
+                return;
+            }
+            request.append(buffer, received);
+        }
+        m_requests++;
+
+        std::istringstream stream(request);
+        std::string method, target;
+        stream >> method >> target;
+
+        // Path below the served directory, without query string
+        std::string path = target.substr(0, target.find('?'));
+        path.erase(0, path.find_first_not_of('/'));
+
+        std::vector<char> body;
+        int status = 200;
+        if (method != "GET") {
+            status = 501;
+        } else if (path.empty() || path.find("..") != std::string::npos || !ReadFile(m_directory + "/" + path, body)) {
+            status = 404;
+        }
+
+        // Round trip of a distant server
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_latencyMs));
+
+        std::string header = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : status == 404 ? " Not Found" : " Not Implemented");
+        header += "\r\nContent-Type: " + ContentType(path);
+        header += "\r\nContent-Length: " + std::to_string(body.size());
+        header += "\r\nConnection: close\r\n\r\n";
+
+        if (SendAll(client, header.data(), header.size())) {
+            SendPaced(client, body);
+        }
+
+        shutdown(client, SD_SEND);
+        closesocket(client);
+    }
+
+    // Send in chunks at the configured bandwidth (unlimited when 0)
+    void SendPaced(SOCKET client, const std::vector<char>& body) {
+        const size_t CHUNK_SIZE = 16 * 1024;
+        Clock::time_point start = Clock::now();
+        size_t sent = 0;
+        while (sent < body.size() && m_running) {
+            size_t chunk = std::min(CHUNK_SIZE, body.size() - sent);
+            if (!SendAll(client, body.data() + sent, chunk)) {
+                return;
+            }
+            sent += chunk;
+            m_bytesSent += chunk;
+
+            if (m_bandwidthMbit > 0.0) {
+                double due = sent * 8.0 / (m_bandwidthMbit * 1e6);
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(due)));
+            }
+        }
+    }
+
+    static bool ReadFile(const std::string& path, std::vector<char>& data) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    static std::string ContentType(const std::string& path) {
+        auto endsWith = [&path](const char* suffix) {
+            size_t length = strlen(suffix);
+            return path.size() >= length && path.compare(path.size() - length, length, suffix) == 0;
+        };
+        if (endsWith(".m3u8")) return "application/vnd.apple.mpegurl";
+        if (endsWith(".mpd")) return "application/dash+xml";
+        if (endsWith(".ts")) return "video/mp2t";
+        if (endsWith(".m4s") || endsWith(".mp4")) return "video/mp4";
+        return "application/octet-stream";
+    }
+
+    static bool SendAll(SOCKET socket, const char* data, size_t size) {
+        while (size > 0) {
+            int sent = send(socket, data, static_cast<int>(size), 0);
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+};
+
+struct PlaybackResult {
+    bool opened = false;
+    uint64_t frames = 0;
+    double startupMs = -1.0;        // open() until the first frame
+    uint64_t stalls = 0;            // Frames that arrived after their presentation time
+    double stallTimeMs = 0.0;       // Playback time lost waiting for them
+};
+
+// Play in real time: each frame is due at its presentation time on a clock that starts with
+// the first frame and stops while playback waits for a late frame
+PlaybackResult Play(VideoCapture& capture, double seconds, Clock::time_point openStart) {
+    const double STALL_TOLERANCE = 0.05; // Seconds a frame may be late without counting as a stall
+    PlaybackResult result;
+    result.opened = true;
+
+    Clock::time_point clockStart;
+    double firstPresentation = 0.0;
+    double stalled = 0.0;
+
+    while (true) {
+        ID3D11Texture2D* texture = nullptr;
+        bool isYUV = false;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        if (!capture.read(&texture, isYUV, format)) {
+            break;
+        }
+        if (texture) {
+            texture->Release();
+        }
+
+        Clock::time_point now = Clock::now();
+        double presentation = capture.get(CAP_PROP_POS_MSEC) / 1000.0;
+        if (result.frames++ == 0) {
+            result.startupMs = std::chrono::duration<double, std::milli>(now - openStart).count();
+            clockStart = now;
+            firstPresentation = presentation;
+            continue;
+        }
+
+        double playback = presentation - firstPresentation;
+        if (playback >= seconds) {
+            break;
+        }
+
+        double due = playback + stalled;
+        double late = std::chrono::duration<double>(now - clockStart).count() - due;
+        if (late > STALL_TOLERANCE) {
+            result.stalls++;
+            result.stallTimeMs += late * 1000.0;
+            stalled += late;
+        } else if (late < 0.0) {
+            std::this_thread::sleep_until(clockStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(due)));
+        }
+    }
+
+    return result;
+}
+
+void PrintResult(const char* name, const PlaybackResult& result) {
+    std::cout << name << std::endl;
+    if (!result.opened) {
+        std::cout << "  failed to open" << std::endl;
+        return;
+    }
+    std::cout << "  Frames:             " << result.frames << std::endl;
+    std::cout << "  Startup (first frame): " << result.startupMs << " ms" << std::endl;
+    std::cout << "  Stalls:             " << result.stalls << " (" << result.stallTimeMs << " ms)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory;
+    std::string playlist = "index.m3u8";
+    double seconds = 20.0;
+    int latencyMs = 100;
+    double bandwidthMbit = 20.0;
+    int prefetch = 3;
+    int port = 8080;
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--playlist" && i + 1 < argc) {
+            playlist = argv[++i];
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--latency" && i + 1 < argc) {
+            latencyMs = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--bandwidth" && i + 1 < argc) {
+            bandwidthMbit = atof(argv[++i]);
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            prefetch = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--loglevel" && i + 1 < argc) {
+            logLevel = ParseLogLevel(argv[++i]);
+        } else {
+            directory = arg;
+        }
+    }
+
+    if (directory.empty()) {
+        std::cerr << "Usage: hls_loopback <directory> [--playlist name] [--seconds N] [--latency ms]"
+                     " [--bandwidth mbit] [--prefetch N] [--port N] [--loglevel level]" << std::endl;
+        return 2;
+    }
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "WSAStartup failed" << std::endl;
+        return 1;
+    }
+
+    // Headless D3D11 device for decoding
+    ComPtr<ID3D11Device> device;
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                                   nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+    if (FAILED(hr) || !VideoCapture::Initialize(device.Get())) {
+        std::cerr << "Failed to initialize D3D11 video decoding" << std::endl;
+        WSACleanup();
+        return 1;
+    }
+
+    LoopbackHttpServer server;
+    if (!server.Start(directory, port, latencyMs, bandwidthMbit)) {
+        WSACleanup();
+        return 1;
+    }
+    std::string url = server.GetUrl(playlist);
+    std::cout << "Serving " << directory << " at " << url << " (" << latencyMs << " ms latency, "
+              << (bandwidthMbit > 0.0 ? std::to_string(bandwidthMbit) + " Mbit/s" : std::string("unlimited"))
+              << " per connection)" << std::endl;
+
+    // libavformat's hls demuxer: segments are downloaded one after another as they are read
+    PlaybackResult hls;
+    uint64_t hlsRequests = 0;
+    {
+        Clock::time_point openStart = Clock::now();
+        VideoCapture capture;
+        if (capture.open(url)) {
+            hls = Play(capture, seconds, openStart);
+        }
+        capture.release();
+        hlsRequests = server.GetRequests();
+    }
+
+    // AdaptiveStreamDataSource: segments are prefetched in parallel
+    PlaybackResult adaptive;
+    AdaptiveStreamDataSource::Stats adaptiveStats;
+    {
+        Clock::time_point openStart = Clock::now();
+        AdaptiveStreamDataSource source;
+        source.SetPrefetchCount(prefetch);
+        source.SetFetchThreads(prefetch);
+        VideoCapture capture;
+        if (source.Open(url) && capture.open(&source, source.GetFormatHint())) {
+            adaptive = Play(capture, seconds, openStart);
+        }
+        capture.release();
+        adaptiveStats = source.GetStats();
+        source.Close();
+    }
+
+    server.Stop();
+    WSACleanup();
+
+    PrintResult("libavformat hls demuxer", hls);
+    std::cout << "  HTTP requests:      " << hlsRequests << std::endl;
+    PrintResult("AdaptiveStreamDataSource", adaptive);
+    std::cout << "  HTTP requests:      " << server.GetRequests() - hlsRequests << std::endl;
+    std::cout << "  Source startup:     " << adaptiveStats.startupTimeMs << " ms to the first media byte" << std::endl;
+    std::cout << "  Source stalls:      " << adaptiveStats.stalls << " reads (" << adaptiveStats.stallTimeMs
+              << " ms), " << adaptiveStats.segmentsFailed << " segments failed" << std::endl;
+
+    bool passed = hls.frames > 0 && adaptive.frames > 0;
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
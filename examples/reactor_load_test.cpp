@@ -0,0 +1,275 @@
+// NetworkReactor load test: hundreds of synthetic UDP senders on loopback, all received by one
+// shared reactor and drained by a small worker pool that only runs for streams with new data.
+// Reports throughput, loss, delivery latency and how many wake-ups were needed.
+//
+// Usage: reactor_load_test.exe [--streams N] [--bitrate kbps] [--seconds N] [--reactor-threads N]
+//                              [--workers N] [--senders N] [--loglevel level]
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <Logger.h>
+#include "../src/NetworkReactor.h"
+#include "../src/NetworkDataSource.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+#pragma comment(lib, "ws2_32.lib")
+
+using Clock = std::chrono::steady_clock;
+
+// Seven MPEG-TS packets, the usual UDP payload
+const int DATAGRAM_SIZE = 1316;
+
+// Synthetic datagram header; the rest of the payload is filler
+struct DatagramHeader {
+    uint32_t stream;
+    uint32_t sequence;
+    int64_t sendTimeNs;
+};
+
+// Per-stream receive state, only touched by the worker currently draining the stream
+struct StreamState {
+    std::unique_ptr<NetworkDataSource> source;
+    std::vector<uint8_t> pending;
+    uint32_t nextSequence = 0;
+    uint64_t datagrams = 0;
+    uint64_t lost = 0;
+};
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char* argv[]) {
+    int streamCount = 500;
+    int bitrateKbps = 2000;
+    double seconds = 10.0;
+    int reactorThreads = 1;
+    int workerCount = std::max(2u, std::thread::hardware_concurrency() / 2);
+    int senderCount = 4;
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--streams") streamCount = atoi(argv[i + 1]);
+        else if (arg == "--bitrate") bitrateKbps = atoi(argv[i + 1]);
+        else if (arg == "--seconds") seconds = atof(argv[i + 1]);
+        else if (arg == "--reactor-threads") reactorThreads = atoi(argv[i + 1]);
+        else if (arg == "--workers") workerCount = atoi(argv[i + 1]);
+        else if (arg == "--senders") senderCount = atoi(argv[i + 1]);
+        else if (arg == "--loglevel") logLevel = ParseLogLevel(argv[i + 1]);
+    }
+    streamCount = std::max(1, streamCount);
+    workerCount = std::max(1, workerCount);
+    senderCount = std::max(1, std::min(senderCount, streamCount));
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    NetworkReactor reactor;
+    if (!reactor.Start(reactorThreads)) {
+        return 1;
+    }
+
+    // Ready queue of streams with new data; a stream is queued at most once at a time
+    std::mutex readyMutex;
+    std::condition_variable readyChanged;
+    std::deque<int> ready;
+    bool stopping = false;
+
+    std::vector<StreamState> streams(streamCount);
+    for (int i = 0; i < streamCount; i++) {
+        streams[i].source = std::make_unique<NetworkDataSource>(reactor);
+        NetworkDataSource& source = *streams[i].source;
+        source.SetBufferSize(256 * 1024);
+        source.SetReadTimeout(0);
+        source.SetDataCallback([&, i]() {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(i);
+            readyChanged.notify_one();
+        });
+        if (!source.OpenUdp(0, "127.0.0.1")) {
+            std::cerr << "Failed to open stream " << i << std::endl;
+            return 1;
+        }
+    }
+
+    // Workers: drain a stream, check sequence numbers and latency, re-arm its callback
+    std::atomic<uint64_t> latencySumUs(0);
+    std::atomic<uint64_t> latencyMaxUs(0);
+    std::atomic<uint64_t> latencySamples(0);
+    std::atomic<uint64_t> drains(0);
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < workerCount; w++) {
+        workers.emplace_back([&]() {
+            std::vector<uint8_t> buffer(64 * 1024);
+            while (true) {
+                int index;
+                {
+                    std::unique_lock<std::mutex> lock(readyMutex);
+                    readyChanged.wait(lock, [&]() { return !ready.empty() || stopping; });
+                    if (ready.empty()) {
+                        return;
+                    }
+                    index = ready.front();
+                    ready.pop_front();
+                }
+                drains++;
+
+                StreamState& stream = streams[index];
+                while (true) {
+                    int bytes = stream.source->Read(buffer.data(), static_cast<int>(buffer.size()));
+                    if (bytes <= 0) {
+                        // Idle again: wait for the next callback unless data raced in
+                        if (bytes != AVERROR(EAGAIN) || stream.source->ArmDataCallback()) {
+                            break;
+                        }
+                        continue;
+                    }
+
+                    stream.pending.insert(stream.pending.end(), buffer.begin(), buffer.begin() + bytes);
+                    size_t offset = 0;
+                    int64_t now = NowNs();
+                    while (stream.pending.size() - offset >= DATAGRAM_SIZE) {
+                        DatagramHeader header;
+                        memcpy(&header, stream.pending.data() + offset, sizeof(header));
+                        if (header.sequence > stream.nextSequence) {
+                            stream.lost += header.sequence - stream.nextSequence;
+                        }
+                        stream.nextSequence = header.sequence + 1;
+                        stream.datagrams++;
+
+                        uint64_t latencyUs = static_cast<uint64_t>(std::max<int64_t>(0, now - header.sendTimeNs) / 1000);
+                        latencySumUs += latencyUs;
+                        latencySamples++;
+                        uint64_t currentMax = latencyMaxUs;
+                        while (latencyUs > currentMax && !latencyMaxUs.compare_exchange_weak(currentMax, latencyUs)) {
+                        }
+                        offset += DATAGRAM_SIZE;
+                    }
+                    stream.pending.erase(stream.pending.begin(), stream.pending.begin() + offset);
+                }
+            }
+        });
+    }
+
+    // Senders: each paces a share of the streams at the target bitrate
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    std::atomic<bool> sending(true);
+    std::atomic<uint64_t> datagramsSent(0);
+    double interval = DATAGRAM_SIZE * 8.0 / (bitrateKbps * 1000.0); // Seconds between datagrams of one stream
+
+    std::vector<std::thread> senders;
+    for (int s = 0; s < senderCount; s++) {
+        senders.emplace_back([&, s]() {
+            SOCKET socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            int sendBuffer = 4 * 1024 * 1024;
+            setsockopt(socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBuffer), sizeof(sendBuffer));
+
+            std::vector<sockaddr_in> targets;
+            for (int i = s; i < streamCount; i += senderCount) {
+                sockaddr_in address = {};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(static_cast<u_short>(streams[i].source->GetLocalPort()));
+                inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+                targets.push_back(address);
+            }
+
+            uint8_t datagram[DATAGRAM_SIZE];
+            memset(datagram, 0x47, sizeof(datagram));
+            Clock::time_point start = Clock::now();
+
+            for (uint32_t sequence = 0; sending; sequence++) {
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                                                  std::chrono::duration<double>(sequence * interval)));
+                for (size_t t = 0; t < targets.size(); t++) {
+                    DatagramHeader header;
+                    header.stream = static_cast<uint32_t>(s + t * senderCount);
+                    header.sequence = sequence;
+                    header.sendTimeNs = NowNs();
+                    memcpy(datagram, &header, sizeof(header));
+                    sendto(socket, reinterpret_cast<const char*>(datagram), DATAGRAM_SIZE, 0,
+                           reinterpret_cast<const sockaddr*>(&targets[t]), sizeof(targets[t]));
+                    datagramsSent++;
+                }
+            }
+            closesocket(socket);
+        });
+    }
+
+    std::cout << "Running " << streamCount << " streams at " << bitrateKbps << " kbit/s for " << seconds
+              << " s (" << reactor.GetThreadCount() << " reactor thread(s), " << workerCount << " workers)" << std::endl;
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    sending = false;
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Let the receivers drain
+
+    for (StreamState& stream : streams) {
+        stream.source->Close();
+    }
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        stopping = true;
+    }
+    readyChanged.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t pauses = 0;
+    for (StreamState& stream : streams) {
+        received += stream.datagrams;
+        lost += stream.lost;
+        pauses += stream.source->GetStats().receivePauses;
+    }
+    NetworkReactor::Stats reactorStats = reactor.GetStats();
+    reactor.Stop();
+    WSACleanup();
+
+    uint64_t sent = datagramsSent;
+    uint64_t samples = std::max<uint64_t>(1, latencySamples);
+    std::cout << "Datagrams sent/received: " << sent << " / " << received << std::endl;
+    std::cout << "Lost (sequence gaps):    " << lost << " (" << (sent ? 100.0 * lost / sent : 0.0) << "%)" << std::endl;
+    std::cout << "Throughput:              " << received * DATAGRAM_SIZE * 8.0 / seconds / 1e6 << " Mbit/s" << std::endl;
+    std::cout << "Latency avg/max:         " << latencySumUs / samples << " / " << latencyMaxUs << " us" << std::endl;
+    std::cout << "Receive completions:     " << reactorStats.completions << " in " << reactorStats.batches
+              << " reactor wake-ups" << std::endl;
+    std::cout << "Worker drains:           " << drains << " (" << drains / seconds << " per second)" << std::endl;
+    std::cout << "Receive pauses:          " << pauses << std::endl;
+
+    return received > 0 ? 0 : 1;
+}
@@ -0,0 +1,602 @@
+// Loopback RTSP test: serves a video file from an in-process RTSP server stand-in and
+// receives it through VideoCapture::openStream(), reporting startup time, frame rate,
+// throughput and delivery jitter. Runs headless, so it can be used in automated tests.
+//
+// Usage: rtsp_loopback.exe <video file> [--seconds N] [--drop N] [--port N] [--loglevel level]
+//   --drop N   disconnect the client after N seconds to exercise reconnection
+//
+// The stand-in implements just enough RTSP for FFmpeg's client: OPTIONS, DESCRIBE, SETUP with
+// RTP interleaved on the TCP connection, PLAY, GET_PARAMETER (keep-alive) and TEARDOWN.
+// UDP SETUP requests are answered with 461 Unsupported Transport.
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <VideoCapture.h>
+#include <Logger.h>
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#pragma comment(lib, "ws2_32.lib")
+
+using Microsoft::WRL::ComPtr;
+using Clock = std::chrono::steady_clock;
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+// Minimal RTSP server streaming one file in a loop, paced in real time
+class LoopbackRtspServer {
+public:
+    LoopbackRtspServer()
+        : m_listenSocket(INVALID_SOCKET)
+        , m_clientSocket(INVALID_SOCKET)
+        , m_port(0)
+        , m_running(false)
+        , m_bytesSent(0)
+        , m_packetsSent(0)
+        , m_sessions(0)
+    {
+    }
+
+    ~LoopbackRtspServer() {
+        Stop();
+    }
+
+    bool Start(const std::string& filePath, int port) {
+        m_filePath = filePath;
+        m_port = port;
+
+        m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (m_listenSocket == INVALID_SOCKET) {
+            std::cerr << "socket() failed: " << WSAGetLastError() << std::endl;
+            return false;
+        }
+
+        BOOL reuse = TRUE;
+        setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<u_short>(port));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+            listen(m_listenSocket, 1) == SOCKET_ERROR) {
+            std::cerr << "Cannot listen on 127.0.0.1:" << port << ": " << WSAGetLastError() << std::endl;
+            closesocket(m_listenSocket);
+            m_listenSocket = INVALID_SOCKET;
+            return false;
+        }
+
+        m_running = true;
+        m_acceptThread = std::thread(&LoopbackRtspServer::AcceptLoop, this);
+        return true;
+    }
+
+    void Stop() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        closesocket(m_listenSocket);
+        DropClient();
+        if (m_acceptThread.joinable()) {
+            m_acceptThread.join();
+        }
+        m_listenSocket = INVALID_SOCKET;
+    }
+
+    // Abort the current session as a network failure would
+    void DropClient() {
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        if (m_clientSocket != INVALID_SOCKET) {
+            shutdown(m_clientSocket, SD_BOTH);
+        }
+    }
+
+    std::string GetUrl() const {
+        return "rtsp://127.0.0.1:" + std::to_string(m_port) + "/stream";
+    }
+
+    uint64_t GetBytesSent() const { return m_bytesSent; }
+    uint64_t GetPacketsSent() const { return m_packetsSent; }
+    int GetSessions() const { return m_sessions; }
+
+private:
+    // One RTSP session and its RTP muxer
+    struct Session {
+        AVFormatContext* input = nullptr;
+        AVFormatContext* rtp = nullptr;
+        int videoStream = -1;
+        std::thread streamThread;
+        std::atomic<bool> playing{false};
+        std::atomic<bool> stop{false};
+    };
+
+    SOCKET m_listenSocket;
+    SOCKET m_clientSocket;
+    std::string m_filePath;
+    int m_port;
+    std::atomic<bool> m_running;
+    std::thread m_acceptThread;
+    std::mutex m_sendMutex;
+    std::atomic<uint64_t> m_bytesSent;
+    std::atomic<uint64_t> m_packetsSent;
+    std::atomic<int> m_sessions;
+
+    void AcceptLoop() {
+        while (m_running) {
+            SOCKET client = accept(m_listenSocket, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                continue;
+            }
+
+            BOOL noDelay = TRUE;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+            {
+                std::lock_guard<std::mutex> lock(m_sendMutex);
+                m_clientSocket = client;
+            }
+            m_sessions++;
+
+            RunSession(client);
+
+            std::lock_guard<std::mutex> lock(m_sendMutex);
+            closesocket(client);
+            m_clientSocket = INVALID_SOCKET;
+        }
+    }
+
+    void RunSession(SOCKET client) {
+        Session session;
+        std::string pending;
+        char buffer[4096];
+
+        while (m_running) {
+            int received = recv(client, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                break;
+            }
+            pending.append(buffer, received);
+
+            bool teardown = false;
+            while (!pending.empty()) {
+                // RTCP receiver reports from the client arrive as '$' frames: discard them
+                if (pending[0] == '$') {
+                    if (pending.size() < 4) {
+                        break;
+                    }
+                    size_t length = (static_cast<uint8_t>(pending[2]) << 8) | static_cast<uint8_t>(pending[3]);
+                    if (pending.size() < 4 + length) {
+                        break;
+                    }
+                    pending.erase(0, 4 + length);
+                    continue;
+                }
+
+                size_t end = pending.find("\r\n\r\n");
+                if (end == std::string::npos) {
+                    break;
+                }
+                std::string request = pending.substr(0, end + 4);
+                pending.erase(0, end + 4);
+
+                if (!HandleRequest(client, request, session, teardown)) {
+                    teardown = true;
+                }
+                if (teardown) {
+                    break;
+                }
+            }
+            if (teardown) {
+                break;
+            }
+        }
+
+        CloseSession(session);
+    }
+
+    bool HandleRequest(SOCKET client, const std::string& request, Session& session, bool& teardown) {
+        std::istringstream stream(request);
+        std::string method, url, version;
+        stream >> method >> url >> version;
+
+        std::string cseq = HeaderValue(request, "CSeq");
+        std::string headers;
+        std::string body;
+        int status = 200;
+
+        if (method == "OPTIONS") {
+            headers = "Public: OPTIONS, DESCRIBE, SETUP, PLAY, GET_PARAMETER, TEARDOWN\r\n";
+        } else if (method == "DESCRIBE") {
+            if (!OpenSession(session, body)) {
+                status = 404;
+            } else {
+                headers = "Content-Base: " + GetUrl() + "/\r\nContent-Type: application/sdp\r\n";
+            }
+        } else if (method == "SETUP") {
+            std::string transport = HeaderValue(request, "Transport");
+            if (!session.rtp) {
+                status = 455; // Method Not Valid in This State
+            } else if (transport.find("TCP") == std::string::npos) {
+                status = 461; // Unsupported Transport
+            } else {
+                headers = "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\nSession: 1;timeout=60\r\n";
+            }
+        } else if (method == "PLAY") {
+            if (!session.rtp) {
+                status = 455;
+            } else {
+                headers = "Session: 1\r\nRange: npt=0.000-\r\n";
+            }
+        } else if (method == "GET_PARAMETER") {
+            headers = "Session: 1\r\n";
+        } else if (method == "TEARDOWN") {
+            teardown = true;
+        } else {
+            status = 501; // Not Implemented
+        }
+
+        std::string response = "RTSP/1.0 " + std::to_string(status) + " " + StatusText(status) + "\r\n";
+        response += "CSeq: " + cseq + "\r\n";
+        response += headers;
+        if (!body.empty()) {
+            response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        response += "\r\n" + body;
+
+        {
+            // Responses share the connection with interleaved media
+            std::lock_guard<std::mutex> lock(m_sendMutex);
+            if (!SendAll(client, response.data(), response.size())) {
+                return false;
+            }
+        }
+
+        // Media starts after the PLAY response
+        if (method == "PLAY" && status == 200 && !session.playing) {
+            session.playing = true;
+            session.streamThread = std::thread(&LoopbackRtspServer::StreamLoop, this, client, &session);
+        }
+        return true;
+    }
+
+    bool OpenSession(Session& session, std::string& sdp) {
+        CloseSession(session);
+
+        if (avformat_open_input(&session.input, m_filePath.c_str(), nullptr, nullptr) < 0 ||
+            avformat_find_stream_info(session.input, nullptr) < 0) {
+            std::cerr << "Server: cannot open " << m_filePath << std::endl;
+            return false;
+        }
+
+        session.videoStream = av_find_best_stream(session.input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (session.videoStream < 0) {
+            std::cerr << "Server: no video stream in " << m_filePath << std::endl;
+            return false;
+        }
+
+        // The RTP muxer packetizes into this process; WritePacket frames each packet for TCP interleaving
+        if (avformat_alloc_output_context2(&session.rtp, nullptr, "rtp", "rtp://127.0.0.1") < 0) {
+            return false;
+        }
+        AVStream* stream = avformat_new_stream(session.rtp, nullptr);
+        avcodec_parameters_copy(stream->codecpar, session.input->streams[session.videoStream]->codecpar);
+        stream->codecpar->codec_tag = 0;
+        stream->time_base = session.input->streams[session.videoStream]->time_base;
+
+        const int RTP_PACKET_SIZE = 1400;
+        uint8_t* ioBuffer = static_cast<uint8_t*>(av_malloc(RTP_PACKET_SIZE));
+        session.rtp->pb = avio_alloc_context(ioBuffer, RTP_PACKET_SIZE, 1, this, nullptr, &LoopbackRtspServer::WritePacket, nullptr);
+        session.rtp->pb->max_packet_size = RTP_PACKET_SIZE;
+
+        char sdpBuffer[4096];
+        if (av_sdp_create(&session.rtp, 1, sdpBuffer, sizeof(sdpBuffer)) < 0) {
+            std::cerr << "Server: cannot create SDP" << std::endl;
+            return false;
+        }
+        sdp = sdpBuffer;
+        sdp += "a=control:streamid=0\r\n";
+        return true;
+    }
+
+    void CloseSession(Session& session) {
+        session.stop = true;
+        if (session.streamThread.joinable()) {
+            session.streamThread.join();
+        }
+        session.stop = false;
+        session.playing = false;
+
+        if (session.rtp) {
+            if (session.rtp->pb) {
+                av_freep(&session.rtp->pb->buffer);
+                avio_context_free(&session.rtp->pb);
+            }
+            avformat_free_context(session.rtp);
+            session.rtp = nullptr;
+        }
+        avformat_close_input(&session.input);
+        session.videoStream = -1;
+    }
+
+    void StreamLoop(SOCKET client, Session* session) {
+        if (avformat_write_header(session->rtp, nullptr) < 0) {
+            std::cerr << "Server: cannot start RTP muxer" << std::endl;
+            shutdown(client, SD_BOTH);
+            return;
+        }
+
+        AVStream* inStream = session->input->streams[session->videoStream];
+        AVRational inTimeBase = inStream->time_base;
+        AVRational outTimeBase = session->rtp->streams[0]->time_base;
+
+        AVPacket* packet = av_packet_alloc();
+        int64_t firstDts = AV_NOPTS_VALUE;
+        int64_t loopOffset = 0;     // Added to timestamps after each loop of the file
+        int64_t lastDts = 0;
+        int64_t lastDuration = 0;
+        Clock::time_point start = Clock::now();
+
+        while (!session->stop && m_running) {
+            int ret = av_read_frame(session->input, packet);
+            if (ret == AVERROR_EOF) {
+                // Loop the file with continuous timestamps
+                loopOffset = lastDts + std::max<int64_t>(lastDuration, 1) - firstDts + loopOffset;
+                firstDts = AV_NOPTS_VALUE;
+                av_seek_frame(session->input, session->videoStream, 0, AVSEEK_FLAG_BACKWARD);
+                continue;
+            }
+            if (ret < 0) {
+                break;
+            }
+            if (packet->stream_index != session->videoStream || packet->dts == AV_NOPTS_VALUE) {
+                av_packet_unref(packet);
+                continue;
+            }
+
+            if (firstDts == AV_NOPTS_VALUE) {
+                firstDts = packet->dts;
+            }
+            lastDts = packet->dts;
+            lastDuration = packet->duration;
+
+            // Pace on the decode timestamp
+            double sendTime = (packet->dts - firstDts + loopOffset) * av_q2d(inTimeBase);
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(sendTime)));
+
+            int64_t shift = loopOffset - firstDts;
+            packet->pts = packet->pts != AV_NOPTS_VALUE ? packet->pts + shift : AV_NOPTS_VALUE;
+            packet->dts += shift;
+            av_packet_rescale_ts(packet, inTimeBase, outTimeBase);
+            packet->stream_index = 0;
+            packet->pos = -1;
+
+            if (av_write_frame(session->rtp, packet) < 0) {
+                av_packet_unref(packet);
+                break;
+            }
+            av_packet_unref(packet);
+        }
+
+        av_packet_free(&packet);
+    }
+
+    // AVIO write callback: one call per RTP or RTCP packet
+    static int WritePacket(void* opaque, const uint8_t* buf, int size) {
+        LoopbackRtspServer* server = static_cast<LoopbackRtspServer*>(opaque);
+        if (size > 0xFFFF) {
+            return AVERROR(EINVAL);
+        }
+
+        // RTCP sender reports (payload type 200) go on the odd channel
+        uint8_t header[4];
+        header[0] = '$';
+        header[1] = (size > 1 && buf[1] == 200) ? 1 : 0;
+        header[2] = static_cast<uint8_t>(size >> 8);
+        header[3] = static_cast<uint8_t>(size & 0xFF);
+
+        std::lock_guard<std::mutex> lock(server->m_sendMutex);
+        if (server->m_clientSocket == INVALID_SOCKET ||
+            !SendAll(server->m_clientSocket, reinterpret_cast<const char*>(header), sizeof(header)) ||
+            !SendAll(server->m_clientSocket, reinterpret_cast<const char*>(buf), size)) {
+            return AVERROR(EPIPE);
+        }
+
+        server->m_bytesSent += size + sizeof(header);
+        server->m_packetsSent++;
+        return size;
+    }
+
+    static bool SendAll(SOCKET socket, const char* data, size_t size) {
+        while (size > 0) {
+            int sent = send(socket, data, static_cast<int>(size), 0);
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    static std::string HeaderValue(const std::string& request, const std::string& name) {
+        std::istringstream stream(request);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (line.size() > name.size() && _strnicmp(line.c_str(), name.c_str(), name.size()) == 0 &&
+                line[name.size()] == ':') {
+                std::string value = line.substr(name.size() + 1);
+                value.erase(0, value.find_first_not_of(' '));
+                value.erase(value.find_last_not_of("\r ") + 1);
+                return value;
+            }
+        }
+        return "";
+    }
+
+    static const char* StatusText(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 404: return "Not Found";
+            case 455: return "Method Not Valid in This State";
+            case 461: return "Unsupported Transport";
+            default:  return "Not Implemented";
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::string filePath;
+    double seconds = 10.0;
+    double dropAfter = -1.0;
+    int port = 8554;
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--drop" && i + 1 < argc) {
+            dropAfter = atof(argv[++i]);
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--loglevel" && i + 1 < argc) {
+            logLevel = ParseLogLevel(argv[++i]);
+        } else {
+            filePath = arg;
+        }
+    }
+
+    if (filePath.empty()) {
+        std::cerr << "Usage: rtsp_loopback <video file> [--seconds N] [--drop N] [--port N] [--loglevel level]" << std::endl;
+        return 2;
+    }
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "WSAStartup failed" << std::endl;
+        return 1;
+    }
+
+    // Headless D3D11 device for decoding
+    ComPtr<ID3D11Device> device;
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_VIDEO_SUPPORT,
+                                   nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+    if (FAILED(hr) || !VideoCapture::Initialize(device.Get())) {
+        std::cerr << "Failed to initialize D3D11 video decoding" << std::endl;
+        WSACleanup();
+        return 1;
+    }
+
+    LoopbackRtspServer server;
+    if (!server.Start(filePath, port)) {
+        WSACleanup();
+        return 1;
+    }
+
+    StreamOptions options;
+    options.transport = StreamTransport::Tcp;
+    options.reconnectDelayMs = 100;
+    options.maxReconnectAttempts = 10;
+
+    Clock::time_point openStart = Clock::now();
+    VideoCapture capture;
+    if (!capture.openStream(server.GetUrl(), options)) {
+        std::cerr << "Failed to open " << server.GetUrl() << std::endl;
+        server.Stop();
+        WSACleanup();
+        return 1;
+    }
+
+    // Delivery delay of each frame relative to the first one after (re)connecting: arrival time
+    // minus presentation time. Its spread is the jitter added by transport and decode.
+    double firstFrameMs = -1.0;
+    double baseDelay = 0.0;
+    double minDelay = 0.0;
+    double maxDelay = 0.0;
+    int baseReconnects = -1;
+    uint64_t frames = 0;
+    bool dropped = false;
+
+    Clock::time_point readStart = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - readStart).count() < seconds) {
+        if (!dropped && dropAfter >= 0.0 && std::chrono::duration<double>(Clock::now() - readStart).count() >= dropAfter) {
+            std::cout << "Dropping client connection" << std::endl;
+            server.DropClient();
+            dropped = true;
+        }
+
+        ID3D11Texture2D* texture = nullptr;
+        bool isYUV = false;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        if (!capture.read(&texture, isYUV, format)) {
+            break;
+        }
+        if (texture) {
+            texture->Release();
+        }
+
+        double now = std::chrono::duration<double>(Clock::now() - openStart).count();
+        double presentation = capture.get(CAP_PROP_POS_MSEC) / 1000.0;
+        if (firstFrameMs < 0.0) {
+            firstFrameMs = now * 1000.0;
+        }
+
+        double delay = now - presentation;
+        if (baseReconnects != capture.getReconnectCount()) {
+            // New session, new timeline
+            baseReconnects = capture.getReconnectCount();
+            baseDelay = delay;
+        }
+        delay -= baseDelay;
+        minDelay = std::min(minDelay, delay);
+        maxDelay = std::max(maxDelay, delay);
+        frames++;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - readStart).count();
+    int reconnects = capture.getReconnectCount();
+    capture.release();
+    server.Stop();
+
+    std::cout << "Frames received:    " << frames << std::endl;
+    std::cout << "Startup (first frame): " << firstFrameMs << " ms" << std::endl;
+    std::cout << "Frame rate:         " << (elapsed > 0.0 ? frames / elapsed : 0.0) << " FPS" << std::endl;
+    std::cout << "Throughput:         " << (elapsed > 0.0 ? server.GetBytesSent() * 8.0 / elapsed / 1e6 : 0.0)
+              << " Mbit/s (" << server.GetPacketsSent() << " RTP/RTCP packets)" << std::endl;
+    std::cout << "Delivery jitter:    " << (maxDelay - minDelay) * 1000.0 << " ms" << std::endl;
+    std::cout << "Sessions / reconnects: " << server.GetSessions() << " / " << reconnects << std::endl;
+
+    WSACleanup();
+
+    bool passed = frames > 0 && (!dropped || reconnects > 0);
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+// Shared-memory ingest benchmark: a child process writes a synthetic bitstream either into a
+// SharedMemoryWriter ring or onto an AF_UNIX stream socket, and this process reads it back.
+// Two phases per transport: throughput (unpaced large chunks) and delivery latency (paced
+// small chunks, one every --interval-us).
+//
+// Usage: shm_ingest_benchmark.exe [--mb N] [--chunk bytes] [--messages N] [--interval-us N]
+//                                 [--loglevel level]
+// The child is started internally as: shm_ingest_benchmark.exe --child shm|unix <name> <chunk> <count> <intervalUs>
+
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#include <Logger.h>
+#include "../src/SharedMemoryDataSource.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+#pragma comment(lib, "ws2_32.lib")
+
+using Clock = std::chrono::steady_clock;
+
+// Stamped at the start of every chunk; steady_clock is QueryPerformanceCounter, which is
+// consistent across processes
+struct ChunkHeader {
+    uint64_t sequence;
+    int64_t sendTimeNs;
+};
+
+struct PhaseResult {
+    bool ok = false;
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+    std::vector<int64_t> latenciesUs;
+};
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+std::string UnixSocketPath(const std::string& name) {
+    char tempDir[MAX_PATH];
+    GetTempPathA(MAX_PATH, tempDir);
+    return std::string(tempDir) + name + ".sock";
+}
+
+// Child: produce count chunks on the requested transport
+int RunChild(const std::string& transport, const std::string& name, int chunkSize, int count, int intervalUs) {
+    std::vector<uint8_t> chunk(chunkSize, 0x47);
+
+    SharedMemoryWriter writer;
+    SOCKET socket = INVALID_SOCKET;
+
+    if (transport == "shm") {
+        writer.SetWriteTimeout(5000);
+        if (!writer.Create(name, 8 * 1024 * 1024)) {
+            return 1;
+        }
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(10);
+        while (!writer.IsReaderAttached()) {
+            if (Clock::now() > deadline) {
+                std::cerr << "Child: reader did not attach" << std::endl;
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } else {
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+        socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        SOCKADDR_UN address = {};
+        address.sun_family = AF_UNIX;
+        strncpy_s(address.sun_path, sizeof(address.sun_path), UnixSocketPath(name).c_str(), _TRUNCATE);
+        if (socket == INVALID_SOCKET ||
+            connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            std::cerr << "Child: failed to connect to the unix socket (error " << WSAGetLastError() << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < count; i++) {
+        if (intervalUs > 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<int64_t>(i) * intervalUs));
+        }
+
+        ChunkHeader header;
+        header.sequence = static_cast<uint64_t>(i);
+        header.sendTimeNs = NowNs();
+        memcpy(chunk.data(), &header, sizeof(header));
+
+        if (transport == "shm") {
+            if (!writer.Write(chunk.data(), chunk.size())) {
+                return 1;
+            }
+        } else {
+            int sent = 0;
+            while (sent < chunkSize) {
+                int result = send(socket, reinterpret_cast<const char*>(chunk.data()) + sent, chunkSize - sent, 0);
+                if (result <= 0) {
+                    return 1;
+                }
+                sent += result;
+            }
+        }
+    }
+
+    if (transport == "shm") {
+        writer.Close();
+    } else {
+        closesocket(socket);
+        WSACleanup();
+    }
+    return 0;
+}
+
+// Parent: start the child writer and consume everything it sends
+PhaseResult RunPhase(const std::string& transport, int chunkSize, int count, int intervalUs) {
+    static int phase = 0;
+    std::string name = "vc_ingest_bench_" + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(phase++);
+    std::string ringName = "Local\\" + name;
+    PhaseResult result;
+
+    SOCKET listener = INVALID_SOCKET;
+    if (transport == "unix") {
+        std::string path = UnixSocketPath(name);
+        DeleteFileA(path.c_str());
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        SOCKADDR_UN address = {};
+        address.sun_family = AF_UNIX;
+        strncpy_s(address.sun_path, sizeof(address.sun_path), path.c_str(), _TRUNCATE);
+        if (listener == INVALID_SOCKET ||
+            bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, 1) != 0) {
+            std::cerr << "Failed to listen on " << path << " (error " << WSAGetLastError() << ")" << std::endl;
+            return result;
+        }
+    }
+
+    wchar_t exePath[MAX_PATH];
+    GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+    std::string args = " --child " + transport + " " + (transport == "shm" ? ringName : name) + " " +
+                       std::to_string(chunkSize) + " " + std::to_string(count) + " " + std::to_string(intervalUs);
+    std::wstring commandLine = L"\"" + std::wstring(exePath) + L"\"" + std::wstring(args.begin(), args.end());
+
+    STARTUPINFOW startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION process = {};
+    if (!CreateProcessW(exePath, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &process)) {
+        std::cerr << "Failed to start the writer process" << std::endl;
+        if (listener != INVALID_SOCKET) {
+            closesocket(listener);
+        }
+        return result;
+    }
+
+    SharedMemoryDataSource source;
+    SOCKET connection = INVALID_SOCKET;
+    if (transport == "shm") {
+        // The child creates the ring; retry until it exists
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(10);
+        while (!source.Open(ringName) && Clock::now() < deadline &&
+               WaitForSingleObject(process.hProcess, 1) == WAIT_TIMEOUT) {
+        }
+        source.SetReadTimeout(5000);
+    } else {
+        connection = accept(listener, nullptr, nullptr);
+    }
+
+    std::vector<uint8_t> chunk(chunkSize);
+    int filled = 0;
+    Clock::time_point start;
+    Clock::time_point end;
+    result.latenciesUs.reserve(count);
+
+    while ((transport == "shm" && source.IsOpen()) || connection != INVALID_SOCKET) {
+        int bytes;
+        if (transport == "shm") {
+            bytes = source.Read(chunk.data() + filled, chunkSize - filled);
+            if (bytes == AVERROR(EAGAIN)) {
+                break;
+            }
+        } else {
+            bytes = recv(connection, reinterpret_cast<char*>(chunk.data()) + filled, chunkSize - filled, 0);
+        }
+        if (bytes <= 0) {
+            break;
+        }
+
+        if (result.bytes == 0) {
+            start = Clock::now();
+        }
+        result.bytes += bytes;
+        filled += bytes;
+
+        if (filled == chunkSize) {
+            ChunkHeader header;
+            memcpy(&header, chunk.data(), sizeof(header));
+            result.latenciesUs.push_back((NowNs() - header.sendTimeNs) / 1000);
+            filled = 0;
+            end = Clock::now();
+        }
+    }
+
+    if (connection != INVALID_SOCKET) {
+        closesocket(connection);
+    }
+    if (listener != INVALID_SOCKET) {
+        closesocket(listener);
+        DeleteFileA(UnixSocketPath(name).c_str());
+    }
+
+    WaitForSingleObject(process.hProcess, 10000);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hProcess);
+    CloseHandle(process.hThread);
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.ok = exitCode == 0 && result.latenciesUs.size() == static_cast<size_t>(count);
+    if (!result.ok) {
+        std::cerr << transport << ": received " << result.latenciesUs.size() << " of " << count
+                  << " chunks (writer exit code " << exitCode << ")" << std::endl;
+    }
+    return result;
+}
+
+void PrintLatency(const std::string& label, PhaseResult& result) {
+    std::vector<int64_t>& samples = result.latenciesUs;
+    if (samples.empty()) {
+        std::cout << std::left << std::setw(10) << label << "no samples" << std::endl;
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    int64_t sum = 0;
+    for (int64_t sample : samples) {
+        sum += sample;
+    }
+    std::cout << std::left << std::setw(10) << label
+              << "avg " << std::setw(7) << sum / static_cast<int64_t>(samples.size())
+              << "p50 " << std::setw(7) << samples[samples.size() / 2]
+              << "p99 " << std::setw(7) << samples[samples.size() * 99 / 100]
+              << "max " << samples.back() << " us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 7 && std::string(argv[1]) == "--child") {
+        return RunChild(argv[2], argv[3], atoi(argv[4]), atoi(argv[5]), atoi(argv[6]));
+    }
+
+    int totalMb = 1024;
+    int chunkSize = 64 * 1024;
+    int messages = 2000;
+    int intervalUs = 500;
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--mb") totalMb = atoi(argv[i + 1]);
+        else if (arg == "--chunk") chunkSize = atoi(argv[i + 1]);
+        else if (arg == "--messages") messages = atoi(argv[i + 1]);
+        else if (arg == "--interval-us") intervalUs = atoi(argv[i + 1]);
+        else if (arg == "--loglevel") logLevel = ParseLogLevel(argv[i + 1]);
+    }
+    chunkSize = std::max(chunkSize, static_cast<int>(sizeof(ChunkHeader)));
+    int chunks = std::max(1, static_cast<int>(static_cast<int64_t>(totalMb) * 1024 * 1024 / chunkSize));
+    const int latencyChunkSize = 4096;
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    std::cout << "Throughput: " << totalMb << " MB in " << chunkSize / 1024 << " KB chunks" << std::endl;
+    PhaseResult shmThroughput = RunPhase("shm", chunkSize, chunks, 0);
+    PhaseResult unixThroughput = RunPhase("unix", chunkSize, chunks, 0);
+    for (auto& entry : { std::make_pair("shm", &shmThroughput), std::make_pair("unix", &unixThroughput) }) {
+        double mbPerSecond = entry.second->seconds > 0 ? entry.second->bytes / entry.second->seconds / (1024 * 1024) : 0.0;
+        std::cout << "  " << std::left << std::setw(8) << entry.first << std::fixed << std::setprecision(0)
+                  << mbPerSecond << " MB/s" << std::endl;
+    }
+
+    std::cout << "Latency: " << messages << " x " << latencyChunkSize << " bytes, one every " << intervalUs << " us" << std::endl;
+    PhaseResult shmLatency = RunPhase("shm", latencyChunkSize, messages, intervalUs);
+    PhaseResult unixLatency = RunPhase("unix", latencyChunkSize, messages, intervalUs);
+    std::cout << "  ";
+    PrintLatency("shm", shmLatency);
+    std::cout << "  ";
+    PrintLatency("unix", unixLatency);
+
+    WSACleanup();
+
+    bool ok = shmThroughput.ok && unixThroughput.ok && shmLatency.ok && unixLatency.ok;
+    return ok ? 0 : 1;
+}
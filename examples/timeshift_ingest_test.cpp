@@ -0,0 +1,199 @@
+// Time-shift catch-up test: replays a TimeShiftBuffer up to the live edge while a second thread
+// keeps ingesting the live source into it, the way VideoCapture does while rewound, and checks
+// that read() sees every packet exactly once (contiguous sequence numbers) at each catch-up.
+//
+// Usage: timeshift_ingest_test.exe [--rounds N] [--rewind seconds] [--interval ms] [--decode ms]
+//                                  [--loglevel level]
+
+#include <Logger.h>
+#include "../src/TimeShiftBuffer.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+const int FRAME_RATE = 30;
+const int GOP_SIZE = 30;
+const int PACKET_SIZE = 1024;
+
+// Synthetic live source: one packet per interval, pts = dts = sequence number
+class LiveSource {
+public:
+    explicit LiveSource(int intervalMs) : m_intervalMs(intervalMs), m_sequence(0) {}
+
+    bool Read(AVPacket* packet) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_intervalMs));
+        if (av_new_packet(packet, PACKET_SIZE) < 0) {
+            return false;
+        }
+        memset(packet->data, static_cast<int>(m_sequence & 0xff), PACKET_SIZE);
+        packet->pts = m_sequence;
+        packet->dts = m_sequence;
+        packet->duration = 1;
+        packet->flags = (m_sequence % GOP_SIZE) == 0 ? AV_PKT_FLAG_KEY : 0;
+        m_sequence++;
+        return true;
+    }
+
+private:
+    int m_intervalMs;
+    int64_t m_sequence;
+};
+
+// Helper function to parse log level from string
+LogLevel ParseLogLevel(const std::string& levelStr) {
+    std::string lower = levelStr;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "warning") return LogLevel::Warning;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "debug") return LogLevel::Debug;
+
+    return LogLevel::Info; // default
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = 5;
+    double rewindSeconds = 3.0;
+    int intervalMs = 4;
+    int decodeMs = 2;                   // Per replayed packet, so replay runs at twice real time
+    LogLevel logLevel = LogLevel::Warning;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--rounds") rounds = atoi(argv[i + 1]);
+        else if (arg == "--rewind") rewindSeconds = atof(argv[i + 1]);
+        else if (arg == "--interval") intervalMs = atoi(argv[i + 1]);
+        else if (arg == "--decode") decodeMs = atoi(argv[i + 1]);
+        else if (arg == "--loglevel") logLevel = ParseLogLevel(argv[i + 1]);
+    }
+    rounds = std::max(1, rounds);
+    intervalMs = std::max(1, intervalMs);
+    decodeMs = std::max(0, decodeMs);
+
+    Logger::GetInstance().SetLogLevel(logLevel);
+
+    TimeShiftBuffer buffer;
+    if (!buffer.Initialize(60.0, 64 * 1024 * 1024, AVRational{ 1, FRAME_RATE })) {
+        std::cerr << "Failed to initialize the time-shift buffer" << std::endl;
+        return 1;
+    }
+
+    // The source belongs to the ingest thread while it runs, as the demuxer does in VideoCapture
+    LiveSource source(intervalMs);
+    std::thread ingest;
+    std::atomic<bool> stopping(false);
+
+    auto startIngest = [&]() {
+        if (ingest.joinable()) {
+            return;
+        }
+        stopping = false;
+        ingest = std::thread([&]() {
+            AVPacket packet;
+            while (!stopping) {
+                if (!source.Read(&packet)) {
+                    break;
+                }
+                buffer.Push(&packet, false);
+                av_packet_unref(&packet);
+            }
+        });
+    };
+
+    // Without interrupting: the read in flight completes and its packet lands in the buffer
+    auto stopIngest = [&]() {
+        if (ingest.joinable()) {
+            stopping = true;
+            ingest.join();
+        }
+    };
+
+    // Same order as VideoCapture::ReadPacket() in time-shift mode
+    int catchUps = 0;
+    auto readPacket = [&](AVPacket* packet) {
+        if (buffer.ReadPacket(packet)) {
+            startIngest();
+            return true;
+        }
+        if (ingest.joinable()) {
+            stopIngest();
+            catchUps++;
+            if (buffer.ReadPacket(packet)) {
+                return true;
+            }
+        }
+        if (!source.Read(packet)) {
+            return false;
+        }
+        buffer.Push(packet);
+        return true;
+    };
+
+    const int livePackets = static_cast<int>(rewindSeconds * FRAME_RATE) * 2;
+    int64_t expected = 0;
+    int64_t gaps = 0;
+    int64_t packets = 0;
+    AVPacket packet;
+
+    for (int round = 0; round < rounds; round++) {
+        // Live: read() follows the source
+        for (int i = 0; i < livePackets; i++) {
+            if (!readPacket(&packet)) {
+                std::cerr << "Live read failed" << std::endl;
+                return 1;
+            }
+            if (packet.pts != expected) {
+                std::cerr << "Round " << round << ": expected packet " << expected << ", got " << packet.pts << std::endl;
+                gaps++;
+            }
+            expected = packet.pts + 1;
+            packets++;
+            av_packet_unref(&packet);
+        }
+
+        // Rewind; the window restarts at a keyframe
+        double target = buffer.GetEndTime() - rewindSeconds;
+        if (!buffer.SeekToTime(target)) {
+            std::cerr << "Seek to " << target << " s failed" << std::endl;
+            return 1;
+        }
+        if (!readPacket(&packet) || !(packet.flags & AV_PKT_FLAG_KEY)) {
+            std::cerr << "Replay does not start at a keyframe" << std::endl;
+            return 1;
+        }
+        expected = packet.pts + 1;
+        packets++;
+        av_packet_unref(&packet);
+
+        // Replay faster than real time until read() is back at the live edge
+        int catchUpsBefore = catchUps;
+        while (catchUps == catchUpsBefore) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(decodeMs));
+            if (!readPacket(&packet)) {
+                std::cerr << "Replay read failed" << std::endl;
+                return 1;
+            }
+            if (packet.pts != expected) {
+                std::cerr << "Round " << round << ": expected packet " << expected << ", got " << packet.pts
+                          << " during replay" << std::endl;
+                gaps++;
+            }
+            expected = packet.pts + 1;
+            packets++;
+            av_packet_unref(&packet);
+        }
+    }
+
+    stopIngest();
+
+    std::cout << "Packets read:   " << packets << std::endl;
+    std::cout << "Catch-ups:      " << catchUps << std::endl;
+    std::cout << "Sequence gaps:  " << gaps << std::endl;
+    std::cout << (gaps == 0 ? "PASS" : "FAIL") << std::endl;
+    return gaps == 0 ? 0 : 1;
+}
@@ -1,72 +1,408 @@
-#pragma once
-
-#include <string>
-#include <memory>
-#include <d3d11.h>
-#include <dxgiformat.h>
-#include <wrl/client.h>
-
-using Microsoft::WRL::ComPtr;
-
-// Forward declarations
-class VideoDemuxer;
-class VideoDecoder;
-struct DecodedFrame;
-class IDataSource;
-
-// OpenCV-compatible property IDs
-enum VideoCaptureProperties {
-    CAP_PROP_POS_MSEC = 0,
-    CAP_PROP_POS_FRAMES = 1,
-    CAP_PROP_POS_AVI_RATIO = 2,
-    CAP_PROP_FRAME_WIDTH = 3,
-    CAP_PROP_FRAME_HEIGHT = 4,
-    CAP_PROP_FPS = 5,
-    CAP_PROP_FOURCC = 6,
-    CAP_PROP_FRAME_COUNT = 7
-};
-
-class VideoCapture {
-public:
-    VideoCapture();
-    ~VideoCapture();
-
-    // Initialize with D3D11 device (required for hardware decoding)
-    static bool Initialize(ID3D11Device* device);
-
-    // Open video file (returns false if hardware decode not available)
-    bool open(const std::string& filename);
-
-    // Open video from custom data source (memory buffer, network stream, etc.)
-    // format parameter is optional, e.g., "mp4", "matroska", "h264"
-    bool open(IDataSource* dataSource, const std::string& format = "");
-
-    // Read next frame (returns DX11 texture, always YUV format from hardware)
-    // Returns false if no more frames or error occurred
-    bool read(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format);
-
-    // Video properties (OpenCV-compatible)
-    double get(int propId) const;
-
-    // Seeking (OpenCV-compatible)
-    bool set(int propId, double value);
-
-    // Status
-    bool isOpened() const;
-    void release();
-
-private:
-    static ID3D11Device* s_d3dDevice;
-    static bool s_initialized;
-
-    std::unique_ptr<VideoDemuxer> m_demuxer;
-    std::unique_ptr<VideoDecoder> m_decoder;
-    std::unique_ptr<DecodedFrame> m_currentFrame;
-
-    bool m_opened;
-    bool m_eof;
-    int64_t m_frameCount;
-
-    bool InitializeDecoder();
-    bool DecodeNextFrame();
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <d3d11.h>
+#include <dxgiformat.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+// Forward declarations
+class VideoDemuxer;
+class VideoDecoder;
+struct DecodedFrame;
+struct AVPacket;
+class IDataSource;
+class TimeShiftBuffer;
+class ProbeCache;
+class CaptureWatchdog;
+struct CaptureProgress;
+class TemporalLayerFilter;
+
+// OpenCV-compatible property IDs
+enum VideoCaptureProperties {
+    CAP_PROP_POS_MSEC = 0,
+    CAP_PROP_POS_FRAMES = 1,
+    CAP_PROP_POS_AVI_RATIO = 2,
+    CAP_PROP_FRAME_WIDTH = 3,
+    CAP_PROP_FRAME_HEIGHT = 4,
+    CAP_PROP_FPS = 5,
+    CAP_PROP_FOURCC = 6,
+    CAP_PROP_FRAME_COUNT = 7
+};
+
+// Lower transport for RTSP streams
+enum class StreamTransport {
+    Auto,   // UDP, falling back to TCP
+    Tcp,    // RTP interleaved on the RTSP connection
+    Udp
+};
+
+// Frame delivery of background decoding (startAsync)
+enum class FrameDelivery {
+    Sequential,     // Every frame in order; decoding waits while the queue is full
+    Latest          // Only the newest frame; decoding never waits and overwrites unread frames
+};
+
+// Options for network streams opened with openStream() (rtsp://, rtp://, udp://, srt://, ...)
+struct StreamOptions {
+    StreamTransport transport = StreamTransport::Tcp;
+    bool lowLatency = true;             // No demuxer buffering, short stream analysis
+    int reorderQueueSize = 64;          // RTP packets held for reordering
+    int maxDelayMs = 100;               // Upper bound on the reorder/jitter delay
+    int timeoutMs = 5000;               // Socket I/O timeout
+    bool reconnect = true;              // Reopen after errors or end of stream
+    int reconnectDelayMs = 500;         // First retry delay, doubled up to maxReconnectDelayMs
+    int maxReconnectDelayMs = 8000;
+    int maxReconnectAttempts = 0;       // 0 = keep trying
+};
+
+// Time limits for blocking I/O in milliseconds; 0 = no limit
+struct IoDeadlines {
+    int openMs = 0;                     // Connect and read the container headers
+    int probeMs = 0;                    // Stream analysis (a partial analysis is kept)
+    int readMs = 0;                     // Reading the next packet in read()
+    int seekMs = 0;                     // One seek in set()
+};
+
+// Outcome of the last blocking I/O operation
+enum class IoStatus {
+    Ok,
+    TimedOut,                           // Ran past its IoDeadlines limit
+    Aborted                             // Interrupted by abort()
+};
+
+// How read() deals with packets the decoder rejects and frames decoded with errors
+struct DecodeErrorPolicy {
+    bool skipCorruptPackets = true;     // Drop the packet and continue; false ends the stream
+    bool resyncAtKeyframe = true;       // After an error, drop packets up to the next keyframe
+    bool concealErrors = false;         // Deliver frames decoded with errors (concealed) instead of dropping them
+    int maxConsecutiveErrors = 100;     // End the stream after this many errors without a good frame (0 = never)
+};
+
+// Decode errors survived by read()
+struct DecodeErrorStats {
+    int64_t decodeErrors = 0;           // Packets rejected and frames that failed to decode
+    int64_t packetsDropped = 0;         // Rejected, or skipped while resynchronizing
+    int64_t corruptFramesDropped = 0;
+    int64_t corruptFramesDelivered = 0; // concealErrors
+    int64_t framesLost = 0;             // packetsDropped + corruptFramesDropped
+    int64_t recoveries = 0;             // Good frames reached after an error
+    double lastRecoveryMs = 0.0;        // Stream time from the last good frame before an error to the first after it
+    double maxRecoveryMs = 0.0;
+    double totalRecoveryMs = 0.0;
+};
+
+// How much of the stream the decoder works through, from full quality to cheapest
+enum class DecodeTier {
+    Full,               // Every frame
+    SkipNonReference,   // Frames no other frame references (H.264/HEVC)
+    SkipBidirectional,  // All B-frames (H.264/HEVC)
+    KeyframesOnly       // Only keyframes; other packets never reach the decoder (all codecs)
+};
+
+// Packets passed and dropped by the temporal layer limit (setMaxTemporalLayer)
+struct TemporalLayerStats {
+    int64_t framesPassed = 0;
+    int64_t framesDropped = 0;
+    int64_t bytesPassed = 0;
+    int64_t bytesDropped = 0;
+    int highestLayer = -1;              // Highest temporal id seen, -1 if the stream carries none
+    int activeLayer = -1;               // Limit in effect, -1 = all layers
+};
+
+// Progress of an openAsync() call
+enum class OpenStatus {
+    Pending,
+    Opened,
+    Failed,
+    Cancelled
+};
+
+// Handle to an openAsync() call; copies refer to the same open
+class OpenHandle {
+public:
+    // Wait until the open finishes (timeoutMs < 0 waits indefinitely) and return its status
+    OpenStatus wait(int timeoutMs = -1) const;
+    OpenStatus status() const;
+    bool isDone() const { return status() != OpenStatus::Pending; }
+
+    // Abandon the open; blocking connects, reads and stream analysis return promptly
+    void cancel();
+
+private:
+    friend class VideoCapture;
+    struct State;
+    std::shared_ptr<State> m_state;
+};
+
+// Pipeline stages tracked by the stall watchdog
+enum class CaptureStage {
+    Source,         // Bytes arriving from the source (not reported by RTSP/RTP)
+    Demuxer,        // Packets split out of the byte stream
+    Decoder,        // Frames coming out of the decoder
+    Consumer        // Frames taken by read()/tryRead()
+};
+
+// What the watchdog does about a stall
+enum class RecoveryAction {
+    None,           // Log only
+    FlushDecoder,   // Drop decoder state and resume at the next keyframe
+    SeekToLive,     // Jump to the live edge (time-shift) or resume at the next keyframe
+    Reconnect,      // Reopen an openStream() source
+    Escalate        // Leave it to WatchdogOptions::onStall
+};
+
+// A detected stall, passed to WatchdogOptions::onStall
+struct StallEvent {
+    CaptureStage stage = CaptureStage::Source;
+    RecoveryAction action = RecoveryAction::None;   // Requested for this event
+    int attempt = 0;                    // 1 for the first event of a stall
+    double stalledSeconds = 0.0;        // Time without progress while the stage was expected to progress
+    double sinceProgress[4] = {};       // Seconds since each stage last advanced, in CaptureStage order
+    int64_t bytesIn = 0;
+    int64_t packetsDemuxed = 0;
+    int64_t framesDecoded = 0;
+    int64_t framesConsumed = 0;
+};
+
+// Stall thresholds and recovery of the capture watchdog (enableWatchdog)
+struct WatchdogOptions {
+    int checkIntervalMs = 250;
+    int sourceStallMs = 5000;           // 0 disables the check of a stage
+    int demuxerStallMs = 5000;
+    int decoderStallMs = 3000;
+    int consumerStallMs = 0;            // Off: an idle consumer is often intentional (pause)
+
+    // Actions tried in turn while a stall persists, one per threshold period; the last repeats.
+    // Actions that do not apply to the source (Reconnect on a file) are logged and skipped,
+    // without interrupting the read in progress.
+    std::vector<RecoveryAction> sourceRecovery = { RecoveryAction::Reconnect, RecoveryAction::Escalate };
+    std::vector<RecoveryAction> demuxerRecovery = { RecoveryAction::SeekToLive, RecoveryAction::Reconnect, RecoveryAction::Escalate };
+    std::vector<RecoveryAction> decoderRecovery = { RecoveryAction::FlushDecoder, RecoveryAction::Escalate };
+    std::vector<RecoveryAction> consumerRecovery = { RecoveryAction::Escalate };
+
+    // Called on the watchdog thread for every stall event
+    std::function<void(const StallEvent&)> onStall;
+};
+
+class VideoCapture {
+public:
+    VideoCapture();
+    ~VideoCapture();
+
+    // Initialize with D3D11 device (required for hardware decoding)
+    static bool Initialize(ID3D11Device* device);
+
+    // Enable a persistent on-disk cache of stream analysis shared by all file opens
+    // (safe to share one directory between processes). Can be called again at any time to
+    // change the directory; opens already in progress finish with the previous cache.
+    static bool EnableProbeCache(const std::string& directory);
+
+    // Open video file (returns false if hardware decode not available)
+    bool open(const std::string& filename);
+
+    // Open video from custom data source (memory buffer, network stream, etc.)
+    // format parameter is optional, e.g., "mp4", "matroska", "h264"
+    bool open(IDataSource* dataSource, const std::string& format = "");
+
+    // Open a network stream with transport, latency and reconnect options
+    // read() reconnects transparently; frames resume at the first keyframe after reconnecting
+    bool openStream(const std::string& url, const StreamOptions& options = StreamOptions());
+    int getReconnectCount() const;
+
+    // Open on a worker thread: demuxer open, stream analysis and decoder setup run in the
+    // background and can be cancelled through the handle. Do not use the capture until the
+    // handle reports Opened; open(), release() and the destructor cancel a pending open.
+    OpenHandle openAsync(const std::string& filename);
+    OpenHandle openAsync(IDataSource* dataSource, const std::string& format = "");
+    OpenHandle openStreamAsync(const std::string& url, const StreamOptions& options = StreamOptions());
+
+    // Deadlines and abort for blocking I/O
+    // An open, read() or seek that runs past its deadline, or is interrupted by abort() from
+    // another thread, returns false and getLastIoStatus() reports why. The capture stays open
+    // and keeps its decoder and position: the next read() continues the stream, although the
+    // packet being read when the deadline hit may be lost. Timeouts do not trigger stream
+    // reconnects. abort() only affects an operation already in progress. With background
+    // decoding the decode thread retries after a timeout instead of ending the stream.
+    // Deadlines apply to the current source and to later opens.
+    void setIoDeadlines(const IoDeadlines& deadlines);
+    void abort();
+    IoStatus getLastIoStatus() const;
+
+    // Error-resilient decoding
+    // A corrupt packet no longer ends the stream: it is dropped, decoding resynchronizes at the
+    // next keyframe and the error is counted. getDecodeErrorStats() reports errors, frames lost
+    // and how much stream time each recovery took.
+    void setDecodeErrorPolicy(const DecodeErrorPolicy& policy);
+    DecodeErrorStats getDecodeErrorStats() const;
+
+    // Decode tiers for analytics and thumbnails that do not need every frame
+    // Lower tiers skip frames in the decoder instead of decoding and discarding them. A new
+    // tier takes effect at the next keyframe, so frames always decode from complete
+    // references; setDecodeTier() can be called from any thread, also while startAsync()
+    // runs. getDecodeTier() reports the tier in effect.
+    void setDecodeTier(DecodeTier tier);
+    DecodeTier getDecodeTier() const;
+
+    // Temporal sub-layer extraction for HEVC and AV1 streams encoded with temporal layers
+    // Packets above the given layer are dropped before decoding (0 = base layer only, -1 = all),
+    // so each layer dropped halves the frame rate and decode cost of a typical dyadic stream.
+    // Lowering the layer applies immediately, raising it at the next keyframe. Can be called
+    // from any thread, also while startAsync() runs.
+    void setMaxTemporalLayer(int layer);
+    int getMaxTemporalLayer() const;
+    TemporalLayerStats getTemporalLayerStats() const;
+
+    // Stall watchdog for long-running live captures
+    // Tracks progress of bytes in, packets demuxed, frames decoded and frames consumed, and
+    // when a stage stops advancing for longer than its threshold logs the stall with the
+    // time since each stage last progressed, then runs the next recovery action for that
+    // stage. Recovery runs inside read() (or on the decode thread); a read() blocked on a
+    // starved source is interrupted to get there.
+    bool enableWatchdog(const WatchdogOptions& options = WatchdogOptions());
+    void disableWatchdog();
+    int64_t getStallCount() const;
+
+    // Read next frame (returns DX11 texture, always YUV format from hardware)
+    // Returns false if no more frames or error occurred
+    bool read(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format);
+
+    // Video properties (OpenCV-compatible)
+    double get(int propId) const;
+
+    // Seeking (OpenCV-compatible)
+    bool set(int propId, double value);
+
+    // Time-shift (rewind window) for live sources
+    // Retains the last windowSeconds of compressed packets so set(CAP_PROP_POS_MSEC) can seek
+    // back inside the window. spillPath optionally backs the buffer with a memory-mapped file.
+    // While read() replays from the window, a background thread keeps ingesting the live
+    // source into it, so seekToLive() returns to the current live edge.
+    bool enableTimeShift(double windowSeconds, size_t maxBytes = 256 * 1024 * 1024, const std::string& spillPath = "");
+    bool seekToLive();
+    bool isLive() const;
+
+    // Seamless rendition switching (ABR renditions, simulcast layers of the same content)
+    // The new source is opened and primed in the background; read() hands over at the first
+    // keyframe of the new source that follows the current position, reusing the decoder when
+    // codec and profile match. Renditions must share the presentation timeline. Opening and
+    // priming use the setIoDeadlines() limits; release() or another switch cancels a stalled one.
+    bool switchSource(const std::string& filename);
+    bool switchSource(IDataSource* dataSource, const std::string& format = "");
+    bool isSwitchPending() const;
+
+    // Background decoding for event loops
+    // A decode thread keeps up to queueDepth frames ready. getFrameReadyEvent() returns a
+    // manual-reset event that is signalled while a frame is queued or the stream has ended, so one
+    // thread can wait on many captures (WaitForMultipleObjects, RegisterWaitForSingleObject,
+    // asio::windows::object_handle). tryRead() never blocks; read() waits for the next queued frame.
+    // get() reports the last frame handed out. set(), seekToLive(), enableTimeShift() and
+    // switchSource() pause the decode thread while they run, interrupting a blocking read or
+    // reconnect of the frame in progress; a successful seek drops queued frames.
+    // FrameDelivery::Latest keeps a single-frame mailbox for live monitoring: read() returns the
+    // newest decoded frame, so a slow consumer sees at most one frame time of extra latency
+    // instead of a growing backlog. Intended for live sources; a file would decode at full speed.
+    // The decode thread uses the immediate context of the device passed to Initialize(), so
+    // startAsync() turns on the device's multithread protection (ID3D10Multithread); the
+    // application's own use of that context is then serialized with decoding.
+    bool startAsync(int queueDepth = 3, FrameDelivery delivery = FrameDelivery::Sequential);
+    void stopAsync();
+    bool isAsync() const;
+    HANDLE getFrameReadyEvent() const;
+    bool tryRead(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format);
+    bool isEndOfStream() const;
+    int64_t getOverwrittenFrameCount() const;   // Frames replaced unread in Latest mode
+
+    // Status
+    bool isOpened() const;
+    void release();
+
+private:
+    static ID3D11Device* s_d3dDevice;
+    static bool s_initialized;
+    static std::shared_ptr<ProbeCache> s_probeCache;
+    static std::mutex s_probeCacheMutex;
+
+    struct SourceSwitch;
+    struct AsyncDecode;
+    struct LiveIngest;
+    struct DecodeErrors;
+
+    std::unique_ptr<VideoDemuxer> m_demuxer;
+    std::unique_ptr<VideoDecoder> m_decoder;
+    std::unique_ptr<DecodedFrame> m_currentFrame;
+    std::unique_ptr<TimeShiftBuffer> m_timeShift;
+    std::unique_ptr<LiveIngest> m_liveIngest;          // Keeps the window current while rewound
+    std::unique_ptr<SourceSwitch> m_sourceSwitch;
+    std::unique_ptr<AsyncDecode> m_async;
+    std::unique_ptr<StreamOptions> m_streamOptions;     // Set for openStream() sources
+    std::string m_streamUrl;
+    std::shared_ptr<OpenHandle::State> m_pendingOpen;
+    const std::atomic<bool>* m_openInterrupt;           // Cancel flag of the running openAsync()
+    IoDeadlines m_ioDeadlines;
+    std::atomic<bool> m_abortRequested;                 // Shared with the demuxers, see abort()
+    std::mutex m_reconnectMutex;
+    std::condition_variable m_reconnectWake;            // Ends a reconnect delay on abort()
+    std::atomic<IoStatus> m_ioStatus;
+    std::unique_ptr<CaptureProgress> m_progress;
+    std::unique_ptr<CaptureWatchdog> m_watchdog;
+    bool m_skipToKeyframe;                              // Drop packets up to the next keyframe
+    bool m_reconnectRequested;                          // Watchdog asked for a reconnect
+    std::unique_ptr<DecodeErrors> m_decodeErrors;
+    std::atomic<DecodeTier> m_requestedTier;            // Set by setDecodeTier()
+    std::atomic<DecodeTier> m_activeTier;               // Applied to the decoder at a keyframe
+    std::unique_ptr<TemporalLayerFilter> m_temporalFilter;
+
+    bool m_opened;
+    bool m_eof;
+    int64_t m_frameCount;
+    double m_seekTargetTime;     // Presentation time of the frame requested by set(CAP_PROP_POS_FRAMES), or -1
+    int m_reconnectCount;
+
+    bool OpenFile(const std::string& filename);
+    bool OpenDataSource(IDataSource* dataSource, const std::string& format);
+    bool OpenNetworkStream(const std::string& url, const StreamOptions& options);
+    OpenHandle StartAsyncOpen(std::function<bool()> open);
+    void CancelPendingOpen();
+    void Close();
+    void ConfigureDemuxer(VideoDemuxer& demuxer);
+    static std::shared_ptr<ProbeCache> GetProbeCache();
+    void UpdateIoStatus(const VideoDemuxer& demuxer);
+    bool InitializeDecoder();
+    void UpdateFrameCount();
+    double GetProperty(int propId) const;
+    bool SetProperty(int propId, double value);
+    bool DecodeFrame();
+    bool DecodeSourceFrame();
+    bool RunRecovery();
+    bool HandleDecodeError(const char* what, bool resync);
+    bool AcceptFrame();
+    void ApplyDecodeTier(DecodeTier tier);
+    bool DecodeNextFrame();
+    bool ReadPacket(AVPacket* packet);
+    bool ReadSourcePacket(AVPacket* packet);
+    void StartLiveIngest();
+    void StopLiveIngest(bool interrupt);
+    void RunLiveIngest();
+    std::unique_ptr<VideoDemuxer> OpenStreamDemuxer();
+    bool Reconnect();
+    bool SeekTimeShift(double timeInSeconds);
+    bool BeginSourceSwitch(std::function<bool(VideoDemuxer&)> openSource);
+    void PrimeSourceSwitch(SourceSwitch* pending);
+    bool SourceSwitchDue(bool decoded);
+    bool CompleteSourceSwitch();
+    void CancelSourceSwitch();
+    void RunAsyncDecode();
+    bool DequeueFrame(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format, bool wait);
+    bool SuspendAsync();
+    bool ResetAbort();
+    void ResumeAsync(bool discardQueued);
 };
\ No newline at end of file
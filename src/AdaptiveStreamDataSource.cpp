@@ -0,0 +1,1134 @@
+#include "AdaptiveStreamDataSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavformat/avio.h>
+#include <libavutil/dict.h>
+#include <libavutil/error.h>
+}
+
+namespace {
+
+const int FETCH_ATTEMPTS = 3;
+const int LIVE_START_SEGMENTS = 3;      // Live playback starts this many segments from the edge
+const int DASH_DEFAULT_WINDOW = 5;      // Segments listed for number-based live MPDs
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool StartsWith(const std::string& text, const char* prefix) {
+    return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Resolve a playlist-relative reference against the URL of the playlist that contains it
+std::string ResolveUrl(const std::string& base, const std::string& reference) {
+    if (reference.find("://") != std::string::npos) {
+        return reference;
+    }
+
+    size_t schemeEnd = base.find("://");
+    if (!reference.empty() && reference[0] == '/' && schemeEnd != std::string::npos) {
+        size_t pathStart = base.find('/', schemeEnd + 3);
+        return (pathStart == std::string::npos ? base : base.substr(0, pathStart)) + reference;
+    }
+
+    std::string directory = base.substr(0, base.find('?'));
+    size_t slash = directory.find_last_of("/\\");
+    directory = slash == std::string::npos ? "" : directory.substr(0, slash + 1);
+    return directory + reference;
+}
+
+// HLS attribute list: KEY=value,KEY="quoted,value"
+std::map<std::string, std::string> ParseAttributes(const std::string& list) {
+    std::map<std::string, std::string> attributes;
+    size_t position = 0;
+    while (position < list.size()) {
+        size_t equals = list.find('=', position);
+        if (equals == std::string::npos) {
+            break;
+        }
+        std::string key = Trim(list.substr(position, equals - position));
+        std::string value;
+        size_t next;
+        if (equals + 1 < list.size() && list[equals + 1] == '"') {
+            size_t quote = list.find('"', equals + 2);
+            value = list.substr(equals + 2, quote == std::string::npos ? std::string::npos : quote - equals - 2);
+            next = quote == std::string::npos ? list.size() : list.find(',', quote);
+        } else {
+            next = list.find(',', equals);
+            value = list.substr(equals + 1, next == std::string::npos ? std::string::npos : next - equals - 1);
+        }
+        attributes[key] = value;
+        position = next == std::string::npos ? list.size() : next + 1;
+    }
+    return attributes;
+}
+
+// Minimal XML access for MPDs: element ranges and start-tag attributes, no namespaces
+struct XmlElement {
+    size_t begin;       // '<' of the start tag
+    size_t tagEnd;      // '>' of the start tag
+    size_t end;         // One past the end tag (or the self-closing start tag)
+};
+
+std::vector<XmlElement> FindElements(const std::string& xml, const std::string& name, size_t from, size_t to) {
+    std::vector<XmlElement> elements;
+    const std::string openTag = "<" + name;
+    const std::string closeTag = "</" + name + ">";
+
+    size_t position = from;
+    while ((position = xml.find(openTag, position)) != std::string::npos && position < to) {
+        size_t nameEnd = position + openTag.size();
+        char next = nameEnd < xml.size() ? xml[nameEnd] : '\0';
+        if (next != ' ' && next != '>' && next != '/' && next != '\t' && next != '\r' && next != '\n') {
+            position = nameEnd;
+            continue;
+        }
+
+        XmlElement element;
+        element.begin = position;
+        element.tagEnd = xml.find('>', position);
+        if (element.tagEnd == std::string::npos) {
+            break;
+        }
+        if (xml[element.tagEnd - 1] == '/') {
+            element.end = element.tagEnd + 1;
+        } else {
+            size_t close = xml.find(closeTag, element.tagEnd);
+            element.end = (close == std::string::npos || close > to) ? to : close + closeTag.size();
+        }
+        elements.push_back(element);
+        position = element.end;
+    }
+    return elements;
+}
+
+// First element named name in [from, to), or nullptr-like (begin == npos)
+XmlElement FindFirst(const std::string& xml, const std::string& name, size_t from, size_t to) {
+    std::vector<XmlElement> elements = FindElements(xml, name, from, to);
+    return elements.empty() ? XmlElement{ std::string::npos, 0, 0 } : elements.front();
+}
+
+std::string GetAttribute(const std::string& xml, const XmlElement& element, const std::string& name) {
+    if (element.begin == std::string::npos) {
+        return "";
+    }
+
+    size_t position = element.begin;
+    while ((position = xml.find(name + "=", position)) != std::string::npos && position < element.tagEnd) {
+        char before = xml[position - 1];
+        size_t quote = position + name.size() + 1;
+        if ((before == ' ' || before == '\t' || before == '\r' || before == '\n') &&
+            (xml[quote] == '"' || xml[quote] == '\'')) {
+            size_t closing = xml.find(xml[quote], quote + 1);
+            if (closing == std::string::npos || closing > element.tagEnd) {
+                return "";
+            }
+            return xml.substr(quote + 1, closing - quote - 1);
+        }
+        position = quote;
+    }
+    return "";
+}
+
+std::string GetText(const std::string& xml, const XmlElement& element) {
+    if (element.begin == std::string::npos || xml[element.tagEnd - 1] == '/') {
+        return "";
+    }
+    size_t close = xml.rfind("</", element.end);
+    return Trim(xml.substr(element.tagEnd + 1, close - element.tagEnd - 1));
+}
+
+int64_t ToInt(const std::string& text, int64_t fallback) {
+    return text.empty() ? fallback : strtoll(text.c_str(), nullptr, 10);
+}
+
+// ISO 8601 duration (PnDTnHnMnS) in seconds
+double ParseIsoDuration(const std::string& text) {
+    double seconds = 0.0;
+    bool timePart = false;
+    size_t position = text.find('P');
+    if (position == std::string::npos) {
+        return 0.0;
+    }
+    position++;
+
+    while (position < text.size()) {
+        if (text[position] == 'T') {
+            timePart = true;
+            position++;
+            continue;
+        }
+        char* end = nullptr;
+        double value = strtod(text.c_str() + position, &end);
+        if (end == text.c_str() + position || !*end) {
+            break;
+        }
+        switch (*end) {
+            case 'Y': seconds += value * 365.0 * 86400.0; break;
+            case 'D': seconds += value * 86400.0; break;
+            case 'H': seconds += value * 3600.0; break;
+            case 'M': seconds += timePart ? value * 60.0 : value * 30.0 * 86400.0; break;
+            case 'S': seconds += value; break;
+            default: break;
+        }
+        position = (end - text.c_str()) + 1;
+    }
+    return seconds;
+}
+
+// ISO 8601 date-time (YYYY-MM-DDTHH:MM:SS[.fff][Z|+hh:mm]) in seconds since the Unix epoch
+double ParseIsoDateTime(const std::string& text) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0;
+    double second = 0.0;
+    if (sscanf(text.c_str(), "%d-%d-%dT%d:%d:%lf", &year, &month, &day, &hour, &minute, &second) < 5) {
+        return 0.0;
+    }
+
+    // Days from civil date (proleptic Gregorian)
+    int64_t y = month <= 2 ? year - 1 : year;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yearOfEra = y - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = era * 146097 + dayOfEra - 719468;
+
+    double result = static_cast<double>(days) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+
+    size_t zone = text.find_first_of("+-", text.find('T'));
+    if (zone != std::string::npos) {
+        int offsetHours = 0, offsetMinutes = 0;
+        sscanf(text.c_str() + zone + 1, "%d:%d", &offsetHours, &offsetMinutes);
+        double offset = offsetHours * 3600.0 + offsetMinutes * 60.0;
+        result += text[zone] == '+' ? -offset : offset;
+    }
+    return result;
+}
+
+// DASH SegmentTemplate identifiers: $RepresentationID$, $Number[%0Nd]$, $Bandwidth$, $Time$, $$
+std::string ExpandTemplate(const std::string& pattern, const std::string& id, int64_t bandwidth,
+                           int64_t number, int64_t time) {
+    std::string result;
+    size_t position = 0;
+    while (position < pattern.size()) {
+        size_t start = pattern.find('$', position);
+        size_t end = start == std::string::npos ? std::string::npos : pattern.find('$', start + 1);
+        if (end == std::string::npos) {
+            result += pattern.substr(position);
+            break;
+        }
+        result += pattern.substr(position, start - position);
+
+        std::string token = pattern.substr(start + 1, end - start - 1);
+        std::string name = token.substr(0, token.find('%'));
+        int width = 0;
+        if (token.find('%') != std::string::npos) {
+            width = atoi(token.c_str() + token.find('%') + 1);
+        }
+
+        char buffer[32];
+        if (token.empty()) {
+            result += '$';
+        } else if (name == "RepresentationID") {
+            result += id;
+        } else if (name == "Number" || name == "Bandwidth" || name == "Time") {
+            int64_t value = name == "Number" ? number : (name == "Bandwidth" ? bandwidth : time);
+            snprintf(buffer, sizeof(buffer), "%0*lld", width, static_cast<long long>(value));
+            result += buffer;
+        } else {
+            result += pattern.substr(start, end - start + 1);
+        }
+        position = end + 1;
+    }
+    return result;
+}
+
+double NowSeconds() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AdaptiveStreamDataSource::AdaptiveStreamDataSource()
+    : m_isDash(false)
+    , m_dashUpdatePeriod(0.0)
+    , m_cacheBytes(0)
+    , m_lastFetchId(0)
+    , m_currentVariant(0)
+    , m_pendingVariant(-1)
+    , m_cursor(0)
+    , m_sendInit(false)
+    , m_initOffset(0)
+    , m_boundaryPending(false)
+    , m_atBoundary(false)
+    , m_firstByteDelivered(false)
+    , m_prefetchCount(3)
+    , m_fetchThreadCount(3)
+    , m_maxCacheBytes(64 * 1024 * 1024)
+    , m_fetchTimeoutMs(10000)
+    , m_readTimeoutMs(10000)
+    , m_stopping(false)
+{
+    avformat_network_init();
+}
+
+AdaptiveStreamDataSource::~AdaptiveStreamDataSource() {
+    Close();
+    avformat_network_deinit();
+}
+
+int AdaptiveStreamDataSource::Read(uint8_t* buffer, int size) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_boundaryPending) {
+        m_boundaryPending = false;
+        m_atBoundary = true;
+        LOG_INFO("AdaptiveStreamDataSource - variant boundary, reopen to continue with variant ", m_currentVariant);
+        return AVERROR_EOF;
+    }
+    m_atBoundary = false;
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(m_readTimeoutMs);
+    bool stalled = false;
+    Clock::time_point stallStart;
+
+    while (!m_stopping) {
+        const int variant = m_currentVariant;
+        const VariantPlaylist& playlist = m_playlists[variant];
+        bool waitingForMedia = false;
+
+        if (m_sendInit && playlist.initUrl.empty()) {
+            m_sendInit = false;
+        }
+
+        if (m_sendInit) {
+            auto it = m_cache.find({ variant, -1 });
+            if (it != m_cache.end() && it->second.state == CachedSegment::State::Ready) {
+                const std::vector<uint8_t>& data = it->second.data;
+                size_t toRead = std::min(static_cast<size_t>(size), data.size() - m_initOffset);
+                memcpy(buffer, data.data() + m_initOffset, toRead);
+                m_initOffset += toRead;
+                if (m_initOffset == data.size()) {
+                    m_sendInit = false;
+                    m_initOffset = 0;
+                }
+                return static_cast<int>(toRead);
+            }
+            if (it != m_cache.end() && it->second.state == CachedSegment::State::Failed) {
+                LOG_ERROR("AdaptiveStreamDataSource - failed to fetch init segment ", playlist.initUrl);
+                m_cache.erase(it);
+                return AVERROR(EIO);
+            }
+        } else {
+            const SegmentInfo* segment = FindSegment(variant, m_cursor);
+            if (!segment) {
+                if (!playlist.segments.empty() && m_cursor < playlist.segments.front().sequence) {
+                    LOG_WARNING("AdaptiveStreamDataSource - fell behind the live window, skipping to sequence ",
+                                playlist.segments.front().sequence);
+                    m_cursor = playlist.segments.front().sequence;
+                    m_stateChanged.notify_all();
+                    continue;
+                }
+                if (playlist.ended) {
+                    LOG_DEBUG("AdaptiveStreamDataSource::Read - end of presentation");
+                    return AVERROR_EOF;
+                }
+                // Live: wait for the next playlist refresh
+            } else {
+                auto it = m_cache.find({ variant, m_cursor });
+                if (it != m_cache.end() && it->second.state == CachedSegment::State::Ready) {
+                    CachedSegment& cached = it->second;
+                    size_t toRead = std::min(static_cast<size_t>(size), cached.data.size() - cached.readOffset);
+                    memcpy(buffer, cached.data.data() + cached.readOffset, toRead);
+                    cached.readOffset += toRead;
+
+                    if (!m_firstByteDelivered) {
+                        m_firstByteDelivered = true;
+                        m_stats.startupTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - m_openTime).count();
+                        LOG_INFO("AdaptiveStreamDataSource - first segment ready after ", m_stats.startupTimeMs, " ms");
+                    }
+                    if (stalled) {
+                        m_stats.stallTimeMs += std::chrono::duration<double, std::milli>(Clock::now() - stallStart).count();
+                    }
+
+                    // Release the segment as soon as it has been read
+                    if (cached.readOffset == cached.data.size()) {
+                        m_cacheBytes -= cached.data.size();
+                        m_cache.erase(it);
+                        AdvanceSegment();
+                    }
+                    return static_cast<int>(toRead);
+                }
+                if (it != m_cache.end() && it->second.state == CachedSegment::State::Failed) {
+                    LOG_WARNING("AdaptiveStreamDataSource - skipping segment ", m_cursor, " after ", FETCH_ATTEMPTS,
+                                " failed attempts");
+                    m_cache.erase(it);
+                    AdvanceSegment();
+                    if (m_boundaryPending) {
+                        m_boundaryPending = false;
+                        m_atBoundary = true;
+                        return AVERROR_EOF;
+                    }
+                    continue;
+                }
+                waitingForMedia = true;
+            }
+        }
+
+        // Playback caught up with the downloads
+        if (waitingForMedia && m_firstByteDelivered && !stalled) {
+            stalled = true;
+            stallStart = Clock::now();
+            m_stats.stalls++;
+        }
+
+        if (m_stateChanged.wait_until(lock, deadline) == std::cv_status::timeout) {
+            if (stalled) {
+                m_stats.stallTimeMs += std::chrono::duration<double, std::milli>(Clock::now() - stallStart).count();
+            }
+            LOG_WARNING("AdaptiveStreamDataSource::Read - no data within ", m_readTimeoutMs, " ms");
+            return AVERROR(EAGAIN);
+        }
+    }
+
+    return AVERROR_EOF;
+}
+
+int64_t AdaptiveStreamDataSource::Seek(int64_t offset, int whence) {
+    if (whence == AVSEEK_SIZE) {
+        return -1;
+    }
+    return AVERROR(ENOSYS);
+}
+
+int64_t AdaptiveStreamDataSource::GetSize() const {
+    return -1;
+}
+
+bool AdaptiveStreamDataSource::IsSeekable() const {
+    return false;
+}
+
+bool AdaptiveStreamDataSource::HasCompleteHeaders() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_playlists.empty() && !m_playlists[m_currentVariant].initUrl.empty();
+}
+
+bool AdaptiveStreamDataSource::Open(const std::string& url, int variant) {
+    Close();
+
+    m_stopping = false;
+    m_openTime = Clock::now();
+    m_stats = Stats();
+    m_firstByteDelivered = false;
+
+    if (!LoadManifest(url)) {
+        LOG_ERROR("Failed to load manifest: ", url);
+        return false;
+    }
+
+    if (m_variantInfo.empty()) {
+        LOG_ERROR("No video variants in manifest: ", url);
+        return false;
+    }
+
+    int selected = variant < 0 ? 0 : variant;
+    if (selected >= static_cast<int>(m_variantInfo.size())) {
+        LOG_ERROR("Invalid variant index: ", variant, " (", m_variantInfo.size(), " variants)");
+        return false;
+    }
+
+    if (!m_isDash && m_playlists[selected].segments.empty() && !RefreshVariant(selected)) {
+        LOG_ERROR("Failed to load media playlist for variant ", selected);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_currentVariant = selected;
+        StartPosition();
+    }
+
+    for (int i = 0; i < m_fetchThreadCount; i++) {
+        m_fetchThreads.emplace_back(&AdaptiveStreamDataSource::FetchLoop, this);
+    }
+    if (IsLive()) {
+        m_refreshThread = std::thread(&AdaptiveStreamDataSource::RefreshLoop, this);
+    }
+
+    const Variant& info = m_variantInfo[selected];
+    LOG_INFO("Opened ", m_isDash ? "DASH" : "HLS", IsLive() ? " live" : "", " stream: ", url);
+    LOG_INFO("  Variants: ", m_variantInfo.size(), ", selected ", selected, " (", info.width, "x", info.height,
+             ", ", info.bandwidth, " bps)");
+    LOG_INFO("  Prefetch: ", m_prefetchCount, " segments on ", m_fetchThreadCount, " threads");
+    return true;
+}
+
+void AdaptiveStreamDataSource::Close() {
+    m_stopping = true;
+    m_stateChanged.notify_all();
+
+    for (auto& thread : m_fetchThreads) {
+        thread.join();
+    }
+    m_fetchThreads.clear();
+    if (m_refreshThread.joinable()) {
+        m_refreshThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cache.clear();
+    m_cacheBytes = 0;
+    m_variantInfo.clear();
+    m_playlists.clear();
+    m_manifestText.clear();
+    m_currentVariant = 0;
+    m_pendingVariant = -1;
+    m_cursor = 0;
+    m_sendInit = false;
+    m_initOffset = 0;
+    m_boundaryPending = false;
+    m_atBoundary = false;
+}
+
+void AdaptiveStreamDataSource::SetPrefetchCount(int segments) {
+    m_prefetchCount = std::max(1, segments);
+}
+
+void AdaptiveStreamDataSource::SetFetchThreads(int threads) {
+    m_fetchThreadCount = std::max(1, threads);
+}
+
+void AdaptiveStreamDataSource::SetMaxCacheBytes(size_t bytes) {
+    m_maxCacheBytes = bytes;
+}
+
+void AdaptiveStreamDataSource::SetFetchTimeout(int milliseconds) {
+    m_fetchTimeoutMs = std::max(1, milliseconds);
+}
+
+void AdaptiveStreamDataSource::SetReadTimeout(int milliseconds) {
+    m_readTimeoutMs = std::max(0, milliseconds);
+}
+
+int AdaptiveStreamDataSource::GetCurrentVariant() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentVariant;
+}
+
+bool AdaptiveStreamDataSource::SelectVariant(int variant) {
+    if (variant < 0 || variant >= static_cast<int>(m_variantInfo.size())) {
+        LOG_ERROR("Invalid variant index: ", variant);
+        return false;
+    }
+
+    bool needsPlaylist = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        needsPlaylist = !m_isDash && m_playlists[variant].segments.empty();
+    }
+    if (needsPlaylist && !RefreshVariant(variant)) {
+        LOG_ERROR("Failed to load media playlist for variant ", variant);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingVariant = variant == m_currentVariant ? -1 : variant;
+    PruneCache();
+
+    LOG_INFO("AdaptiveStreamDataSource - switching to variant ", variant, " after segment ", m_cursor);
+    m_stateChanged.notify_all();
+    return true;
+}
+
+bool AdaptiveStreamDataSource::IsAtVariantBoundary() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_atBoundary;
+}
+
+std::string AdaptiveStreamDataSource::GetFormatHint() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_playlists.empty()) {
+        return "";
+    }
+    return m_playlists[m_currentVariant].initUrl.empty() ? "mpegts" : "mp4";
+}
+
+bool AdaptiveStreamDataSource::IsLive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_playlists.empty() && !m_playlists[m_currentVariant].ended;
+}
+
+AdaptiveStreamDataSource::Stats AdaptiveStreamDataSource::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.segmentsCached = m_cache.size();
+    stats.bytesCached = m_cacheBytes;
+    return stats;
+}
+
+bool AdaptiveStreamDataSource::LoadManifest(const std::string& url) {
+    std::vector<uint8_t> data;
+    if (!Fetch(url, data)) {
+        return false;
+    }
+
+    std::string text(data.begin(), data.end());
+    m_manifestUrl = url;
+
+    if (text.find("#EXTM3U") != std::string::npos) {
+        m_isDash = false;
+        if (text.find("#EXT-X-STREAM-INF") != std::string::npos) {
+            return ParseHlsMaster(text, url);
+        }
+
+        // Media playlist without a master: single variant
+        VariantPlaylist playlist;
+        playlist.playlistUrl = url;
+        if (!ParseHlsMedia(text, url, playlist)) {
+            return false;
+        }
+        Variant variant;
+        variant.id = "0";
+        m_variantInfo.push_back(variant);
+        m_playlists.push_back(std::move(playlist));
+        return true;
+    }
+
+    if (text.find("<MPD") != std::string::npos) {
+        m_isDash = true;
+        m_manifestText = text;
+        return ParseMpd(text, url, false);
+    }
+
+    LOG_ERROR("Unrecognized manifest format: ", url);
+    return false;
+}
+
+bool AdaptiveStreamDataSource::ParseHlsMaster(const std::string& text, const std::string& baseUrl) {
+    std::istringstream stream(text);
+    std::string line;
+    std::map<std::string, std::string> pending;
+    bool expectUri = false;
+
+    while (std::getline(stream, line)) {
+        line = Trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        if (StartsWith(line, "#EXT-X-STREAM-INF:")) {
+            pending = ParseAttributes(line.substr(18));
+            expectUri = true;
+        } else if (line[0] != '#' && expectUri) {
+            Variant variant;
+            variant.id = std::to_string(m_variantInfo.size());
+            variant.bandwidth = ToInt(pending["BANDWIDTH"], 0);
+            variant.codecs = pending["CODECS"];
+            sscanf(pending["RESOLUTION"].c_str(), "%dx%d", &variant.width, &variant.height);
+
+            VariantPlaylist playlist;
+            playlist.playlistUrl = ResolveUrl(baseUrl, line);
+
+            m_variantInfo.push_back(variant);
+            m_playlists.push_back(std::move(playlist));
+            expectUri = false;
+        }
+    }
+
+    return !m_variantInfo.empty();
+}
+
+bool AdaptiveStreamDataSource::ParseHlsMedia(const std::string& text, const std::string& baseUrl, VariantPlaylist& playlist) {
+    std::istringstream stream(text);
+    std::string line;
+    int64_t sequence = 0;
+    double segmentDuration = 0.0;
+
+    playlist.segments.clear();
+    playlist.ended = false;
+
+    while (std::getline(stream, line)) {
+        line = Trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        if (StartsWith(line, "#EXT-X-TARGETDURATION:")) {
+            playlist.targetDuration = atof(line.c_str() + 22);
+        } else if (StartsWith(line, "#EXT-X-MEDIA-SEQUENCE:")) {
+            sequence = ToInt(line.substr(22), 0);
+        } else if (StartsWith(line, "#EXTINF:")) {
+            segmentDuration = atof(line.c_str() + 8);
+        } else if (StartsWith(line, "#EXT-X-MAP:")) {
+            playlist.initUrl = ResolveUrl(baseUrl, ParseAttributes(line.substr(11))["URI"]);
+        } else if (StartsWith(line, "#EXT-X-ENDLIST") || line == "#EXT-X-PLAYLIST-TYPE:VOD") {
+            playlist.ended = true;
+        } else if (StartsWith(line, "#EXT-X-BYTERANGE")) {
+            LOG_ERROR("HLS byte-range segments are not supported: ", baseUrl);
+            return false;
+        } else if (line[0] != '#') {
+            playlist.segments.push_back({ sequence++, segmentDuration, ResolveUrl(baseUrl, line) });
+            segmentDuration = 0.0;
+        }
+    }
+
+    return true;
+}
+
+bool AdaptiveStreamDataSource::ParseMpd(const std::string& text, const std::string& baseUrl, bool refresh) {
+    XmlElement mpd = FindFirst(text, "MPD", 0, text.size());
+    if (mpd.begin == std::string::npos) {
+        return false;
+    }
+
+    bool dynamic = GetAttribute(text, mpd, "type") == "dynamic";
+    double presentationDuration = ParseIsoDuration(GetAttribute(text, mpd, "mediaPresentationDuration"));
+    double availabilityStart = ParseIsoDateTime(GetAttribute(text, mpd, "availabilityStartTime"));
+    double timeShiftDepth = ParseIsoDuration(GetAttribute(text, mpd, "timeShiftBufferDepth"));
+    m_dashUpdatePeriod = ParseIsoDuration(GetAttribute(text, mpd, "minimumUpdatePeriod"));
+
+    XmlElement period = FindFirst(text, "Period", mpd.tagEnd, mpd.end);
+    if (period.begin == std::string::npos) {
+        LOG_ERROR("MPD has no Period");
+        return false;
+    }
+    double periodStart = ParseIsoDuration(GetAttribute(text, period, "start"));
+    double periodDuration = ParseIsoDuration(GetAttribute(text, period, "duration"));
+    if (periodDuration <= 0.0) {
+        periodDuration = presentationDuration - periodStart;
+    }
+
+    std::string mpdBase = ResolveUrl(baseUrl, GetText(text, FindFirst(text, "BaseURL", mpd.tagEnd, period.begin)));
+
+    // First video adaptation set
+    XmlElement adaptationSet = { std::string::npos, 0, 0 };
+    for (const XmlElement& candidate : FindElements(text, "AdaptationSet", period.tagEnd, period.end)) {
+        std::string type = GetAttribute(text, candidate, "mimeType") + GetAttribute(text, candidate, "contentType");
+        XmlElement firstRepresentation = FindFirst(text, "Representation", candidate.tagEnd, candidate.end);
+        type += GetAttribute(text, firstRepresentation, "mimeType");
+        if (type.find("video") != std::string::npos) {
+            adaptationSet = candidate;
+            break;
+        }
+    }
+    if (adaptationSet.begin == std::string::npos) {
+        LOG_ERROR("MPD has no video AdaptationSet");
+        return false;
+    }
+
+    std::vector<XmlElement> representations = FindElements(text, "Representation", adaptationSet.tagEnd, adaptationSet.end);
+    if (representations.empty()) {
+        return false;
+    }
+    if (refresh && representations.size() != m_playlists.size()) {
+        LOG_WARNING("MPD refresh changed the representation list, keeping the previous one");
+        return false;
+    }
+
+    size_t periodChildren = FindFirst(text, "AdaptationSet", period.tagEnd, period.end).begin;
+    std::string periodBase = ResolveUrl(mpdBase, GetText(text, FindFirst(text, "BaseURL", period.tagEnd, periodChildren)));
+    size_t setChildren = representations.front().begin;
+    std::string setBase = ResolveUrl(periodBase, GetText(text, FindFirst(text, "BaseURL", adaptationSet.tagEnd, setChildren)));
+    XmlElement setTemplate = FindFirst(text, "SegmentTemplate", adaptationSet.tagEnd, setChildren);
+    std::string setCodecs = GetAttribute(text, adaptationSet, "codecs");
+
+    std::vector<Variant> variants;
+    std::vector<VariantPlaylist> playlists;
+
+    for (const XmlElement& representation : representations) {
+        Variant variant;
+        variant.id = GetAttribute(text, representation, "id");
+        variant.bandwidth = ToInt(GetAttribute(text, representation, "bandwidth"), 0);
+        variant.width = static_cast<int>(ToInt(GetAttribute(text, representation, "width"), 0));
+        variant.height = static_cast<int>(ToInt(GetAttribute(text, representation, "height"), 0));
+        variant.codecs = GetAttribute(text, representation, "codecs");
+        if (variant.codecs.empty()) {
+            variant.codecs = setCodecs;
+        }
+
+        std::string base = ResolveUrl(setBase, GetText(text, FindFirst(text, "BaseURL", representation.tagEnd, representation.end)));
+
+        // Representation-level SegmentTemplate attributes override the adaptation set's
+        XmlElement repTemplate = FindFirst(text, "SegmentTemplate", representation.tagEnd, representation.end);
+        auto templateAttribute = [&](const char* name) {
+            std::string value = GetAttribute(text, repTemplate, name);
+            return value.empty() ? GetAttribute(text, setTemplate, name) : value;
+        };
+
+        std::string media = templateAttribute("media");
+        if (media.empty()) {
+            LOG_ERROR("Representation ", variant.id, " has no SegmentTemplate (SegmentBase/SegmentList are not supported)");
+            return false;
+        }
+        std::string initialization = templateAttribute("initialization");
+        int64_t startNumber = ToInt(templateAttribute("startNumber"), 1);
+        int64_t timescale = std::max<int64_t>(1, ToInt(templateAttribute("timescale"), 1));
+        int64_t duration = ToInt(templateAttribute("duration"), 0);
+        int64_t timeOffset = ToInt(templateAttribute("presentationTimeOffset"), 0);
+
+        VariantPlaylist playlist;
+        playlist.ended = !dynamic;
+        if (!initialization.empty()) {
+            playlist.initUrl = ResolveUrl(base, ExpandTemplate(initialization, variant.id, variant.bandwidth, 0, 0));
+        }
+
+        // Live edge in media timescale units
+        double elapsed = NowSeconds() - availabilityStart - periodStart;
+        int64_t liveEdge = timeOffset + static_cast<int64_t>(elapsed * timescale);
+        int64_t periodEnd = timeOffset + static_cast<int64_t>(periodDuration * timescale);
+
+        XmlElement timelineOwner = FindFirst(text, "SegmentTimeline", repTemplate.begin == std::string::npos ? 0 : repTemplate.tagEnd,
+                                             repTemplate.begin == std::string::npos ? 0 : repTemplate.end);
+        if (timelineOwner.begin == std::string::npos && setTemplate.begin != std::string::npos) {
+            timelineOwner = FindFirst(text, "SegmentTimeline", setTemplate.tagEnd, setTemplate.end);
+        }
+
+        if (timelineOwner.begin != std::string::npos) {
+            std::vector<XmlElement> entries = FindElements(text, "S", timelineOwner.tagEnd, timelineOwner.end);
+            int64_t time = 0;
+            int64_t number = startNumber;
+            for (size_t i = 0; i < entries.size(); i++) {
+                std::string t = GetAttribute(text, entries[i], "t");
+                if (!t.empty()) {
+                    time = ToInt(t, time);
+                }
+                int64_t d = ToInt(GetAttribute(text, entries[i], "d"), 0);
+                int64_t repeat = ToInt(GetAttribute(text, entries[i], "r"), 0);
+                if (d <= 0) {
+                    continue;
+                }
+                if (repeat < 0) {
+                    // Repeat until the next entry, the period end or the live edge
+                    int64_t end = dynamic ? liveEdge : periodEnd;
+                    if (i + 1 < entries.size() && !GetAttribute(text, entries[i + 1], "t").empty()) {
+                        end = ToInt(GetAttribute(text, entries[i + 1], "t"), end);
+                    }
+                    repeat = std::max<int64_t>(0, (end - time + d - 1) / d - 1);
+                }
+                for (int64_t k = 0; k <= repeat; k++) {
+                    std::string url = ExpandTemplate(media, variant.id, variant.bandwidth, number, time);
+                    playlist.segments.push_back({ number, static_cast<double>(d) / timescale, ResolveUrl(base, url) });
+                    time += d;
+                    number++;
+                }
+            }
+        } else if (duration > 0) {
+            double segmentDuration = static_cast<double>(duration) / timescale;
+            int64_t first = startNumber;
+            int64_t last;
+            if (dynamic) {
+                last = startNumber + static_cast<int64_t>(std::floor(elapsed / segmentDuration)) - 1;
+                int64_t window = timeShiftDepth > 0.0 ? static_cast<int64_t>(std::ceil(timeShiftDepth / segmentDuration))
+                                                      : DASH_DEFAULT_WINDOW;
+                first = std::max(startNumber, last - window + 1);
+            } else {
+                last = startNumber + static_cast<int64_t>(std::ceil(periodDuration / segmentDuration)) - 1;
+            }
+            for (int64_t number = first; number <= last; number++) {
+                std::string url = ExpandTemplate(media, variant.id, variant.bandwidth, number, (number - startNumber) * duration);
+                playlist.segments.push_back({ number, segmentDuration, ResolveUrl(base, url) });
+            }
+        } else {
+            LOG_ERROR("Representation ", variant.id, " has neither a SegmentTimeline nor a segment duration");
+            return false;
+        }
+
+        for (const SegmentInfo& segment : playlist.segments) {
+            playlist.targetDuration = std::max(playlist.targetDuration, segment.duration);
+        }
+
+        variants.push_back(variant);
+        playlists.push_back(std::move(playlist));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!refresh) {
+        m_variantInfo = std::move(variants);
+    }
+    m_playlists = std::move(playlists);
+    m_stateChanged.notify_all();
+    return true;
+}
+
+bool AdaptiveStreamDataSource::RefreshVariant(int variant) {
+    if (m_isDash) {
+        // Re-fetch only when the MPD announces updates; otherwise re-evaluate it against the clock
+        if (m_dashUpdatePeriod > 0.0) {
+            std::vector<uint8_t> data;
+            if (!Fetch(m_manifestUrl, data)) {
+                return false;
+            }
+            m_manifestText.assign(data.begin(), data.end());
+        }
+        return ParseMpd(m_manifestText, m_manifestUrl, true);
+    }
+
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        url = m_playlists[variant].playlistUrl;
+    }
+
+    std::vector<uint8_t> data;
+    if (!Fetch(url, data)) {
+        return false;
+    }
+
+    VariantPlaylist playlist;
+    playlist.playlistUrl = url;
+    if (!ParseHlsMedia(std::string(data.begin(), data.end()), url, playlist)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_playlists[variant] = std::move(playlist);
+    m_stateChanged.notify_all();
+    return true;
+}
+
+void AdaptiveStreamDataSource::FetchLoop() {
+    while (true) {
+        SegmentKey key;
+        std::string url;
+        uint64_t fetchId = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stateChanged.wait(lock, [&]() { return m_stopping || FindFetchTask(key, url, fetchId); });
+            if (m_stopping) {
+                return;
+            }
+        }
+
+        std::vector<uint8_t> data;
+        bool fetched = false;
+        for (int attempt = 0; attempt < FETCH_ATTEMPTS && !m_stopping && !fetched; attempt++) {
+            data.clear();
+            fetched = Fetch(url, data);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Discarded by Close() or a variant switch, possibly re-requested since (A -> B -> A
+            // before the boundary): only the download that owns the entry fills it
+            auto it = m_cache.find(key);
+            if (it == m_cache.end() || it->second.fetchId != fetchId) {
+                continue;
+            }
+            if (fetched) {
+                m_cacheBytes += data.size();
+                m_stats.segmentsFetched++;
+                m_stats.bytesFetched += data.size();
+                it->second.data = std::move(data);
+                it->second.state = CachedSegment::State::Ready;
+            } else {
+                m_stats.segmentsFailed++;
+                it->second.state = CachedSegment::State::Failed;
+            }
+        }
+        m_stateChanged.notify_all();
+    }
+}
+
+void AdaptiveStreamDataSource::RefreshLoop() {
+    while (!m_stopping) {
+        double interval;
+        int current;
+        int pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_playlists[m_currentVariant].ended) {
+                return;
+            }
+            current = m_currentVariant;
+            pending = m_pendingVariant;
+            interval = m_isDash && m_dashUpdatePeriod > 0.0 ? m_dashUpdatePeriod : m_playlists[current].targetDuration;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stateChanged.wait_for(lock, std::chrono::duration<double>(std::max(1.0, interval)), [this]() {
+            return m_stopping.load();
+        });
+        lock.unlock();
+        if (m_stopping) {
+            return;
+        }
+
+        if (!RefreshVariant(current)) {
+            LOG_WARNING("AdaptiveStreamDataSource - playlist refresh failed for variant ", current);
+        }
+        if (!m_isDash && pending >= 0 && pending != current) {
+            RefreshVariant(pending);
+        }
+    }
+}
+
+bool AdaptiveStreamDataSource::FindFetchTask(SegmentKey& key, std::string& url, uint64_t& fetchId) {
+    if (m_playlists.empty() || m_cacheBytes >= m_maxCacheBytes) {
+        return false;
+    }
+
+    const int nextVariant = m_pendingVariant >= 0 ? m_pendingVariant : m_currentVariant;
+
+    // Init segments first: the current one is needed before any media
+    for (int variant : { m_currentVariant, nextVariant }) {
+        const std::string& initUrl = m_playlists[variant].initUrl;
+        if (!initUrl.empty() && m_cache.find({ variant, -1 }) == m_cache.end()) {
+            key = { variant, -1 };
+            url = initUrl;
+            fetchId = ++m_lastFetchId;
+            m_cache[key] = CachedSegment();
+            m_cache[key].fetchId = fetchId;
+            return true;
+        }
+    }
+
+    // The segment being read belongs to the current variant, later ones to the next
+    for (int i = 0; i < m_prefetchCount; i++) {
+        int variant = i == 0 ? m_currentVariant : nextVariant;
+        const SegmentInfo* segment = FindSegment(variant, m_cursor + i);
+        if (!segment) {
+            break;
+        }
+        if (m_cache.find({ variant, segment->sequence }) == m_cache.end()) {
+            key = { variant, segment->sequence };
+            url = segment->url;
+            fetchId = ++m_lastFetchId;
+            m_cache[key] = CachedSegment();
+            m_cache[key].fetchId = fetchId;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AdaptiveStreamDataSource::Fetch(const std::string& url, std::vector<uint8_t>& data) {
+    AVIOInterruptCB interrupt = { &AdaptiveStreamDataSource::InterruptCallback, this };
+    AVDictionary* options = nullptr;
+    av_dict_set_int(&options, "rw_timeout", static_cast<int64_t>(m_fetchTimeoutMs) * 1000, 0);
+
+    AVIOContext* io = nullptr;
+    int ret = avio_open2(&io, url.c_str(), AVIO_FLAG_READ, &interrupt, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        if (!m_stopping) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_WARNING("Cannot open ", url, ": ", errorBuf);
+        }
+        return false;
+    }
+
+    int64_t size = avio_size(io);
+    if (size > 0) {
+        data.reserve(static_cast<size_t>(size));
+    }
+
+    const int CHUNK_SIZE = 64 * 1024;
+    while (true) {
+        size_t offset = data.size();
+        data.resize(offset + CHUNK_SIZE);
+        ret = avio_read(io, data.data() + offset, CHUNK_SIZE);
+        data.resize(offset + std::max(ret, 0));
+        if (ret <= 0) {
+            break;
+        }
+    }
+    avio_closep(&io);
+
+    if (ret < 0 && ret != AVERROR_EOF) {
+        if (!m_stopping) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_WARNING("Error reading ", url, ": ", errorBuf);
+        }
+        return false;
+    }
+
+    LOG_DEBUG("Fetched ", url, " (", data.size(), " bytes)");
+    return true;
+}
+
+int AdaptiveStreamDataSource::InterruptCallback(void* opaque) {
+    return static_cast<AdaptiveStreamDataSource*>(opaque)->m_stopping ? 1 : 0;
+}
+
+const AdaptiveStreamDataSource::SegmentInfo* AdaptiveStreamDataSource::FindSegment(int variant, int64_t sequence) const {
+    const std::vector<SegmentInfo>& segments = m_playlists[variant].segments;
+    if (segments.empty() || sequence < segments.front().sequence) {
+        return nullptr;
+    }
+
+    // Sequence numbers are contiguous within a playlist
+    size_t index = static_cast<size_t>(sequence - segments.front().sequence);
+    return index < segments.size() ? &segments[index] : nullptr;
+}
+
+void AdaptiveStreamDataSource::AdvanceSegment() {
+    m_cursor++;
+
+    if (m_pendingVariant >= 0 && m_pendingVariant != m_currentVariant) {
+        int previous = m_currentVariant;
+        m_currentVariant = m_pendingVariant;
+        m_pendingVariant = -1;
+
+        // New decoder parameters arrive in the new init segment: end this byte stream here
+        if (!m_playlists[m_currentVariant].initUrl.empty()) {
+            m_sendInit = true;
+            m_initOffset = 0;
+            m_boundaryPending = true;
+        }
+        LOG_INFO("AdaptiveStreamDataSource - switched from variant ", previous, " to ", m_currentVariant,
+                 " at segment ", m_cursor);
+    }
+
+    PruneCache();
+    m_stateChanged.notify_all();
+}
+
+void AdaptiveStreamDataSource::PruneCache() {
+    const int nextVariant = m_pendingVariant >= 0 ? m_pendingVariant : m_currentVariant;
+
+    // Keep init segments, the segment being read and prefetched segments of the variant that follows.
+    // In-flight downloads that are dropped here are discarded when they complete.
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        int variant = it->first.first;
+        int64_t sequence = it->first.second;
+        bool keep = sequence < 0 ||
+                    (sequence == m_cursor && variant == m_currentVariant) ||
+                    (sequence > m_cursor && variant == nextVariant);
+        if (keep) {
+            ++it;
+        } else {
+            m_cacheBytes -= it->second.data.size();
+            it = m_cache.erase(it);
+        }
+    }
+}
+
+void AdaptiveStreamDataSource::StartPosition() {
+    const VariantPlaylist& playlist = m_playlists[m_currentVariant];
+    m_cursor = 0;
+    if (!playlist.segments.empty()) {
+        size_t start = 0;
+        if (!playlist.ended && playlist.segments.size() > LIVE_START_SEGMENTS) {
+            start = playlist.segments.size() - LIVE_START_SEGMENTS;
+        }
+        m_cursor = playlist.segments[start].sequence;
+    }
+    m_sendInit = true;
+    m_initOffset = 0;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "IDataSource.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+/**
+ * HLS / DASH segment source with parallel prefetch.
+ * Parses an HLS master or media playlist or a DASH MPD (SegmentTemplate with $Number$ or
+ * SegmentTimeline), then downloads the next segments of the selected variant on a pool of
+ * worker threads while earlier segments are being demuxed. The reader sees one continuous
+ * byte stream: the variant's init segment (fMP4 / CMAF) followed by its media segments.
+ * Segments are freed as soon as they have been read; at most GetPrefetchCount() segments
+ * are downloaded ahead. Live playlists are refreshed in the background.
+ *
+ * Variant switches take effect at the next segment boundary. For MPEG-TS variants the new
+ * segments simply follow in the stream. For fMP4 variants the decoder parameters come from a
+ * new init segment, so Read() reports end of stream at the boundary (IsAtVariantBoundary()
+ * becomes true) and the caller reopens the demuxer on the same source to continue.
+ *
+ * Segment URLs are fetched through FFmpeg's protocol layer (http, https, file, ...), so a
+ * local directory of playlists and segments works offline.
+ */
+class AdaptiveStreamDataSource : public IDataSource {
+public:
+    struct Variant {
+        std::string id;             // DASH Representation id or HLS variant index
+        int64_t bandwidth = 0;      // Bits per second
+        int width = 0;
+        int height = 0;
+        std::string codecs;
+    };
+
+    struct Stats {
+        uint64_t segmentsFetched = 0;
+        uint64_t segmentsFailed = 0;        // Skipped after all retries
+        uint64_t bytesFetched = 0;
+        uint64_t stalls = 0;                // Reads that had to wait for a download
+        double stallTimeMs = 0.0;
+        double startupTimeMs = 0.0;         // Open() until the first media byte was readable
+        size_t segmentsCached = 0;
+        size_t bytesCached = 0;
+    };
+
+    AdaptiveStreamDataSource();
+    ~AdaptiveStreamDataSource() override;
+
+    // IDataSource interface
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    int64_t GetSize() const override;
+    bool IsSeekable() const override;
+    bool HasCompleteHeaders() const override;
+
+    /**
+     * Load the manifest and start prefetching.
+     * @param url HLS playlist (.m3u8) or DASH manifest (.mpd)
+     * @param variant Index into GetVariants(); -1 selects the first listed variant
+     */
+    bool Open(const std::string& url, int variant = -1);
+    void Close();
+
+    // Configuration (before Open)
+    void SetPrefetchCount(int segments);        // Segments downloaded ahead (default: 3)
+    void SetFetchThreads(int threads);          // Parallel downloads (default: 3)
+    void SetMaxCacheBytes(size_t bytes);        // Upper bound on downloaded, unread data (default: 64 MB)
+    void SetFetchTimeout(int milliseconds);     // Per-request I/O timeout (default: 10000 ms)
+    void SetReadTimeout(int milliseconds);      // Maximum wait in Read() (default: 10000 ms)
+
+    // Variants
+    const std::vector<Variant>& GetVariants() const { return m_variantInfo; }
+    int GetCurrentVariant() const;
+    bool SelectVariant(int variant);            // Applied at the next segment boundary
+    bool IsAtVariantBoundary() const;
+
+    // Demuxer format for the current variant ("mp4" or "mpegts")
+    std::string GetFormatHint() const;
+
+    bool IsLive() const;
+    int GetPrefetchCount() const { return m_prefetchCount; }
+    Stats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct SegmentInfo {
+        int64_t sequence;
+        double duration;        // Seconds
+        std::string url;
+    };
+
+    struct VariantPlaylist {
+        std::string playlistUrl;    // HLS media playlist, empty for DASH
+        std::string initUrl;
+        std::vector<SegmentInfo> segments;
+        double targetDuration = 0.0;
+        bool ended = false;
+    };
+
+    struct CachedSegment {
+        enum class State { Fetching, Ready, Failed };
+        State state = State::Fetching;
+        std::vector<uint8_t> data;
+        size_t readOffset = 0;
+        uint64_t fetchId = 0;       // Download that fills this entry; others complete stale
+    };
+
+    // Cache key: (variant, sequence); sequence -1 is the variant's init segment
+    using SegmentKey = std::pair<int, int64_t>;
+
+    std::string m_manifestUrl;
+    std::string m_manifestText;     // DASH: last MPD, re-evaluated against the clock on refresh
+    bool m_isDash;
+    double m_dashUpdatePeriod;
+    std::vector<Variant> m_variantInfo;
+    std::vector<VariantPlaylist> m_playlists;
+
+    std::map<SegmentKey, CachedSegment> m_cache;
+    size_t m_cacheBytes;
+    uint64_t m_lastFetchId;
+    int m_currentVariant;
+    int m_pendingVariant;
+    int64_t m_cursor;               // Sequence number of the segment being read
+    bool m_sendInit;                // Deliver the current variant's init segment first
+    size_t m_initOffset;
+    bool m_boundaryPending;         // Next Read() reports the variant boundary
+    bool m_atBoundary;
+    bool m_firstByteDelivered;
+    Clock::time_point m_openTime;
+    Stats m_stats;
+
+    int m_prefetchCount;
+    int m_fetchThreadCount;
+    size_t m_maxCacheBytes;
+    int m_fetchTimeoutMs;
+    int m_readTimeoutMs;
+
+    std::vector<std::thread> m_fetchThreads;
+    std::thread m_refreshThread;
+    std::atomic<bool> m_stopping;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stateChanged;
+
+    // Manifests
+    bool LoadManifest(const std::string& url);
+    bool ParseHlsMaster(const std::string& text, const std::string& baseUrl);
+    bool ParseHlsMedia(const std::string& text, const std::string& baseUrl, VariantPlaylist& playlist);
+    bool ParseMpd(const std::string& text, const std::string& baseUrl, bool refresh);
+    bool RefreshVariant(int variant);
+
+    // Workers
+    void FetchLoop();
+    void RefreshLoop();
+    bool FindFetchTask(SegmentKey& key, std::string& url, uint64_t& fetchId);
+    bool Fetch(const std::string& url, std::vector<uint8_t>& data);
+    static int InterruptCallback(void* opaque);
+
+    const SegmentInfo* FindSegment(int variant, int64_t sequence) const;
+    void AdvanceSegment();
+    void PruneCache();
+    void StartPosition();
+};
@@ -0,0 +1,265 @@
+#include "BroadcastBuffer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavformat/avio.h>
+}
+
+BroadcastBuffer::BroadcastBuffer(size_t capacity)
+    : m_ring(std::max<size_t>(capacity, 64 * 1024))
+    , m_writePosition(0)
+    , m_eof(false)
+    , m_maxWriterWaitMs(1000)
+{
+}
+
+BroadcastBuffer::~BroadcastBuffer() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_readers.empty()) {
+        LOG_ERROR("BroadcastBuffer destroyed with ", m_readers.size(), " reader(s) still attached");
+    }
+}
+
+bool BroadcastBuffer::Write(const uint8_t* data, size_t size, bool syncPoint) {
+    if (size > m_ring.size()) {
+        LOG_ERROR("BroadcastBuffer::Write - ", size, " bytes exceed the ring capacity of ", m_ring.size());
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (syncPoint) {
+        m_syncPoints.push_back(m_writePosition);
+        m_stats.syncPoints++;
+
+        // Readers that were cut past every sync point resume here
+        for (BroadcastReader* reader : m_readers) {
+            if (reader->m_waitingForSync) {
+                reader->m_waitingForSync = false;
+                reader->m_cursor = m_writePosition;
+            }
+        }
+    }
+
+    // Bytes before reclaimEnd are overwritten by this write
+    uint64_t end = m_writePosition + size;
+    uint64_t reclaimEnd = end > m_ring.size() ? end - m_ring.size() : 0;
+
+    if (HasLaggingReaders(reclaimEnd, true)) {
+        m_stats.writerWaits++;
+        auto waitStart = std::chrono::steady_clock::now();
+        m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(m_maxWriterWaitMs), [this, reclaimEnd]() {
+            return !HasLaggingReaders(reclaimEnd, true);
+        });
+        m_stats.writerWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+
+    for (BroadcastReader* reader : m_readers) {
+        if (!reader->m_waitingForSync && reader->m_cursor < reclaimEnd) {
+            CutForward(reader, reclaimEnd);
+        }
+    }
+
+    while (!m_syncPoints.empty() && m_syncPoints.front() < reclaimEnd) {
+        m_syncPoints.pop_front();
+    }
+
+    // Store once, wrapping at most once
+    size_t offset = static_cast<size_t>(m_writePosition % m_ring.size());
+    size_t first = std::min(size, m_ring.size() - offset);
+    memcpy(m_ring.data() + offset, data, first);
+    if (first < size) {
+        memcpy(m_ring.data(), data + first, size - first);
+    }
+    m_writePosition = end;
+    m_stats.bytesWritten += size;
+
+    lock.unlock();
+    m_dataAvailable.notify_all();
+    return true;
+}
+
+void BroadcastBuffer::SetHeader(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_header.assign(data, data + size);
+}
+
+void BroadcastBuffer::SetEOF(bool eof) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_eof = eof;
+    }
+    m_dataAvailable.notify_all();
+    LOG_DEBUG("BroadcastBuffer::SetEOF - EOF set to ", eof);
+}
+
+void BroadcastBuffer::SetMaxWriterWait(int milliseconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxWriterWaitMs = std::max(0, milliseconds);
+}
+
+std::unique_ptr<BroadcastReader> BroadcastBuffer::CreateReader(ReaderPolicy policy, StartPosition start) {
+    std::unique_ptr<BroadcastReader> reader(new BroadcastReader(*this, policy));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_syncPoints.empty()) {
+        reader->m_waitingForSync = true;
+        reader->m_cursor = m_writePosition;
+    } else {
+        reader->m_cursor = start == StartPosition::OldestSyncPoint ? m_syncPoints.front() : m_syncPoints.back();
+    }
+    m_readers.push_back(reader.get());
+    m_stats.readers = m_readers.size();
+    return reader;
+}
+
+BroadcastBuffer::Stats BroadcastBuffer::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool BroadcastBuffer::HasLaggingReaders(uint64_t reclaimEnd, bool waitReadersOnly) const {
+    for (const BroadcastReader* reader : m_readers) {
+        if (waitReadersOnly && reader->m_policy != ReaderPolicy::Wait) {
+            continue;
+        }
+        if (!reader->m_waitingForSync && reader->m_cursor < reclaimEnd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BroadcastBuffer::CutForward(BroadcastReader* reader, uint64_t reclaimEnd) {
+    uint64_t previous = reader->m_cursor;
+
+    auto next = std::lower_bound(m_syncPoints.begin(), m_syncPoints.end(), reclaimEnd);
+    if (next != m_syncPoints.end()) {
+        reader->m_cursor = *next;
+    } else {
+        // No sync point survives: skip everything up to the next one written
+        reader->m_cursor = m_writePosition;
+        reader->m_waitingForSync = true;
+    }
+
+    uint64_t skipped = reader->m_cursor - previous;
+    reader->m_stats.cuts++;
+    reader->m_stats.bytesSkipped += skipped;
+    m_stats.readerCuts++;
+    m_stats.bytesSkipped += skipped;
+    LOG_WARNING("BroadcastBuffer - reader fell behind, skipped ", skipped, " bytes",
+                reader->m_waitingForSync ? " (waiting for the next sync point)" : "");
+}
+
+void BroadcastBuffer::RemoveReader(BroadcastReader* reader) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_readers.erase(std::remove(m_readers.begin(), m_readers.end(), reader), m_readers.end());
+        m_stats.readers = m_readers.size();
+    }
+    m_spaceAvailable.notify_one();
+}
+
+BroadcastReader::BroadcastReader(BroadcastBuffer& buffer, BroadcastBuffer::ReaderPolicy policy)
+    : m_buffer(buffer)
+    , m_policy(policy)
+    , m_cursor(0)
+    , m_waitingForSync(false)
+    , m_headerOffset(0)
+    , m_position(0)
+    , m_readTimeoutMs(5000)
+{
+}
+
+BroadcastReader::~BroadcastReader() {
+    m_buffer.RemoveReader(this);
+}
+
+int BroadcastReader::Read(uint8_t* buffer, int size) {
+    if (size <= 0) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(m_buffer.m_mutex);
+
+    // Header first
+    if (m_headerOffset < m_buffer.m_header.size()) {
+        size_t toRead = std::min(static_cast<size_t>(size), m_buffer.m_header.size() - m_headerOffset);
+        memcpy(buffer, m_buffer.m_header.data() + m_headerOffset, toRead);
+        m_headerOffset += toRead;
+        m_position += static_cast<int64_t>(toRead);
+        return static_cast<int>(toRead);
+    }
+
+    bool ready = m_buffer.m_dataAvailable.wait_for(lock, std::chrono::milliseconds(m_readTimeoutMs), [this]() {
+        return (!m_waitingForSync && m_cursor < m_buffer.m_writePosition) || m_buffer.m_eof;
+    });
+
+    if (m_waitingForSync || m_cursor >= m_buffer.m_writePosition) {
+        if (m_buffer.m_eof) {
+            LOG_DEBUG("BroadcastReader::Read - EOF reached");
+            return AVERROR_EOF;
+        }
+        if (!ready) {
+            LOG_WARNING("BroadcastReader::Read - no data within ", m_readTimeoutMs, " ms");
+        }
+        return AVERROR(EAGAIN);
+    }
+
+    const std::vector<uint8_t>& ring = m_buffer.m_ring;
+    size_t toRead = static_cast<size_t>(std::min<uint64_t>(static_cast<uint64_t>(size), m_buffer.m_writePosition - m_cursor));
+    size_t offset = static_cast<size_t>(m_cursor % ring.size());
+    size_t first = std::min(toRead, ring.size() - offset);
+    memcpy(buffer, ring.data() + offset, first);
+    if (first < toRead) {
+        memcpy(buffer + first, ring.data(), toRead - first);
+    }
+
+    m_cursor += toRead;
+    m_position += static_cast<int64_t>(toRead);
+    m_stats.bytesRead += toRead;
+
+    bool wakeWriter = m_policy == BroadcastBuffer::ReaderPolicy::Wait;
+    lock.unlock();
+    if (wakeWriter) {
+        m_buffer.m_spaceAvailable.notify_one();
+    }
+    return static_cast<int>(toRead);
+}
+
+int64_t BroadcastReader::Seek(int64_t offset, int whence) {
+    std::lock_guard<std::mutex> lock(m_buffer.m_mutex);
+
+    // Live stream: only position queries are answered
+    if (whence == SEEK_CUR && offset == 0) {
+        return m_position;
+    }
+    if (whence == AVSEEK_SIZE) {
+        return -1;
+    }
+    return AVERROR(ENOSYS);
+}
+
+int64_t BroadcastReader::GetSize() const {
+    return -1;
+}
+
+bool BroadcastReader::IsSeekable() const {
+    return false;
+}
+
+void BroadcastReader::SetReadTimeout(int milliseconds) {
+    std::lock_guard<std::mutex> lock(m_buffer.m_mutex);
+    m_readTimeoutMs = std::max(0, milliseconds);
+}
+
+BroadcastReader::Stats BroadcastReader::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_buffer.m_mutex);
+    Stats stats = m_stats;
+    stats.lagBytes = m_waitingForSync ? 0 : m_buffer.m_writePosition - m_cursor;
+    return stats;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "IDataSource.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+class BroadcastReader;
+
+/**
+ * Single-writer, multi-reader ring buffer for fanning out one live compressed stream.
+ * The stream is stored once; every reader is an IDataSource with its own position, so a
+ * decoder, a recorder and a forwarder can consume the same bytes at their own pace.
+ *
+ * The writer marks sync points (keyframe / fragment / random access starts) as it writes.
+ * New readers join at the latest sync point. When the ring is full, readers that would lose
+ * unread data are handled by their policy:
+ *  - SkipToSyncPoint: the reader is cut forward to the next retained sync point (live decode)
+ *  - Wait: the writer waits up to the maximum writer wait for the reader to catch up (recording),
+ *    and cuts it forward only after that
+ *
+ * An optional header (e.g. an fMP4 init segment) is delivered to each reader before its
+ * first sync point. Readers must be destroyed before the buffer.
+ */
+class BroadcastBuffer {
+public:
+    enum class ReaderPolicy {
+        SkipToSyncPoint,
+        Wait
+    };
+
+    enum class StartPosition {
+        LatestSyncPoint,    // Lowest latency
+        OldestSyncPoint     // Most history still in the ring
+    };
+
+    struct Stats {
+        uint64_t bytesWritten = 0;
+        uint64_t syncPoints = 0;
+        uint64_t writerWaits = 0;       // Writes that had to wait for a Wait reader
+        double writerWaitMs = 0.0;
+        uint64_t readerCuts = 0;        // Readers cut forward to a sync point
+        uint64_t bytesSkipped = 0;      // Unread bytes dropped by cuts, all readers
+        size_t readers = 0;
+    };
+
+    /**
+     * @param capacity Ring size in bytes; a single write may not exceed it
+     */
+    explicit BroadcastBuffer(size_t capacity = 16 * 1024 * 1024);
+    ~BroadcastBuffer();
+
+    // Writer
+    bool Write(const uint8_t* data, size_t size, bool syncPoint = false);
+    void SetHeader(const uint8_t* data, size_t size);
+    void SetEOF(bool eof);
+
+    // Maximum time Write() waits for Wait readers before cutting them forward (default: 1000 ms)
+    void SetMaxWriterWait(int milliseconds);
+
+    // Readers
+    std::unique_ptr<BroadcastReader> CreateReader(ReaderPolicy policy = ReaderPolicy::SkipToSyncPoint,
+                                                  StartPosition start = StartPosition::LatestSyncPoint);
+
+    size_t GetCapacity() const { return m_ring.size(); }
+    Stats GetStats() const;
+
+private:
+    friend class BroadcastReader;
+
+    std::vector<uint8_t> m_ring;
+    uint64_t m_writePosition;           // Total bytes written
+    std::deque<uint64_t> m_syncPoints;  // Retained sync point positions, ascending
+    std::vector<uint8_t> m_header;
+    std::vector<BroadcastReader*> m_readers;
+    bool m_eof;
+    int m_maxWriterWaitMs;
+    Stats m_stats;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_dataAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    bool HasLaggingReaders(uint64_t reclaimEnd, bool waitReadersOnly) const;
+    void CutForward(BroadcastReader* reader, uint64_t reclaimEnd);
+    void RemoveReader(BroadcastReader* reader);
+};
+
+/**
+ * One reader cursor of a BroadcastBuffer.
+ * Read() blocks until data is available, the read timeout expires or the writer ends the stream.
+ */
+class BroadcastReader : public IDataSource {
+public:
+    struct Stats {
+        uint64_t bytesRead = 0;
+        uint64_t cuts = 0;              // Times this reader was cut forward
+        uint64_t bytesSkipped = 0;
+        uint64_t lagBytes = 0;          // Written but not yet read
+    };
+
+    ~BroadcastReader() override;
+
+    // IDataSource interface
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    int64_t GetSize() const override;
+    bool IsSeekable() const override;
+
+    // Maximum time Read() waits for data (default: 5000 ms)
+    void SetReadTimeout(int milliseconds);
+
+    BroadcastBuffer::ReaderPolicy GetPolicy() const { return m_policy; }
+    Stats GetStats() const;
+
+private:
+    friend class BroadcastBuffer;
+
+    BroadcastReader(BroadcastBuffer& buffer, BroadcastBuffer::ReaderPolicy policy);
+
+    // Guarded by the buffer's mutex
+    BroadcastBuffer& m_buffer;
+    BroadcastBuffer::ReaderPolicy m_policy;
+    uint64_t m_cursor;                  // Next ring position to read
+    bool m_waitingForSync;              // Cut past all retained sync points: resume at the next one
+    size_t m_headerOffset;              // Header bytes already delivered
+    int64_t m_position;                 // Bytes delivered through Read()
+    int m_readTimeoutMs;
+    Stats m_stats;
+};
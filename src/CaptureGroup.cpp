@@ -0,0 +1,197 @@
+#include "CaptureGroup.h"
+#include "../include/VideoCapture.h"
+#include "Logger.h"
+#include <algorithm>
+#include <limits>
+
+CaptureGroup::CaptureGroup()
+    : m_maxSkew(0.020)
+    , m_seekThreshold(2.0)
+    , m_readAhead(3)
+    , m_started(false)
+{
+}
+
+CaptureGroup::~CaptureGroup() {
+    Stop();
+}
+
+int CaptureGroup::AddMember(VideoCapture* capture, double offsetSeconds) {
+    if (!capture || m_started) {
+        LOG_ERROR("CaptureGroup::AddMember() needs a capture and a stopped group");
+        return -1;
+    }
+
+    Member member;
+    member.capture = capture;
+    member.offset = offsetSeconds;
+    m_members.push_back(std::move(member));
+    return static_cast<int>(m_members.size()) - 1;
+}
+
+bool CaptureGroup::Start() {
+    if (m_started) {
+        return true;
+    }
+    if (m_members.empty()) {
+        LOG_ERROR("CaptureGroup::Start() - no members");
+        return false;
+    }
+
+    for (size_t i = 0; i < m_members.size(); i++) {
+        if (!m_members[i].capture->startAsync(m_readAhead)) {
+            LOG_ERROR("CaptureGroup::Start() - member ", i, " failed to start decoding");
+            for (size_t j = 0; j < i; j++) {
+                m_members[j].capture->stopAsync();
+            }
+            return false;
+        }
+    }
+
+    m_started = true;
+    LOG_INFO("CaptureGroup started with ", m_members.size(), " members");
+    return true;
+}
+
+void CaptureGroup::Stop() {
+    if (!m_started) {
+        return;
+    }
+
+    for (Member& member : m_members) {
+        member.capture->stopAsync();
+        member.hasPending = false;
+        member.pending = GroupFrame();
+    }
+    m_started = false;
+}
+
+bool CaptureGroup::ReadSet(FrameSet& set, double targetTime) {
+    if (m_members.empty()) {
+        return false;
+    }
+
+    for (Member& member : m_members) {
+        if (!member.hasPending && !Fetch(member)) {
+            return false;
+        }
+    }
+
+    // Without an external clock the group advances to the earliest pending frame
+    double target = targetTime;
+    if (std::isnan(target)) {
+        target = std::numeric_limits<double>::infinity();
+        for (const Member& member : m_members) {
+            target = std::min(target, member.pending.time);
+        }
+    }
+
+    for (Member& member : m_members) {
+        if (!CatchUp(member, target)) {
+            return false;
+        }
+    }
+
+    set.time = target;
+    set.frames.clear();
+    set.frames.reserve(m_members.size());
+
+    double earliest = std::numeric_limits<double>::infinity();
+    double latest = -std::numeric_limits<double>::infinity();
+
+    for (Member& member : m_members) {
+        GroupFrame frame;
+        if (member.pending.time <= target + m_maxSkew || !member.hasLast) {
+            frame = member.pending;
+            member.last = member.pending;
+            member.hasLast = true;
+            member.hasPending = false;
+            member.pending = GroupFrame();
+            member.stats.framesDelivered++;
+        } else {
+            // Ahead of the group: keep the pending frame for a later tick
+            frame = member.last;
+            frame.repeated = true;
+            member.stats.framesRepeated++;
+        }
+
+        frame.driftMs = (frame.time - target) * 1000.0;
+        member.stats.driftMs = frame.driftMs;
+        member.stats.maxDriftMs = std::max(member.stats.maxDriftMs, std::fabs(frame.driftMs));
+
+        earliest = std::min(earliest, frame.time);
+        latest = std::max(latest, frame.time);
+        set.frames.push_back(std::move(frame));
+    }
+
+    set.skewMs = (latest - earliest) * 1000.0;
+    m_stats.setsDelivered++;
+    m_stats.lastSkewMs = set.skewMs;
+    m_stats.maxSkewMs = std::max(m_stats.maxSkewMs, set.skewMs);
+    return true;
+}
+
+bool CaptureGroup::Seek(double seconds) {
+    bool result = true;
+    for (size_t i = 0; i < m_members.size(); i++) {
+        Member& member = m_members[i];
+        double memberTime = std::max(0.0, seconds - member.offset);
+        if (!member.capture->set(CAP_PROP_POS_MSEC, memberTime * 1000.0)) {
+            LOG_WARNING("CaptureGroup::Seek() - member ", i, " failed to seek to ", memberTime, " s");
+            result = false;
+        }
+        member.hasPending = false;
+        member.pending = GroupFrame();
+        member.hasLast = false;
+        member.last = GroupFrame();
+    }
+    return result;
+}
+
+CaptureGroup::MemberStats CaptureGroup::GetMemberStats(int index) const {
+    if (index < 0 || index >= static_cast<int>(m_members.size())) {
+        return MemberStats();
+    }
+    return m_members[index].stats;
+}
+
+bool CaptureGroup::Fetch(Member& member) {
+    ID3D11Texture2D* texture = nullptr;
+    GroupFrame& frame = member.pending;
+    if (!member.capture->read(&texture, frame.isYUV, frame.format)) {
+        return false;
+    }
+
+    frame.texture.Attach(texture);      // Takes over the reference from read()
+    frame.time = member.capture->get(CAP_PROP_POS_MSEC) / 1000.0 + member.offset;
+    frame.driftMs = 0.0;
+    frame.repeated = false;
+    member.hasPending = true;
+    return true;
+}
+
+bool CaptureGroup::CatchUp(Member& member, double target) {
+    bool seeked = false;
+
+    while (member.pending.time < target - m_maxSkew) {
+        double lag = target - member.pending.time;
+
+        // Far behind: jump instead of decoding everything in between (once per catch-up,
+        // the seek lands at or before the target)
+        double memberTime = std::max(0.0, target - member.offset);
+        if (!seeked && lag > m_seekThreshold && member.capture->set(CAP_PROP_POS_MSEC, memberTime * 1000.0)) {
+            LOG_DEBUG("CaptureGroup: member ", lag * 1000.0, " ms behind, seeking to ", memberTime, " s");
+            member.stats.seeks++;
+            seeked = true;
+        } else {
+            member.stats.framesSkipped++;
+        }
+
+        member.hasPending = false;
+        member.pending = GroupFrame();
+        if (!Fetch(member)) {
+            return false;
+        }
+    }
+    return true;
+}
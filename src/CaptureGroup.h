@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <d3d11.h>
+#include <dxgiformat.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+class VideoCapture;
+
+// One member's frame in a FrameSet
+struct GroupFrame {
+    ComPtr<ID3D11Texture2D> texture;
+    bool isYUV = false;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    double time = 0.0;                  // Member time stamp mapped onto the group timeline
+    double driftMs = 0.0;               // time - FrameSet::time
+    bool repeated = false;              // Previous frame shown again (member is ahead)
+};
+
+// Frames of all members for one tick, in member order
+struct FrameSet {
+    double time = 0.0;                  // Group timeline position of this tick
+    double skewMs = 0.0;                // Largest time difference between delivered frames
+    std::vector<GroupFrame> frames;
+};
+
+/**
+ * Reads several VideoCapture instances in lockstep, e.g. the angles of a multi-camera
+ * recording, and delivers one FrameSet per tick with bounded skew.
+ *
+ * Every member decodes on its own background thread (VideoCapture::startAsync()), so members
+ * decode in parallel and read-ahead is bounded by the queue depth: a member that runs ahead
+ * stops decoding until the group catches up. Member time stamps are mapped onto the group
+ * timeline by a per-member offset. Each tick advances to the earliest pending frame (or to
+ * an external target time); members whose next frame is further ahead repeat their previous
+ * frame, members behind drop frames to catch up and seek when they are far behind.
+ *
+ * Members are owned by the caller, must be opened before Start() and must not be read
+ * directly while the group runs. Use ReadSet() from a single thread.
+ */
+class CaptureGroup {
+public:
+    struct MemberStats {
+        uint64_t framesDelivered = 0;
+        uint64_t framesRepeated = 0;
+        uint64_t framesSkipped = 0;     // Dropped to catch up with the group
+        uint64_t seeks = 0;             // Catch-up seeks after falling far behind
+        double driftMs = 0.0;           // Drift in the last delivered set
+        double maxDriftMs = 0.0;        // Largest |drift| so far
+    };
+
+    struct Stats {
+        uint64_t setsDelivered = 0;
+        double lastSkewMs = 0.0;
+        double maxSkewMs = 0.0;
+    };
+
+    CaptureGroup();
+    ~CaptureGroup();
+
+    /**
+     * Add a member before Start().
+     * @param offsetSeconds Added to the member's time stamps to place them on the group
+     *                      timeline, e.g. -1.5 for a camera that started recording 1.5 s early
+     * @return Member index, the position of its frames in FrameSet::frames
+     */
+    int AddMember(VideoCapture* capture, double offsetSeconds = 0.0);
+
+    // Time stamp difference still treated as "in sync" (default 20 ms)
+    void SetMaxSkew(double seconds) { m_maxSkew = seconds; }
+
+    // Lag after which a member seeks instead of dropping frames (default 2 s)
+    void SetSeekThreshold(double seconds) { m_seekThreshold = seconds; }
+
+    // Frames each member decodes ahead (default 3); takes effect at Start()
+    void SetReadAhead(int frames) { m_readAhead = frames; }
+
+    // Start background decoding of all members
+    bool Start();
+
+    // Stop background decoding; members return to synchronous read()
+    void Stop();
+
+    /**
+     * Read the next frame set. Blocks until every member has a frame.
+     * @param targetTime Group timeline position to deliver, e.g. from a FramePacer clock;
+     *                   NaN advances to the earliest pending frame
+     * @return false when a member reaches the end of its stream or fails
+     */
+    bool ReadSet(FrameSet& set, double targetTime = NAN);
+
+    // Seek every member to a group timeline position
+    bool Seek(double seconds);
+
+    int GetMemberCount() const { return static_cast<int>(m_members.size()); }
+    MemberStats GetMemberStats(int index) const;
+    Stats GetStats() const { return m_stats; }
+
+private:
+    struct Member {
+        VideoCapture* capture = nullptr;
+        double offset = 0.0;
+        GroupFrame pending;             // Next frame, already read from the member
+        bool hasPending = false;
+        GroupFrame last;                // Last delivered frame, repeated while ahead
+        bool hasLast = false;
+        MemberStats stats;
+    };
+
+    std::vector<Member> m_members;
+    double m_maxSkew;
+    double m_seekThreshold;
+    int m_readAhead;
+    bool m_started;
+    Stats m_stats;
+
+    bool Fetch(Member& member);
+    bool CatchUp(Member& member, double target);
+};
@@ -0,0 +1,236 @@
+#include "CaptureWatchdog.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace {
+
+const char* StageName(CaptureStage stage) {
+    switch (stage) {
+        case CaptureStage::Source: return "source";
+        case CaptureStage::Demuxer: return "demuxer";
+        case CaptureStage::Decoder: return "decoder";
+        case CaptureStage::Consumer: return "consumer";
+    }
+    return "unknown";
+}
+
+const char* ActionName(RecoveryAction action) {
+    switch (action) {
+        case RecoveryAction::None: return "none";
+        case RecoveryAction::FlushDecoder: return "flush decoder";
+        case RecoveryAction::SeekToLive: return "seek to live";
+        case RecoveryAction::Reconnect: return "reconnect";
+        case RecoveryAction::Escalate: return "escalate";
+    }
+    return "unknown";
+}
+
+double SecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+} // namespace
+
+CaptureWatchdog::CaptureWatchdog(const WatchdogOptions& options, CaptureProgress& progress,
+                                 std::function<void()> interruptIo)
+    : m_options(options)
+    , m_progress(progress)
+    , m_interruptIo(std::move(interruptIo))
+    , m_checked(false)
+    , m_decoderCalls(0)
+    , m_pendingRecovery(RecoveryAction::None)
+    , m_stallCount(0)
+    , m_stopping(false)
+{
+    m_options.checkIntervalMs = std::max(10, options.checkIntervalMs);
+}
+
+CaptureWatchdog::~CaptureWatchdog() {
+    Stop();
+}
+
+void CaptureWatchdog::Start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+
+    m_stopping = false;
+    m_thread = std::thread(&CaptureWatchdog::Run, this);
+}
+
+void CaptureWatchdog::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void CaptureWatchdog::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, std::chrono::milliseconds(m_options.checkIntervalMs), [this]() { return m_stopping; })) {
+        lock.unlock();
+        Check(std::chrono::steady_clock::now());
+        lock.lock();
+    }
+}
+
+void CaptureWatchdog::Check(std::chrono::steady_clock::time_point now) {
+    const int64_t values[STAGE_COUNT] = {
+        m_progress.bytesIn.load(),
+        m_progress.packetsDemuxed.load(),
+        m_progress.framesDecoded.load(),
+        m_progress.framesConsumed.load()
+    };
+
+    // First look: take the current counters as the baseline
+    if (!m_checked) {
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            m_stages[i].value = values[i];
+            m_stages[i].lastProgress = now;
+        }
+        m_lastCheck = now;
+        m_decoderCalls = m_progress.decoderCalls.load();
+        m_checked = true;
+        return;
+    }
+
+    bool changed[STAGE_COUNT];
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        changed[i] = values[i] != m_stages[i].value;
+        if (changed[i]) {
+            m_stages[i].value = values[i];
+            m_stages[i].lastProgress = now;
+        }
+    }
+
+    double elapsed = SecondsBetween(m_lastCheck, now);
+    m_lastCheck = now;
+
+    bool active = m_progress.decodeCalled.exchange(false) || m_progress.decoding.load();
+    bool ended = m_progress.ended.load();
+
+    // One decoder call running since the last look: the decoder holds up the pipeline, not the
+    // input (no packets are demuxed while the reading thread is inside it)
+    int64_t decoderCalls = m_progress.decoderCalls.load();
+    bool stuckInDecoder = m_progress.inDecoder.load() && decoderCalls == m_decoderCalls;
+    m_decoderCalls = decoderCalls;
+
+    const int SOURCE = static_cast<int>(CaptureStage::Source);
+    const int DEMUXER = static_cast<int>(CaptureStage::Demuxer);
+    const int DECODER = static_cast<int>(CaptureStage::Decoder);
+    const int CONSUMER = static_cast<int>(CaptureStage::Consumer);
+
+    // Packets imply input even where the source does not report bytes (RTSP/RTP)
+    bool progressed[STAGE_COUNT] = {
+        changed[SOURCE] || changed[DEMUXER],
+        changed[DEMUXER],
+        changed[DECODER],
+        changed[CONSUMER]
+    };
+    bool expected[STAGE_COUNT] = {
+        active && !progressed[SOURCE] && !stuckInDecoder,
+        active && changed[SOURCE] && !changed[DEMUXER] && !stuckInDecoder,
+        active && (changed[DEMUXER] || stuckInDecoder) && !changed[DECODER],
+        !changed[CONSUMER] && (!active || changed[DECODER])
+    };
+
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        StageState& state = m_stages[i];
+        if (progressed[i] || ended) {
+            if (state.attempts > 0 && progressed[i]) {
+                LOG_INFO("Watchdog: ", StageName(static_cast<CaptureStage>(i)), " recovered after ",
+                         state.attempts, " stall event(s)");
+            }
+            state.stalledSeconds = 0.0;
+            state.attempts = 0;
+            continue;
+        }
+
+        if (!expected[i]) {
+            continue;
+        }
+
+        state.stalledSeconds += elapsed;
+        int thresholdMs = GetThresholdMs(static_cast<CaptureStage>(i));
+        if (thresholdMs > 0 && state.stalledSeconds * 1000.0 >= thresholdMs) {
+            ReportStall(static_cast<CaptureStage>(i), now);
+        }
+    }
+}
+
+RecoveryAction CaptureWatchdog::TakeRecovery() {
+    return m_pendingRecovery.exchange(RecoveryAction::None);
+}
+
+int CaptureWatchdog::GetThresholdMs(CaptureStage stage) const {
+    switch (stage) {
+        case CaptureStage::Source: return m_options.sourceStallMs;
+        case CaptureStage::Demuxer: return m_options.demuxerStallMs;
+        case CaptureStage::Decoder: return m_options.decoderStallMs;
+        case CaptureStage::Consumer: return m_options.consumerStallMs;
+    }
+    return 0;
+}
+
+const std::vector<RecoveryAction>& CaptureWatchdog::GetRecovery(CaptureStage stage) const {
+    switch (stage) {
+        case CaptureStage::Source: return m_options.sourceRecovery;
+        case CaptureStage::Demuxer: return m_options.demuxerRecovery;
+        case CaptureStage::Decoder: return m_options.decoderRecovery;
+        default: return m_options.consumerRecovery;
+    }
+}
+
+void CaptureWatchdog::ReportStall(CaptureStage stage, std::chrono::steady_clock::time_point now) {
+    StageState& state = m_stages[static_cast<int>(stage)];
+    state.attempts++;
+
+    const std::vector<RecoveryAction>& recovery = GetRecovery(stage);
+    StallEvent event;
+    event.stage = stage;
+    event.attempt = state.attempts;
+    event.stalledSeconds = state.stalledSeconds;
+    if (!recovery.empty()) {
+        event.action = recovery[std::min(recovery.size(), static_cast<size_t>(state.attempts)) - 1];
+    }
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        event.sinceProgress[i] = SecondsBetween(m_stages[i].lastProgress, now);
+    }
+    event.bytesIn = m_stages[static_cast<int>(CaptureStage::Source)].value;
+    event.packetsDemuxed = m_stages[static_cast<int>(CaptureStage::Demuxer)].value;
+    event.framesDecoded = m_stages[static_cast<int>(CaptureStage::Decoder)].value;
+    event.framesConsumed = m_stages[static_cast<int>(CaptureStage::Consumer)].value;
+
+    // The next action only after another full threshold period
+    state.stalledSeconds = 0.0;
+    m_stallCount++;
+
+    LOG_WARNING("Watchdog: ", StageName(stage), " stalled for ", event.stalledSeconds, " s (attempt ",
+                event.attempt, ", action: ", ActionName(event.action), ") - last progress: bytes in ",
+                event.sinceProgress[0], " s, packets ", event.sinceProgress[1], " s, decoded ",
+                event.sinceProgress[2], " s, consumed ", event.sinceProgress[3], " s ago (",
+                event.bytesIn, " bytes, ", event.packetsDemuxed, " packets, ", event.framesDecoded,
+                " decoded, ", event.framesConsumed, " consumed)");
+
+    if (event.action == RecoveryAction::FlushDecoder || event.action == RecoveryAction::SeekToLive ||
+        event.action == RecoveryAction::Reconnect) {
+        m_pendingRecovery = event.action;
+
+        // The reading thread is likely blocked in I/O; unblock it so it can recover, but only
+        // for an action it can carry out, or the read fails with nothing to recover
+        bool applies = event.action == RecoveryAction::FlushDecoder ||
+                       (event.action == RecoveryAction::SeekToLive && m_progress.live) ||
+                       (event.action == RecoveryAction::Reconnect && m_progress.reconnectable);
+        if ((stage == CaptureStage::Source || stage == CaptureStage::Demuxer) && applies && m_interruptIo) {
+            m_interruptIo();
+        }
+    }
+
+    if (m_options.onStall) {
+        m_options.onStall(event);
+    }
+}
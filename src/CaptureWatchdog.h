@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "../include/VideoCapture.h"
+
+/**
+ * Progress counters a VideoCapture keeps for its watchdog. Written by the thread that reads
+ * from the capture (or its decode thread), read by the watchdog thread.
+ */
+struct CaptureProgress {
+    std::atomic<int64_t> bytesIn{0};
+    std::atomic<int64_t> packetsDemuxed{0};
+    std::atomic<int64_t> framesDecoded{0};
+    std::atomic<int64_t> framesConsumed{0};
+    std::atomic<bool> decoding{false};      // A decode call is running
+    std::atomic<bool> decodeCalled{false};  // A decode call started since the watchdog last looked
+    std::atomic<bool> inDecoder{false};     // Inside a call into the decoder (send/receive)
+    std::atomic<int64_t> decoderCalls{0};   // Calls into the decoder, to tell one stuck call from many
+    std::atomic<bool> ended{false};         // End of stream, no progress is expected
+    std::atomic<bool> live{false};          // SeekToLive applies to the source
+    std::atomic<bool> reconnectable{false}; // Reconnect applies to the source (openStream())
+};
+
+/**
+ * Detects stalls in a capture pipeline (source, demuxer, decoder, consumer) and picks the
+ * recovery action for them.
+ *
+ * A stage only accumulates stall time while it is expected to progress: the source, demuxer
+ * and decoder while someone is waiting for a frame (only the decoder while a single decoder
+ * call does not return), the consumer while frames are decoded or decoding waits for it.
+ * When a stage exceeds its threshold the next action of its recovery list is requested and
+ * the stall time starts over, so a persisting stall walks down the list.
+ * Recovery itself runs on the reading thread (TakeRecovery()); for source and demuxer stalls
+ * the blocked I/O is interrupted first so that thread gets to it, unless the action does not
+ * apply to the source (CaptureProgress::live, reconnectable) and would only fail the read.
+ */
+class CaptureWatchdog {
+public:
+    /**
+     * @param progress Counters of the watched capture, must outlive the watchdog
+     * @param interruptIo Unblocks the reading thread (VideoCapture::abort())
+     */
+    CaptureWatchdog(const WatchdogOptions& options, CaptureProgress& progress,
+                    std::function<void()> interruptIo);
+    ~CaptureWatchdog();
+
+    // Start checking every checkIntervalMs on a thread of its own
+    void Start();
+    void Stop();
+
+    // Evaluate progress once (Start() calls this periodically)
+    void Check(std::chrono::steady_clock::time_point now);
+
+    // Recovery requested by the last stall, for the reading thread to carry out; None if there is none
+    RecoveryAction TakeRecovery();
+
+    int64_t GetStallCount() const { return m_stallCount; }
+
+private:
+    static const int STAGE_COUNT = 4;
+
+    struct StageState {
+        int64_t value = 0;
+        std::chrono::steady_clock::time_point lastProgress;
+        double stalledSeconds = 0.0;
+        int attempts = 0;               // Stall events since the stage last progressed
+    };
+
+    WatchdogOptions m_options;
+    CaptureProgress& m_progress;
+    std::function<void()> m_interruptIo;
+    StageState m_stages[STAGE_COUNT];
+    std::chrono::steady_clock::time_point m_lastCheck;
+    bool m_checked;
+    int64_t m_decoderCalls;             // CaptureProgress::decoderCalls at the last check
+    std::atomic<RecoveryAction> m_pendingRecovery;
+    std::atomic<int64_t> m_stallCount;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+
+    void Run();
+    int GetThresholdMs(CaptureStage stage) const;
+    const std::vector<RecoveryAction>& GetRecovery(CaptureStage stage) const;
+    void ReportStall(CaptureStage stage, std::chrono::steady_clock::time_point now);
+};
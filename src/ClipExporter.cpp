@@ -0,0 +1,303 @@
+#include "ClipExporter.h"
+#include "Logger.h"
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/mathematics.h>
+}
+
+ClipExporter::ClipExporter()
+    : m_inputContext(nullptr)
+    , m_outputContext(nullptr)
+    , m_videoStreamIndex(-1)
+    , m_clipStartTime(0.0)
+    , m_clipDuration(0.0)
+    , m_packetsWritten(0)
+    , m_bytesWritten(0)
+{
+}
+
+ClipExporter::~ClipExporter() {
+    Close();
+}
+
+bool ClipExporter::Export(const std::string& inputPath, const std::string& outputPath,
+                          double startSeconds, double endSeconds, const std::string& outputFormat) {
+    Close();
+
+    m_clipStartTime = 0.0;
+    m_clipDuration = 0.0;
+    m_packetsWritten = 0;
+    m_bytesWritten = 0;
+
+    if (!OpenInput(inputPath)) {
+        Close();
+        return false;
+    }
+
+    if (!OpenOutput(outputPath, outputFormat)) {
+        Close();
+        return false;
+    }
+
+    if (!CopyPackets(startSeconds, endSeconds)) {
+        Close();
+        return false;
+    }
+
+    int ret = av_write_trailer(m_outputContext);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Failed to write trailer for ", outputPath, ": ", errorBuf);
+        Close();
+        return false;
+    }
+
+    LOG_INFO("Exported clip to ", outputPath);
+    LOG_INFO("  Start: ", m_clipStartTime, " seconds (keyframe)");
+    LOG_INFO("  Duration: ", m_clipDuration, " seconds");
+    LOG_INFO("  Packets: ", m_packetsWritten, " (", m_bytesWritten, " bytes)");
+
+    Close();
+    return true;
+}
+
+bool ClipExporter::OpenInput(const std::string& inputPath) {
+    int ret = avformat_open_input(&m_inputContext, inputPath.c_str(), nullptr, nullptr);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Cannot open file ", inputPath, ": ", errorBuf);
+        return false;
+    }
+
+    ret = avformat_find_stream_info(m_inputContext, nullptr);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Cannot find stream info for ", inputPath, ": ", errorBuf);
+        return false;
+    }
+
+    m_videoStreamIndex = av_find_best_stream(m_inputContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (m_videoStreamIndex < 0) {
+        LOG_ERROR("No video stream found in ", inputPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool ClipExporter::OpenOutput(const std::string& outputPath, const std::string& outputFormat) {
+    int ret = avformat_alloc_output_context2(&m_outputContext, nullptr,
+                                             outputFormat.empty() ? nullptr : outputFormat.c_str(),
+                                             outputPath.c_str());
+    if (ret < 0 || !m_outputContext) {
+        LOG_ERROR("Cannot determine output format for ", outputPath);
+        return false;
+    }
+
+    // Map video, audio and subtitle streams one-to-one; everything else is dropped
+    m_streamMapping.assign(m_inputContext->nb_streams, -1);
+    int outputIndex = 0;
+    for (unsigned int i = 0; i < m_inputContext->nb_streams; i++) {
+        AVStream* inStream = m_inputContext->streams[i];
+        AVMediaType type = inStream->codecpar->codec_type;
+        if (type != AVMEDIA_TYPE_VIDEO && type != AVMEDIA_TYPE_AUDIO && type != AVMEDIA_TYPE_SUBTITLE) {
+            continue;
+        }
+
+        AVStream* outStream = avformat_new_stream(m_outputContext, nullptr);
+        if (!outStream) {
+            LOG_ERROR("Failed to allocate output stream");
+            return false;
+        }
+
+        ret = avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+        if (ret < 0) {
+            LOG_ERROR("Failed to copy codec parameters for stream ", i);
+            return false;
+        }
+
+        // Let the muxer choose a tag valid for the target container
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        outStream->avg_frame_rate = inStream->avg_frame_rate;
+        m_streamMapping[i] = outputIndex++;
+    }
+
+    if (!(m_outputContext->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&m_outputContext->pb, outputPath.c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_ERROR("Cannot open output file ", outputPath, ": ", errorBuf);
+            return false;
+        }
+    }
+
+    // Rebased streams may start with a negative DTS when B-frames are present
+    m_outputContext->avoid_negative_ts = AVFMT_AVOID_NEG_TS_MAKE_ZERO;
+
+    ret = avformat_write_header(m_outputContext, nullptr);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Failed to write header for ", outputPath, ": ", errorBuf);
+        return false;
+    }
+
+    return true;
+}
+
+bool ClipExporter::CopyPackets(double startSeconds, double endSeconds) {
+    AVStream* videoStream = m_inputContext->streams[m_videoStreamIndex];
+    AVRational videoTimeBase = videoStream->time_base;
+
+    // Seek through the container index to the keyframe covering the start time
+    int64_t startTimestamp = static_cast<int64_t>(startSeconds / av_q2d(videoTimeBase));
+    int ret = av_seek_frame(m_inputContext, m_videoStreamIndex, startTimestamp, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Seek to clip start failed: ", errorBuf);
+        return false;
+    }
+
+    const bool hasEnd = endSeconds > startSeconds;
+    const int64_t endTimestamp = hasEnd ? static_cast<int64_t>(endSeconds / av_q2d(videoTimeBase)) : INT64_MAX;
+    const int64_t endTimeUs = hasEnd ? av_rescale_q(endTimestamp, videoTimeBase, AV_TIME_BASE_Q) : INT64_MAX;
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet) {
+        LOG_ERROR("Failed to allocate packet");
+        return false;
+    }
+
+    int64_t startOffsetUs = AV_NOPTS_VALUE;
+    double clipEnd = 0.0;
+
+    // Streams are interleaved by DTS, so audio up to the end point can still follow the last video
+    // packet: keep reading until every copied stream has passed the end (or the file ends)
+    std::vector<bool> streamEnded(m_inputContext->nb_streams, false);
+    int openStreams = 0;
+    for (unsigned int i = 0; i < m_inputContext->nb_streams; i++) {
+        if (i < m_streamMapping.size() && m_streamMapping[i] >= 0) {
+            openStreams++;
+        }
+    }
+
+    while ((ret = av_read_frame(m_inputContext, packet)) >= 0) {
+        int inIndex = packet->stream_index;
+        int outIndex = inIndex < static_cast<int>(m_streamMapping.size()) ? m_streamMapping[inIndex] : -1;
+        AVStream* inStream = m_inputContext->streams[inIndex];
+        int64_t packetTime = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+
+        if (outIndex < 0 || packetTime == AV_NOPTS_VALUE || streamEnded[inIndex]) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        if (inIndex == m_videoStreamIndex) {
+            if (startOffsetUs == AV_NOPTS_VALUE) {
+                // Everything before the first keyframe is undecodable in the clip
+                if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+                    av_packet_unref(packet);
+                    continue;
+                }
+                startOffsetUs = av_rescale_q(packetTime, inStream->time_base, AV_TIME_BASE_Q);
+                m_clipStartTime = static_cast<double>(packetTime) * av_q2d(videoTimeBase);
+            }
+
+            // Frames presented before the end are always decoded before it, so stopping on
+            // DTS keeps every reference they need
+            if (packet->dts != AV_NOPTS_VALUE && packet->dts >= endTimestamp) {
+                av_packet_unref(packet);
+                streamEnded[inIndex] = true;
+                if (--openStreams == 0) {
+                    break;
+                }
+                continue;
+            }
+
+            double packetEnd = static_cast<double>(packetTime + packet->duration) * av_q2d(videoTimeBase);
+            clipEnd = std::max(clipEnd, packetEnd);
+        } else {
+            int64_t packetTimeUs = av_rescale_q(packetTime, inStream->time_base, AV_TIME_BASE_Q);
+            if (packetTimeUs >= endTimeUs) {
+                av_packet_unref(packet);
+                streamEnded[inIndex] = true;
+                if (--openStreams == 0) {
+                    break;
+                }
+                continue;
+            }
+            if (startOffsetUs == AV_NOPTS_VALUE || packetTimeUs < startOffsetUs) {
+                av_packet_unref(packet);
+                continue;
+            }
+        }
+
+        // Rebase timestamps so the clip starts at zero
+        int64_t offset = av_rescale_q(startOffsetUs, AV_TIME_BASE_Q, inStream->time_base);
+        if (packet->pts != AV_NOPTS_VALUE) {
+            packet->pts -= offset;
+        }
+        if (packet->dts != AV_NOPTS_VALUE) {
+            packet->dts -= offset;
+        }
+        av_packet_rescale_ts(packet, inStream->time_base, m_outputContext->streams[outIndex]->time_base);
+        packet->stream_index = outIndex;
+        packet->pos = -1;
+
+        int packetSize = packet->size;
+        ret = av_interleaved_write_frame(m_outputContext, packet);
+        if (ret < 0) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_ERROR("Failed to write packet: ", errorBuf);
+            av_packet_free(&packet);
+            return false;
+        }
+
+        m_packetsWritten++;
+        m_bytesWritten += packetSize;
+    }
+
+    av_packet_free(&packet);
+
+    if (ret < 0 && ret != AVERROR_EOF) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Failed to read packet: ", errorBuf);
+        return false;
+    }
+
+    if (startOffsetUs == AV_NOPTS_VALUE) {
+        LOG_ERROR("No keyframe found at or after ", startSeconds, " seconds");
+        return false;
+    }
+
+    m_clipDuration = std::max(0.0, clipEnd - m_clipStartTime);
+    return true;
+}
+
+void ClipExporter::Close() {
+    if (m_outputContext) {
+        if (!(m_outputContext->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&m_outputContext->pb);
+        }
+        avformat_free_context(m_outputContext);
+        m_outputContext = nullptr;
+    }
+
+    if (m_inputContext) {
+        avformat_close_input(&m_inputContext);
+        m_inputContext = nullptr;
+    }
+
+    m_streamMapping.clear();
+    m_videoStreamIndex = -1;
+}
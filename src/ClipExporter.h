@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Lossless clip export by stream copy.
+ * Seeks through the container index to the keyframe covering the requested start time
+ * and copies compressed packets into a new container with timestamps rebased to zero.
+ * No decoding or encoding takes place, so throughput is bound by file I/O.
+ */
+class ClipExporter {
+public:
+    ClipExporter();
+    ~ClipExporter();
+
+    /**
+     * Export a time range of the input into a new file.
+     * @param inputPath Source file or URL
+     * @param outputPath Destination file
+     * @param startSeconds Requested clip start; the clip begins at the keyframe at or before it
+     * @param endSeconds Clip end (exclusive); values <= startSeconds export until end of input
+     * @param outputFormat Optional container short name, e.g. "mp4", "matroska" (guessed from outputPath if empty)
+     * @return true if the clip was written successfully
+     */
+    bool Export(const std::string& inputPath, const std::string& outputPath,
+                double startSeconds, double endSeconds, const std::string& outputFormat = "");
+
+    // Results of the last export
+    double GetClipStartTime() const { return m_clipStartTime; }
+    double GetClipDuration() const { return m_clipDuration; }
+    int64_t GetPacketsWritten() const { return m_packetsWritten; }
+    int64_t GetBytesWritten() const { return m_bytesWritten; }
+
+private:
+    AVFormatContext* m_inputContext;
+    AVFormatContext* m_outputContext;
+    std::vector<int> m_streamMapping;
+    int m_videoStreamIndex;
+
+    double m_clipStartTime;
+    double m_clipDuration;
+    int64_t m_packetsWritten;
+    int64_t m_bytesWritten;
+
+    bool OpenInput(const std::string& inputPath);
+    bool OpenOutput(const std::string& outputPath, const std::string& outputFormat);
+    bool CopyPackets(double startSeconds, double endSeconds);
+    void Close();
+};
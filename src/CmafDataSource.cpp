@@ -0,0 +1,343 @@
+#include "CmafDataSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavformat/avio.h>
+}
+
+namespace {
+
+const uint64_t MAX_BOX_SIZE = 256ULL * 1024 * 1024;
+const uint32_t SAMPLE_IS_NON_SYNC = 0x00010000;
+
+constexpr uint32_t FourCC(const char (&name)[5]) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(name[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[3]));
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint64_t ReadU64(const uint8_t* p) {
+    return (static_cast<uint64_t>(ReadU32(p)) << 32) | ReadU32(p + 4);
+}
+
+// Size of the box starting at data, 0 if the header is incomplete, or UINT64_MAX if invalid
+uint64_t BoxSize(const uint8_t* data, size_t available, size_t& headerSize) {
+    if (available < 8) {
+        return 0;
+    }
+    uint64_t size = ReadU32(data);
+    headerSize = 8;
+    if (size == 1) {
+        if (available < 16) {
+            return 0;
+        }
+        size = ReadU64(data + 8);
+        headerSize = 16;
+    }
+    // Size 0 ("to end of file") cannot be delimited in a live stream
+    if (size < headerSize || size > MAX_BOX_SIZE) {
+        return UINT64_MAX;
+    }
+    return size;
+}
+
+// Flags of the first sample of a traf, or -1 if the fragment does not say
+int64_t FirstSampleFlags(const uint8_t* data, size_t size) {
+    int64_t defaultFlags = -1;
+    size_t position = 0;
+    while (position + 8 <= size) {
+        size_t headerSize = 0;
+        uint64_t boxSize = BoxSize(data + position, size - position, headerSize);
+        if (boxSize == 0 || boxSize == UINT64_MAX || boxSize > size - position) {
+            break;
+        }
+        uint32_t type = ReadU32(data + position + 4);
+        const uint8_t* payload = data + position + headerSize;
+        size_t payloadSize = static_cast<size_t>(boxSize - headerSize);
+
+        if (type == FourCC("tfhd") && payloadSize >= 8) {
+            uint32_t flags = ReadU32(payload) & 0xFFFFFF;
+            size_t offset = 8;
+            if (flags & 0x01) offset += 8;  // base_data_offset
+            if (flags & 0x02) offset += 4;  // sample_description_index
+            if (flags & 0x08) offset += 4;  // default_sample_duration
+            if (flags & 0x10) offset += 4;  // default_sample_size
+            if ((flags & 0x20) && offset + 4 <= payloadSize) {
+                defaultFlags = ReadU32(payload + offset);
+            }
+        } else if (type == FourCC("trun") && payloadSize >= 8) {
+            uint32_t flags = ReadU32(payload) & 0xFFFFFF;
+            size_t offset = 8;
+            if (flags & 0x001) offset += 4; // data_offset
+            if (flags & 0x004) {
+                return offset + 4 <= payloadSize ? ReadU32(payload + offset) : -1;
+            }
+            if (flags & 0x400) {
+                if (flags & 0x100) offset += 4; // sample_duration
+                if (flags & 0x200) offset += 4; // sample_size
+                return offset + 4 <= payloadSize ? ReadU32(payload + offset) : -1;
+            }
+            return defaultFlags;
+        }
+        position += static_cast<size_t>(boxSize);
+    }
+    return defaultFlags;
+}
+
+// True unless some track fragment explicitly starts with a non-sync sample
+bool StartsWithSyncSample(const uint8_t* moof, size_t size) {
+    size_t position = 0;
+    while (position + 8 <= size) {
+        size_t headerSize = 0;
+        uint64_t boxSize = BoxSize(moof + position, size - position, headerSize);
+        if (boxSize == 0 || boxSize == UINT64_MAX || boxSize > size - position) {
+            break;
+        }
+        if (ReadU32(moof + position + 4) == FourCC("traf")) {
+            int64_t flags = FirstSampleFlags(moof + position + headerSize, static_cast<size_t>(boxSize - headerSize));
+            if (flags >= 0 && (flags & SAMPLE_IS_NON_SYNC)) {
+                return false;
+            }
+        }
+        position += static_cast<size_t>(boxSize);
+    }
+    return true;
+}
+
+} // namespace
+
+CmafDataSource::CmafDataSource()
+    : m_boxStart(0)
+    , m_initComplete(false)
+    , m_buildingHasMoof(false)
+    , m_buildingIsSync(false)
+    , m_waitingForSync(true)
+    , m_eof(false)
+    , m_position(0)
+    , m_readTimeoutMs(5000)
+{
+}
+
+CmafDataSource::~CmafDataSource() {
+    SetEOF(true);
+}
+
+int CmafDataSource::Read(uint8_t* buffer, int size) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    bool ready = m_dataAvailable.wait_for(lock, std::chrono::milliseconds(m_readTimeoutMs), [this]() {
+        return !m_segments.empty() || m_eof;
+    });
+
+    if (m_segments.empty()) {
+        if (m_eof) {
+            LOG_DEBUG("CmafDataSource::Read - EOF reached");
+            return AVERROR_EOF;
+        }
+        if (!ready) {
+            LOG_WARNING("CmafDataSource::Read - no complete fragment within ", m_readTimeoutMs, " ms");
+        }
+        return AVERROR(EAGAIN);
+    }
+
+    Segment& segment = m_segments.front();
+    if (!segment.started) {
+        segment.started = true;
+        double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - segment.completedAt).count();
+        m_stats.lastQueueLatencyMs = latencyMs;
+        m_stats.maxQueueLatencyMs = std::max(m_stats.maxQueueLatencyMs, latencyMs);
+    }
+
+    size_t toRead = std::min(static_cast<size_t>(size), segment.data.size() - segment.readOffset);
+    memcpy(buffer, segment.data.data() + segment.readOffset, toRead);
+    segment.readOffset += toRead;
+    m_position += static_cast<int64_t>(toRead);
+    m_stats.bytesBuffered -= toRead;
+
+    // Release fully consumed fragments right away
+    if (segment.readOffset == segment.data.size()) {
+        m_segments.pop_front();
+        m_stats.fragmentsReleased++;
+    }
+
+    return static_cast<int>(toRead);
+}
+
+int64_t CmafDataSource::Seek(int64_t offset, int whence) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Live stream: only position queries are answered
+    if (whence == SEEK_CUR && offset == 0) {
+        return m_position;
+    }
+    if (whence == AVSEEK_SIZE) {
+        return -1;
+    }
+    return AVERROR(ENOSYS);
+}
+
+int64_t CmafDataSource::GetSize() const {
+    return -1;
+}
+
+bool CmafDataSource::IsSeekable() const {
+    return false;
+}
+
+bool CmafDataSource::HasCompleteHeaders() const {
+    return true;
+}
+
+void CmafDataSource::AppendData(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_building.insert(m_building.end(), data, data + size);
+    ProcessBoxes();
+    m_stats.bytesPending = m_building.size();
+}
+
+void CmafDataSource::SetEOF(bool eof) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_eof = eof;
+    }
+    m_dataAvailable.notify_all();
+    LOG_DEBUG("CmafDataSource::SetEOF - EOF set to ", eof);
+}
+
+void CmafDataSource::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_segments.clear();
+    m_building.clear();
+    m_boxStart = 0;
+    m_initMoov.clear();
+    m_initComplete = false;
+    m_buildingHasMoof = false;
+    m_buildingIsSync = false;
+    m_waitingForSync = true;
+    m_eof = false;
+    m_position = 0;
+    m_stats = Stats();
+}
+
+void CmafDataSource::SetReadTimeout(int milliseconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readTimeoutMs = std::max(0, milliseconds);
+}
+
+bool CmafDataSource::IsInitSegmentComplete() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_initComplete;
+}
+
+size_t CmafDataSource::GetFragmentsQueued() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_segments.size();
+}
+
+CmafDataSource::Stats CmafDataSource::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void CmafDataSource::ProcessBoxes() {
+    while (true) {
+        size_t headerSize = 0;
+        uint64_t boxSize = BoxSize(m_building.data() + m_boxStart, m_building.size() - m_boxStart, headerSize);
+        if (boxSize == 0) {
+            return; // Header incomplete
+        }
+        if (boxSize == UINT64_MAX) {
+            LOG_ERROR("CmafDataSource - invalid box at ingest offset ", m_boxStart, ", resynchronizing");
+            DiscardBuilding(m_building.size());
+            return;
+        }
+        if (boxSize > m_building.size() - m_boxStart) {
+            return; // Payload incomplete
+        }
+
+        uint32_t type = ReadU32(m_building.data() + m_boxStart + 4);
+        size_t boxEnd = m_boxStart + static_cast<size_t>(boxSize);
+
+        if (type == FourCC("moov") && IsRepeatedInit(m_boxStart, boxEnd)) {
+            // Packagers repeat the init segment for late joiners; the demuxer already has it
+            m_stats.initSegmentsRepeated++;
+            LOG_DEBUG("CmafDataSource - dropping repeated init segment");
+            DiscardBuilding(boxEnd);
+        } else if (type == FourCC("moov")) {
+            // ftyp and anything else before moov belong to the init segment
+            if (m_initComplete) {
+                LOG_INFO("CmafDataSource - init segment changed, new track configuration follows");
+            }
+            m_initMoov.assign(m_building.begin() + m_boxStart, m_building.begin() + boxEnd);
+            CompleteSegment(boxEnd, true);
+        } else if (!m_initComplete && (type == FourCC("moof") || type == FourCC("mdat"))) {
+            // Joined mid-stream: media before the init segment cannot be decoded
+            DiscardBuilding(boxEnd);
+        } else if (type == FourCC("moof")) {
+            m_buildingHasMoof = true;
+            m_buildingIsSync = StartsWithSyncSample(m_building.data() + m_boxStart + headerSize,
+                                                    static_cast<size_t>(boxSize) - headerSize);
+            m_boxStart = boxEnd;
+        } else if (type == FourCC("mdat") && m_buildingHasMoof) {
+            CompleteSegment(boxEnd, false);
+        } else {
+            // styp, sidx, prft, emsg, ... travel with the next fragment
+            m_boxStart = boxEnd;
+        }
+    }
+}
+
+bool CmafDataSource::IsRepeatedInit(size_t moovStart, size_t moovEnd) const {
+    return m_initComplete && m_initMoov.size() == moovEnd - moovStart &&
+           std::equal(m_initMoov.begin(), m_initMoov.end(), m_building.begin() + moovStart);
+}
+
+void CmafDataSource::CompleteSegment(size_t end, bool isInit) {
+    if (isInit) {
+        m_initComplete = true;
+        m_waitingForSync = true;
+        m_stats.initSegmentBytes = end;
+        LOG_INFO("CmafDataSource - init segment complete (", end, " bytes)");
+    } else {
+        m_stats.fragmentsReceived++;
+        if (m_waitingForSync && !m_buildingIsSync) {
+            m_stats.fragmentsSkipped++;
+            LOG_DEBUG("CmafDataSource - skipping fragment without sync sample (", end, " bytes)");
+            DiscardBuilding(end);
+            return;
+        }
+        m_waitingForSync = false;
+    }
+
+    Segment segment;
+    if (end == m_building.size()) {
+        // Common case: the chunk ended on the box boundary, hand the buffer over without copying
+        segment.data.swap(m_building);
+        DiscardBuilding(0);
+    } else {
+        segment.data.assign(m_building.begin(), m_building.begin() + end);
+        DiscardBuilding(end);
+    }
+    segment.completedAt = Clock::now();
+    m_stats.bytesBuffered += segment.data.size();
+    m_segments.push_back(std::move(segment));
+
+    m_dataAvailable.notify_one();
+}
+
+void CmafDataSource::DiscardBuilding(size_t end) {
+    m_building.erase(m_building.begin(), m_building.begin() + end);
+    m_boxStart = 0;
+    m_buildingHasMoof = false;
+    m_buildingIsSync = false;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "IDataSource.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * Live CMAF / fragmented MP4 ingest source.
+ * Accepts arbitrarily chunked bytes (init segment followed by moof/mdat fragments) and
+ * splits them on top-level box boundaries. The reader only ever sees the init segment and
+ * complete fragments, starting at the first fragment that begins with a sync sample, and
+ * each fragment is released as soon as it has been read. Read() blocks until a complete
+ * fragment is available, the read timeout expires or the stream is ended.
+ *
+ * Open with format "mp4"; the demuxer skips stream analysis because the init segment
+ * already describes the tracks.
+ */
+class CmafDataSource : public IDataSource {
+public:
+    struct Stats {
+        size_t initSegmentBytes = 0;
+        uint64_t initSegmentsRepeated = 0;  // Identical moov repeated in the stream, dropped
+        uint64_t fragmentsReceived = 0;     // Complete moof+mdat fragments
+        uint64_t fragmentsSkipped = 0;      // Dropped before the first sync fragment
+        uint64_t fragmentsReleased = 0;     // Fully read and freed
+        size_t bytesBuffered = 0;           // Complete fragments not yet read
+        size_t bytesPending = 0;            // Incomplete box data
+        double lastQueueLatencyMs = 0.0;    // Fragment complete -> first byte read
+        double maxQueueLatencyMs = 0.0;
+    };
+
+    CmafDataSource();
+    ~CmafDataSource() override;
+
+    // IDataSource interface
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    int64_t GetSize() const override;
+    bool IsSeekable() const override;
+    bool HasCompleteHeaders() const override;
+
+    // Ingest
+    void AppendData(const uint8_t* data, size_t size);
+    void SetEOF(bool eof);
+    void Clear();
+
+    // Maximum time Read() waits for the next fragment (default: 5000 ms)
+    void SetReadTimeout(int milliseconds);
+
+    // Status
+    bool IsInitSegmentComplete() const;
+    size_t GetFragmentsQueued() const;
+    Stats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Segment {
+        std::vector<uint8_t> data;
+        size_t readOffset = 0;
+        Clock::time_point completedAt;
+        bool started = false;
+    };
+
+    std::deque<Segment> m_segments;     // Init segment and complete fragments, in order
+    std::vector<uint8_t> m_building;    // Bytes of the init segment or fragment being assembled
+    size_t m_boxStart;                  // Offset of the first incomplete box in m_building
+    std::vector<uint8_t> m_initMoov;    // moov box of the current init segment
+    bool m_initComplete;
+    bool m_buildingHasMoof;
+    bool m_buildingIsSync;
+    bool m_waitingForSync;
+    bool m_eof;
+    int64_t m_position;
+    int m_readTimeoutMs;
+    Stats m_stats;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_dataAvailable;
+
+    void ProcessBoxes();
+    bool IsRepeatedInit(size_t moovStart, size_t moovEnd) const;
+    void CompleteSegment(size_t end, bool isInit);
+    void DiscardBuilding(size_t end);
+};
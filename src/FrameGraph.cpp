@@ -0,0 +1,547 @@
+#include "FrameGraph.h"
+#include "FramePublisher.h"
+#include "HardwareDecoder.h"
+#include "../include/VideoCapture.h"
+#include "Logger.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+
+struct FrameGraph::Node {
+    int id = 0;
+    std::string name;
+    std::shared_ptr<FrameStage> stage;  // nullptr for the graph input
+    std::vector<Edge*> inputs;
+    std::vector<Edge*> outputs;
+    std::mutex processMutex;            // Serializes Process() across input edges
+    mutable std::mutex statsMutex;
+    StageStats stats;
+};
+
+struct FrameGraph::Edge {
+    Node* from = nullptr;
+    Node* to = nullptr;
+    EdgeOptions options;
+    std::deque<GraphFramePtr> queue;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread thread;
+};
+
+FrameGraph::FrameGraph()
+    : m_running(false)
+    , m_nextIndex(0)
+{
+    auto input = std::make_unique<Node>();
+    input->id = INPUT;
+    input->name = "input";
+    m_nodes.push_back(std::move(input));
+}
+
+FrameGraph::~FrameGraph() {
+    Stop();
+}
+
+int FrameGraph::AddStage(const std::string& name, std::shared_ptr<FrameStage> stage) {
+    if (!stage || m_running) {
+        LOG_ERROR("FrameGraph::AddStage() needs a stage and a stopped graph");
+        return -1;
+    }
+
+    auto node = std::make_unique<Node>();
+    node->id = static_cast<int>(m_nodes.size());
+    node->name = name;
+    node->stage = std::move(stage);
+    m_nodes.push_back(std::move(node));
+    return m_nodes.back()->id;
+}
+
+int FrameGraph::AddSink(const std::string& name, std::function<void(const GraphFramePtr&)> callback) {
+    return AddStage(name, std::make_shared<CallbackStage>(std::move(callback)));
+}
+
+bool FrameGraph::Connect(int from, int to, const EdgeOptions& options) {
+    int count = static_cast<int>(m_nodes.size());
+    if (m_running || from < 0 || from >= count || to <= INPUT || to >= count || from == to) {
+        LOG_ERROR("FrameGraph::Connect() - invalid edge ", from, " -> ", to);
+        return false;
+    }
+    if (Reaches(to, from)) {
+        LOG_ERROR("FrameGraph::Connect() - edge ", m_nodes[from]->name, " -> ", m_nodes[to]->name, " would create a cycle");
+        return false;
+    }
+
+    auto edge = std::make_unique<Edge>();
+    edge->from = m_nodes[from].get();
+    edge->to = m_nodes[to].get();
+    edge->options = options;
+    edge->options.queueSize = std::max(1, options.queueSize);
+    edge->from->outputs.push_back(edge.get());
+    edge->to->inputs.push_back(edge.get());
+    m_edges.push_back(std::move(edge));
+    return true;
+}
+
+bool FrameGraph::Start() {
+    if (m_running) {
+        return true;
+    }
+
+    for (auto& edge : m_edges) {
+        edge->queue.clear();
+        edge->closed = false;
+        if (edge->options.threading == EdgeThreading::Queued) {
+            edge->thread = std::thread(&FrameGraph::RunEdge, this, std::ref(*edge));
+        }
+    }
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_running = true;
+    LOG_INFO("FrameGraph started with ", m_nodes.size() - 1, " stages and ", m_edges.size(), " edges");
+    return true;
+}
+
+void FrameGraph::Stop() {
+    if (!m_running) {
+        return;
+    }
+
+    // Upstream first: once a node's inputs have drained it can finish and flush downstream
+    for (int id : TopologicalOrder()) {
+        Node& node = *m_nodes[id];
+        for (Edge* edge : node.inputs) {
+            {
+                std::lock_guard<std::mutex> lock(edge->mutex);
+                edge->closed = true;
+            }
+            edge->changed.notify_all();
+            if (edge->thread.joinable()) {
+                edge->thread.join();
+            }
+        }
+
+        if (node.stage) {
+            std::lock_guard<std::mutex> lock(node.processMutex);
+            node.stage->Finish([this, &node](const GraphFramePtr& out) {
+                if (out) {
+                    Emit(node, out);
+                }
+            });
+        }
+    }
+
+    m_running = false;
+    LOG_DEBUG("FrameGraph stopped");
+}
+
+bool FrameGraph::Push(const GraphFramePtr& frame) {
+    if (!m_running || !frame) {
+        LOG_ERROR("FrameGraph::Push() - graph not running or no frame");
+        return false;
+    }
+
+    Node& input = *m_nodes[INPUT];
+    {
+        std::lock_guard<std::mutex> lock(input.statsMutex);
+        input.stats.framesIn++;
+    }
+    Emit(input, frame);
+    return true;
+}
+
+bool FrameGraph::Push(ID3D11Texture2D* texture, bool isYUV, DXGI_FORMAT format, int width, int height,
+                      double presentationTime) {
+    auto frame = std::make_shared<GraphFrame>();
+    frame->texture = texture;
+    frame->isYUV = isYUV;
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    frame->presentationTime = presentationTime;
+    frame->index = m_nextIndex++;
+    return Push(GraphFramePtr(std::move(frame)));
+}
+
+uint64_t FrameGraph::Run(VideoCapture& capture, const std::atomic<bool>* cancel) {
+    if (!Start()) {
+        return 0;
+    }
+
+    int width = static_cast<int>(capture.get(CAP_PROP_FRAME_WIDTH));
+    int height = static_cast<int>(capture.get(CAP_PROP_FRAME_HEIGHT));
+    uint64_t pushed = 0;
+
+    while (!cancel || !cancel->load()) {
+        ID3D11Texture2D* texture = nullptr;
+        bool isYUV = false;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        if (!capture.read(&texture, isYUV, format)) {
+            break;
+        }
+
+        bool ok = Push(texture, isYUV, format, width, height, capture.get(CAP_PROP_POS_MSEC) / 1000.0);
+        if (texture) {
+            texture->Release();
+        }
+        if (!ok) {
+            break;
+        }
+        pushed++;
+    }
+
+    Stop();
+    return pushed;
+}
+
+std::string FrameGraph::GetNodeName(int node) const {
+    if (node < 0 || node >= static_cast<int>(m_nodes.size())) {
+        return std::string();
+    }
+    return m_nodes[node]->name;
+}
+
+FrameGraph::StageStats FrameGraph::GetStageStats(int node) const {
+    if (node < 0 || node >= static_cast<int>(m_nodes.size())) {
+        return StageStats();
+    }
+
+    StageStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_nodes[node]->statsMutex);
+        stats = m_nodes[node]->stats;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    if (elapsed > 0.0) {
+        stats.framesPerSecond = static_cast<double>(stats.framesIn) / elapsed;
+    }
+    return stats;
+}
+
+bool FrameGraph::Reaches(int from, int to) const {
+    std::vector<int> pending = { from };
+    std::vector<bool> visited(m_nodes.size(), false);
+    while (!pending.empty()) {
+        int id = pending.back();
+        pending.pop_back();
+        if (id == to) {
+            return true;
+        }
+        if (visited[id]) {
+            continue;
+        }
+        visited[id] = true;
+        for (const Edge* edge : m_nodes[id]->outputs) {
+            pending.push_back(edge->to->id);
+        }
+    }
+    return false;
+}
+
+std::vector<int> FrameGraph::TopologicalOrder() const {
+    std::vector<int> inputsLeft(m_nodes.size());
+    std::vector<int> ready;
+    for (const auto& node : m_nodes) {
+        inputsLeft[node->id] = static_cast<int>(node->inputs.size());
+        if (node->inputs.empty()) {
+            ready.push_back(node->id);
+        }
+    }
+
+    std::vector<int> order;
+    while (!ready.empty()) {
+        int id = ready.back();
+        ready.pop_back();
+        order.push_back(id);
+        for (const Edge* edge : m_nodes[id]->outputs) {
+            if (--inputsLeft[edge->to->id] == 0) {
+                ready.push_back(edge->to->id);
+            }
+        }
+    }
+    return order;
+}
+
+void FrameGraph::Emit(Node& node, const GraphFramePtr& frame) {
+    {
+        std::lock_guard<std::mutex> lock(node.statsMutex);
+        node.stats.framesOut++;
+    }
+
+    for (Edge* edge : node.outputs) {
+        if (edge->options.threading == EdgeThreading::Inline) {
+            Deliver(*edge->to, frame);
+        } else {
+            Enqueue(*edge, frame);
+        }
+    }
+}
+
+void FrameGraph::Deliver(Node& node, const GraphFramePtr& frame) {
+    std::lock_guard<std::mutex> lock(node.processMutex);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = node.stage->Process(frame, [this, &node](const GraphFramePtr& out) {
+        if (out) {
+            Emit(node, out);
+        }
+    });
+    double busyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> statsLock(node.statsMutex);
+    node.stats.framesIn++;
+    node.stats.busyMs += busyMs;
+    if (!ok) {
+        node.stats.framesFailed++;
+    }
+}
+
+void FrameGraph::Enqueue(Edge& edge, const GraphFramePtr& frame) {
+    Node& target = *edge.to;
+    size_t capacity = static_cast<size_t>(edge.options.queueSize);
+    double blockedMs = 0.0;
+    bool dropped = false;
+
+    {
+        std::unique_lock<std::mutex> lock(edge.mutex);
+        if (edge.queue.size() >= capacity && !edge.closed) {
+            switch (edge.options.policy) {
+            case QueuePolicy::Block: {
+                auto start = std::chrono::steady_clock::now();
+                edge.changed.wait(lock, [&edge, capacity]() {
+                    return edge.closed || edge.queue.size() < capacity;
+                });
+                blockedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                break;
+            }
+            case QueuePolicy::DropOldest:
+                edge.queue.pop_front();
+                dropped = true;
+                break;
+            case QueuePolicy::DropNewest:
+                dropped = true;
+                break;
+            }
+        }
+
+        bool queued = false;
+        if (!edge.closed && edge.queue.size() < capacity) {
+            edge.queue.push_back(frame);
+            queued = true;
+        }
+
+        std::lock_guard<std::mutex> statsLock(target.statsMutex);
+        target.stats.blockedMs += blockedMs;
+        if (dropped) {
+            target.stats.framesDropped++;
+        }
+        // DropOldest swaps one queued frame for another
+        if (queued && !dropped) {
+            target.stats.queuedFrames++;
+            target.stats.maxQueuedFrames = std::max(target.stats.maxQueuedFrames, target.stats.queuedFrames);
+        }
+    }
+    edge.changed.notify_all();
+}
+
+void FrameGraph::RunEdge(Edge& edge) {
+    while (true) {
+        GraphFramePtr frame;
+        {
+            std::unique_lock<std::mutex> lock(edge.mutex);
+            edge.changed.wait(lock, [&edge]() {
+                return edge.closed || !edge.queue.empty();
+            });
+            // Closed edges still drain what is queued
+            if (edge.queue.empty()) {
+                return;
+            }
+            frame = std::move(edge.queue.front());
+            edge.queue.pop_front();
+
+            std::lock_guard<std::mutex> statsLock(edge.to->statsMutex);
+            edge.to->stats.queuedFrames--;
+        }
+        edge.changed.notify_all();
+
+        Deliver(*edge.to, frame);
+    }
+}
+
+bool CallbackStage::Process(const GraphFramePtr& frame, const FrameEmitter& emit) {
+    (void)emit;
+    m_callback(frame);
+    return true;
+}
+
+ConvertStage::ConvertStage(int width, int height, DXGI_FORMAT format)
+    : m_width(width)
+    , m_height(height)
+    , m_format(format)
+    , m_inputWidth(0)
+    , m_inputHeight(0)
+{
+}
+
+bool ConvertStage::Process(const GraphFramePtr& frame, const FrameEmitter& emit) {
+    if (!frame->texture) {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC inputDesc;
+    frame->texture->GetDesc(&inputDesc);
+    int inputWidth = frame->width > 0 ? frame->width : static_cast<int>(inputDesc.Width);
+    int inputHeight = frame->height > 0 ? frame->height : static_cast<int>(inputDesc.Height);
+
+    if (!m_processor || inputWidth != m_inputWidth || inputHeight != m_inputHeight) {
+        if (!CreateProcessor(frame->texture.Get(), inputWidth, inputHeight)) {
+            return false;
+        }
+    }
+
+    int outputWidth = m_width > 0 ? m_width : inputWidth;
+    int outputHeight = m_height > 0 ? m_height : inputHeight;
+
+    D3D11_VIDEO_PROCESSOR_INPUT_VIEW_DESC inputViewDesc = {};
+    inputViewDesc.ViewDimension = D3D11_VPIV_DIMENSION_TEXTURE2D;
+    ComPtr<ID3D11VideoProcessorInputView> inputView;
+    HRESULT hr = m_videoDevice->CreateVideoProcessorInputView(frame->texture.Get(), m_enumerator.Get(), &inputViewDesc, &inputView);
+    if (FAILED(hr)) {
+        LOG_ERROR("ConvertStage - failed to create input view. HRESULT: 0x", std::hex, hr);
+        return false;
+    }
+
+    // A new texture per frame: downstream stages may still hold earlier ones
+    D3D11_TEXTURE2D_DESC outputDesc = {};
+    outputDesc.Width = static_cast<UINT>(outputWidth);
+    outputDesc.Height = static_cast<UINT>(outputHeight);
+    outputDesc.MipLevels = 1;
+    outputDesc.ArraySize = 1;
+    outputDesc.Format = m_format;
+    outputDesc.SampleDesc.Count = 1;
+    outputDesc.Usage = D3D11_USAGE_DEFAULT;
+    outputDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+
+    ComPtr<ID3D11Texture2D> output;
+    hr = m_device->CreateTexture2D(&outputDesc, nullptr, &output);
+    if (FAILED(hr)) {
+        LOG_ERROR("ConvertStage - failed to create output texture. HRESULT: 0x", std::hex, hr);
+        return false;
+    }
+
+    D3D11_VIDEO_PROCESSOR_OUTPUT_VIEW_DESC outputViewDesc = {};
+    outputViewDesc.ViewDimension = D3D11_VPOV_DIMENSION_TEXTURE2D;
+    ComPtr<ID3D11VideoProcessorOutputView> outputView;
+    hr = m_videoDevice->CreateVideoProcessorOutputView(output.Get(), m_enumerator.Get(), &outputViewDesc, &outputView);
+    if (FAILED(hr)) {
+        LOG_ERROR("ConvertStage - failed to create output view. HRESULT: 0x", std::hex, hr);
+        return false;
+    }
+
+    // Only the visible area; decoder textures are padded
+    RECT source = { 0, 0, inputWidth, inputHeight };
+    m_videoContext->VideoProcessorSetStreamSourceRect(m_processor.Get(), 0, TRUE, &source);
+    m_videoContext->VideoProcessorSetStreamFrameFormat(m_processor.Get(), 0, D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE);
+
+    D3D11_VIDEO_PROCESSOR_STREAM stream = {};
+    stream.Enable = TRUE;
+    stream.pInputSurface = inputView.Get();
+    hr = m_videoContext->VideoProcessorBlt(m_processor.Get(), outputView.Get(), 0, 1, &stream);
+    if (FAILED(hr)) {
+        LOG_ERROR("ConvertStage - VideoProcessorBlt failed. HRESULT: 0x", std::hex, hr);
+        return false;
+    }
+
+    auto converted = std::make_shared<GraphFrame>();
+    converted->texture = output;
+    converted->isYUV = m_format == DXGI_FORMAT_NV12 || m_format == DXGI_FORMAT_P010;
+    converted->format = m_format;
+    converted->width = outputWidth;
+    converted->height = outputHeight;
+    converted->presentationTime = frame->presentationTime;
+    converted->index = frame->index;
+    emit(converted);
+    return true;
+}
+
+bool ConvertStage::CreateProcessor(ID3D11Texture2D* texture, int inputWidth, int inputHeight) {
+    m_processor.Reset();
+    m_enumerator.Reset();
+
+    if (!m_videoDevice) {
+        texture->GetDevice(&m_device);
+
+        // Runs on an edge thread while decoding and rendering use the same immediate context
+        if (!HardwareDecoder::EnableMultithreadProtection(m_device.Get())) {
+            return false;
+        }
+
+        ComPtr<ID3D11DeviceContext> context;
+        m_device->GetImmediateContext(&context);
+        HRESULT hr = m_device->QueryInterface(__uuidof(ID3D11VideoDevice), &m_videoDevice);
+        if (SUCCEEDED(hr)) {
+            hr = context->QueryInterface(__uuidof(ID3D11VideoContext), &m_videoContext);
+        }
+        if (FAILED(hr)) {
+            LOG_ERROR("ConvertStage - device has no video processing support");
+            return false;
+        }
+    }
+
+    D3D11_VIDEO_PROCESSOR_CONTENT_DESC contentDesc = {};
+    contentDesc.InputFrameFormat = D3D11_VIDEO_FRAME_FORMAT_PROGRESSIVE;
+    contentDesc.InputFrameRate = { 1, 1 };
+    contentDesc.InputWidth = static_cast<UINT>(inputWidth);
+    contentDesc.InputHeight = static_cast<UINT>(inputHeight);
+    contentDesc.OutputFrameRate = { 1, 1 };
+    contentDesc.OutputWidth = static_cast<UINT>(m_width > 0 ? m_width : inputWidth);
+    contentDesc.OutputHeight = static_cast<UINT>(m_height > 0 ? m_height : inputHeight);
+    contentDesc.Usage = D3D11_VIDEO_USAGE_PLAYBACK_NORMAL;
+
+    HRESULT hr = m_videoDevice->CreateVideoProcessorEnumerator(&contentDesc, &m_enumerator);
+    if (SUCCEEDED(hr)) {
+        hr = m_videoDevice->CreateVideoProcessor(m_enumerator.Get(), 0, &m_processor);
+    }
+    if (FAILED(hr)) {
+        LOG_ERROR("ConvertStage - failed to create video processor for ", inputWidth, "x", inputHeight,
+                  ". HRESULT: 0x", std::hex, hr);
+        m_enumerator.Reset();
+        return false;
+    }
+
+    m_inputWidth = inputWidth;
+    m_inputHeight = inputHeight;
+    LOG_DEBUG("ConvertStage - video processor ", inputWidth, "x", inputHeight, " -> ",
+              contentDesc.OutputWidth, "x", contentDesc.OutputHeight, " format ", m_format);
+    return true;
+}
+
+PublishStage::PublishStage(const std::string& name, int slotCount)
+    : m_name(name)
+    , m_slotCount(slotCount)
+    , m_publisher(std::make_unique<FramePublisher>())
+{
+}
+
+PublishStage::~PublishStage() = default;
+
+bool PublishStage::Process(const GraphFramePtr& frame, const FrameEmitter& emit) {
+    (void)emit;
+    if (!m_publisher->IsOpen()) {
+        // Copies and maps on the immediate context from an edge thread, see ConvertStage
+        ComPtr<ID3D11Device> device;
+        frame->texture->GetDevice(&device);
+        if (!HardwareDecoder::EnableMultithreadProtection(device.Get()) ||
+            !m_publisher->Create(m_name, frame->width, frame->height, frame->format, m_slotCount)) {
+            return false;
+        }
+    }
+    return m_publisher->PublishTexture(frame->texture.Get(), frame->presentationTime);
+}
+
+void PublishStage::Finish(const FrameEmitter& emit) {
+    (void)emit;
+    m_publisher->Close();
+}
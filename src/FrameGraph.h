@@ -0,0 +1,215 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <d3d11.h>
+#include <dxgiformat.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+class VideoCapture;
+class FramePublisher;
+
+/**
+ * A decoded frame shared between stages. Frames are immutable once emitted and reference
+ * counted through GraphFramePtr, so any number of stages can hold one without copying.
+ */
+struct GraphFrame {
+    ComPtr<ID3D11Texture2D> texture;
+    bool isYUV = false;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    int width = 0;                      // Visible size (the texture may be padded)
+    int height = 0;
+    double presentationTime = 0.0;
+    uint64_t index = 0;                 // Position in the source stream, 0-based
+};
+
+using GraphFramePtr = std::shared_ptr<const GraphFrame>;
+using FrameEmitter = std::function<void(const GraphFramePtr&)>;
+
+/**
+ * A processing step in a FrameGraph. Process() receives every frame that reaches the stage
+ * and passes results on by calling emit (any number of times, including not at all for
+ * sinks). Calls to one stage are serialized even when it has several inputs.
+ */
+class FrameStage {
+public:
+    virtual ~FrameStage() = default;
+
+    // Return false if the frame could not be processed (counted as a failure)
+    virtual bool Process(const GraphFramePtr& frame, const FrameEmitter& emit) = 0;
+
+    // Called once after the last frame, when all inputs of the stage have drained
+    virtual void Finish(const FrameEmitter& emit) { (void)emit; }
+};
+
+// What a full edge queue does with a new frame
+enum class QueuePolicy {
+    Block,          // Producer waits (backpressure up to the source)
+    DropOldest,     // Oldest queued frame is discarded
+    DropNewest      // New frame is discarded
+};
+
+// Where the downstream stage of an edge runs
+enum class EdgeThreading {
+    Queued,         // On a worker thread of its own, fed through the edge queue
+    Inline          // Synchronously on the producer's thread, no queue
+};
+
+struct EdgeOptions {
+    int queueSize = 4;
+    QueuePolicy policy = QueuePolicy::Block;
+    EdgeThreading threading = EdgeThreading::Queued;
+};
+
+/**
+ * Push-mode frame processing: frames pushed into the graph input flow along edges through
+ * stages, e.g. decode -> convert -> { publish, record }. Each edge has its own bounded queue,
+ * full-queue policy and thread, so a slow branch only slows the branches that chose to wait
+ * for it.
+ *
+ * Build the graph (AddStage/AddSink/Connect), Start() it, then Push() frames or Run() a
+ * capture. Stop() drains the queues in graph order and calls Finish() on every stage.
+ *
+ * Stages behind Queued edges run on their own threads. A stage that uses the D3D11 immediate
+ * context shares it with the decoder and the renderer, so the device needs multithread
+ * protection (HardwareDecoder::EnableMultithreadProtection()); ConvertStage and PublishStage
+ * turn it on themselves. Custom GPU stages must do the same or be connected Inline.
+ */
+class FrameGraph {
+public:
+    static const int INPUT = 0;         // Node id of the graph input
+
+    struct StageStats {
+        uint64_t framesIn = 0;
+        uint64_t framesOut = 0;
+        uint64_t framesDropped = 0;     // Dropped by full input queues (DropOldest/DropNewest)
+        uint64_t framesFailed = 0;      // Process() returned false
+        double framesPerSecond = 0.0;   // Input throughput since Start()
+        double busyMs = 0.0;            // Total time spent in Process()
+        double blockedMs = 0.0;         // Time producers waited on full input queues
+        int queuedFrames = 0;           // Currently waiting in input queues
+        int maxQueuedFrames = 0;
+    };
+
+    FrameGraph();
+    ~FrameGraph();
+
+    // Add a stage; returns its node id. The graph keeps the stage alive.
+    int AddStage(const std::string& name, std::shared_ptr<FrameStage> stage);
+
+    // Add a sink that calls back for every frame
+    int AddSink(const std::string& name, std::function<void(const GraphFramePtr&)> callback);
+
+    // Route frames from one node to another; fails for unknown nodes or if it creates a cycle
+    bool Connect(int from, int to, const EdgeOptions& options = EdgeOptions());
+
+    bool Start();
+
+    /**
+     * Stop the graph. Frames already queued are processed first (drain), then every stage's
+     * Finish() runs, upstream before downstream.
+     */
+    void Stop();
+
+    // Feed a frame into the graph input; blocks while a Block edge from the input is full
+    bool Push(const GraphFramePtr& frame);
+
+    // Feed a decoded texture (the graph takes its own reference)
+    bool Push(ID3D11Texture2D* texture, bool isYUV, DXGI_FORMAT format, int width, int height,
+              double presentationTime);
+
+    /**
+     * Read a capture to the end and push every frame, then Stop().
+     * @param cancel Optional flag checked between frames
+     * @return Number of frames pushed
+     */
+    uint64_t Run(VideoCapture& capture, const std::atomic<bool>* cancel = nullptr);
+
+    bool IsRunning() const { return m_running; }
+    int GetNodeCount() const { return static_cast<int>(m_nodes.size()); }
+    std::string GetNodeName(int node) const;
+    StageStats GetStageStats(int node) const;
+
+private:
+    struct Node;
+    struct Edge;
+
+    std::vector<std::unique_ptr<Node>> m_nodes;
+    std::vector<std::unique_ptr<Edge>> m_edges;
+    bool m_running;
+    uint64_t m_nextIndex;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    bool Reaches(int from, int to) const;
+    std::vector<int> TopologicalOrder() const;
+    void Emit(Node& node, const GraphFramePtr& frame);
+    void Deliver(Node& node, const GraphFramePtr& frame);
+    void Enqueue(Edge& edge, const GraphFramePtr& frame);
+    void RunEdge(Edge& edge);
+};
+
+/**
+ * Sink stage that calls a function for every frame.
+ */
+class CallbackStage : public FrameStage {
+public:
+    explicit CallbackStage(std::function<void(const GraphFramePtr&)> callback) : m_callback(std::move(callback)) {}
+
+    bool Process(const GraphFramePtr& frame, const FrameEmitter& emit) override;
+
+private:
+    std::function<void(const GraphFramePtr&)> m_callback;
+};
+
+/**
+ * GPU scale and color conversion through the D3D11 video processor, e.g. NV12/P010 decoder
+ * output to a B8G8R8A8 thumbnail. Emits a new texture per frame; the visible area of the
+ * input is scaled to the full output size. Enables multithread protection on the frames'
+ * device, since the blit runs on the edge thread.
+ */
+class ConvertStage : public FrameStage {
+public:
+    // width/height of 0 keep the input size
+    ConvertStage(int width, int height, DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM);
+
+    bool Process(const GraphFramePtr& frame, const FrameEmitter& emit) override;
+
+private:
+    int m_width;
+    int m_height;
+    DXGI_FORMAT m_format;
+    int m_inputWidth;
+    int m_inputHeight;
+    ComPtr<ID3D11Device> m_device;
+    ComPtr<ID3D11VideoDevice> m_videoDevice;
+    ComPtr<ID3D11VideoContext> m_videoContext;
+    ComPtr<ID3D11VideoProcessorEnumerator> m_enumerator;
+    ComPtr<ID3D11VideoProcessor> m_processor;
+
+    bool CreateProcessor(ID3D11Texture2D* texture, int inputWidth, int inputHeight);
+};
+
+/**
+ * Sink stage that publishes frames to other processes through a FramePublisher pool. The
+ * pool is created from the first frame's size and format, and multithread protection is
+ * enabled on its device for the copies made on the edge thread.
+ */
+class PublishStage : public FrameStage {
+public:
+    PublishStage(const std::string& name, int slotCount = 8);
+    ~PublishStage() override;
+
+    bool Process(const GraphFramePtr& frame, const FrameEmitter& emit) override;
+    void Finish(const FrameEmitter& emit) override;
+
+private:
+    std::string m_name;
+    int m_slotCount;
+    std::unique_ptr<FramePublisher> m_publisher;
+};
@@ -0,0 +1,193 @@
+#include "FrameHub.h"
+#include "Logger.h"
+#include <deque>
+#include <condition_variable>
+#include <algorithm>
+#include <chrono>
+
+struct FrameHub::Subscriber {
+    SubscriberOptions options;
+    std::deque<std::pair<uint64_t, GraphFramePtr>> queue;  // Publish sequence, frame
+    uint64_t firstSequence = 0;         // First frame published after subscribing
+    uint64_t lastSequence = 0;          // Sequence of the last received frame
+    bool removed = false;
+    SubscriberStats stats;
+    std::condition_variable frameReady;
+    std::condition_variable spaceReady;
+};
+
+FrameHub::FrameHub()
+    : m_nextId(1)
+    , m_published(0)
+    , m_closed(false)
+{
+}
+
+FrameHub::~FrameHub() {
+    Close();
+}
+
+int FrameHub::Subscribe(const SubscriberOptions& options) {
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->options = options;
+    subscriber->options.queueSize = std::max(1, options.queueSize);
+    subscriber->options.interval = std::max(1, options.interval);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    subscriber->firstSequence = m_published + 1;
+    subscriber->lastSequence = m_published;
+    int id = m_nextId++;
+    m_subscribers[id] = subscriber;
+    LOG_DEBUG("FrameHub: subscriber ", id, " added (", m_subscribers.size(), " total)");
+    return id;
+}
+
+void FrameHub::Unsubscribe(int id) {
+    std::shared_ptr<Subscriber> subscriber;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_subscribers.find(id);
+        if (it == m_subscribers.end()) {
+            return;
+        }
+        subscriber = it->second;
+        subscriber->removed = true;
+        subscriber->queue.clear();
+        m_subscribers.erase(it);
+    }
+    subscriber->frameReady.notify_all();
+    subscriber->spaceReady.notify_all();
+}
+
+bool FrameHub::Publish(const GraphFramePtr& frame) {
+    if (!frame) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_closed) {
+        LOG_ERROR("FrameHub::Publish() - hub is closed");
+        return false;
+    }
+
+    uint64_t sequence = ++m_published;
+
+    // Copy: the map may change while waiting for a backpressure subscriber
+    std::vector<std::shared_ptr<Subscriber>> subscribers;
+    subscribers.reserve(m_subscribers.size());
+    for (const auto& entry : m_subscribers) {
+        subscribers.push_back(entry.second);
+    }
+
+    for (const auto& subscriber : subscribers) {
+        if (subscriber->removed) {
+            continue;
+        }
+
+        const SubscriberOptions& options = subscriber->options;
+        size_t capacity = static_cast<size_t>(options.queueSize);
+
+        switch (options.policy) {
+        case SubscriberPolicy::EveryFrame:
+            if (subscriber->queue.size() >= capacity) {
+                auto start = std::chrono::steady_clock::now();
+                subscriber->spaceReady.wait(lock, [&subscriber, capacity, this]() {
+                    return subscriber->removed || m_closed || subscriber->queue.size() < capacity;
+                });
+                subscriber->stats.publisherBlockedMs +=
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (subscriber->removed || m_closed) {
+                    continue;
+                }
+            }
+            break;
+
+        case SubscriberPolicy::LatestOnly:
+            subscriber->stats.framesDropped += subscriber->queue.size();
+            subscriber->queue.clear();
+            break;
+
+        case SubscriberPolicy::EveryNth:
+            if ((sequence - subscriber->firstSequence) % static_cast<uint64_t>(options.interval) != 0) {
+                subscriber->stats.framesSkipped++;
+                continue;
+            }
+            if (subscriber->queue.size() >= capacity) {
+                subscriber->stats.framesDropped++;
+                continue;
+            }
+            break;
+        }
+
+        subscriber->queue.emplace_back(sequence, frame);
+        subscriber->frameReady.notify_one();
+    }
+    return true;
+}
+
+void FrameHub::Close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+        return;
+    }
+
+    m_closed = true;
+    for (const auto& entry : m_subscribers) {
+        entry.second->frameReady.notify_all();
+        entry.second->spaceReady.notify_all();
+    }
+    LOG_DEBUG("FrameHub closed after ", m_published, " frames");
+}
+
+bool FrameHub::Receive(int id, GraphFramePtr& frame, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_subscribers.find(id);
+    if (it == m_subscribers.end()) {
+        return false;
+    }
+
+    std::shared_ptr<Subscriber> subscriber = it->second;
+    auto ready = [&subscriber, this]() {
+        return subscriber->removed || m_closed || !subscriber->queue.empty();
+    };
+    if (timeoutMs < 0) {
+        subscriber->frameReady.wait(lock, ready);
+    } else if (!subscriber->frameReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+        return false;
+    }
+
+    if (subscriber->removed || subscriber->queue.empty()) {
+        return false;
+    }
+
+    subscriber->lastSequence = subscriber->queue.front().first;
+    frame = std::move(subscriber->queue.front().second);
+    subscriber->queue.pop_front();
+    subscriber->stats.framesReceived++;
+    subscriber->spaceReady.notify_all();
+    return true;
+}
+
+bool FrameHub::IsClosed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_closed;
+}
+
+uint64_t FrameHub::GetPublishedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_published;
+}
+
+FrameHub::SubscriberStats FrameHub::GetStats(int id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_subscribers.find(id);
+    if (it == m_subscribers.end()) {
+        return SubscriberStats();
+    }
+
+    const Subscriber& subscriber = *it->second;
+    SubscriberStats stats = subscriber.stats;
+    stats.lagFrames = m_published - subscriber.lastSequence;
+    stats.queuedFrames = static_cast<int>(subscriber.queue.size());
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include "FrameGraph.h"
+
+// How a FrameHub subscriber receives frames
+enum class SubscriberPolicy {
+    EveryFrame,     // All frames in order; the publisher waits while the queue is full
+    LatestOnly,     // Only the newest frame; unread frames are replaced
+    EveryNth        // Every interval-th frame, queued like EveryFrame but never blocking
+};
+
+struct SubscriberOptions {
+    SubscriberPolicy policy = SubscriberPolicy::EveryFrame;
+    int queueSize = 4;                  // EveryFrame / EveryNth
+    int interval = 1;                   // EveryNth: deliver one frame out of interval
+};
+
+/**
+ * Fans one decoded stream out to any number of subscribers, each consuming on its own thread
+ * at its own speed. Frames are shared by reference (GraphFramePtr), never copied.
+ *
+ * Only EveryFrame subscribers can slow the publisher down (backpressure). LatestOnly
+ * subscribers always see the newest frame, and EveryNth subscribers drop frames when their
+ * queue is full, so a slow display, thumbnailer or ML worker never holds up decoding unless
+ * it asked to.
+ *
+ * Publish() from one thread; Subscribe(), Unsubscribe() and Receive() from any thread.
+ */
+class FrameHub {
+public:
+    struct SubscriberStats {
+        uint64_t framesReceived = 0;
+        uint64_t framesDropped = 0;     // Replaced (LatestOnly) or discarded on a full queue (EveryNth)
+        uint64_t framesSkipped = 0;     // Not selected by EveryNth
+        uint64_t lagFrames = 0;         // Frames published after the last one received
+        int queuedFrames = 0;
+        double publisherBlockedMs = 0.0;// Time Publish() waited for this subscriber
+    };
+
+    FrameHub();
+    ~FrameHub();
+
+    // Add a subscriber; frames published from now on are delivered to it. Returns its id.
+    int Subscribe(const SubscriberOptions& options = SubscriberOptions());
+
+    // Remove a subscriber; a Receive() waiting on it returns false
+    void Unsubscribe(int id);
+
+    // Hand a frame to every subscriber
+    bool Publish(const GraphFramePtr& frame);
+
+    // End of stream: subscribers drain their queues, then Receive() returns false
+    void Close();
+
+    /**
+     * Take the next frame for a subscriber.
+     * @param timeoutMs -1 waits indefinitely, 0 polls
+     * @return false on timeout, after Close() once the queue is empty, or if unsubscribed
+     */
+    bool Receive(int id, GraphFramePtr& frame, int timeoutMs = -1);
+
+    bool IsClosed() const;
+    uint64_t GetPublishedCount() const;
+    SubscriberStats GetStats(int id) const;
+
+private:
+    struct Subscriber;
+
+    std::map<int, std::shared_ptr<Subscriber>> m_subscribers;
+    int m_nextId;
+    uint64_t m_published;
+    bool m_closed;
+    mutable std::mutex m_mutex;
+};
@@ -0,0 +1,186 @@
+#include "FramePacer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+double SteadyPresentationClock::Now() {
+    auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(sinceEpoch).count();
+}
+
+void SteadyPresentationClock::SleepFor(double seconds) {
+    if (seconds > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+}
+
+void ManualPresentationClock::SleepFor(double seconds) {
+    if (seconds > 0.0) {
+        m_now += seconds;
+    }
+}
+
+FramePacer::FramePacer(PresentationClock* clock)
+    : m_clock(clock ? clock : &m_steadyClock)
+    , m_rate(1.0)
+    , m_lateTolerance(0.020)
+    , m_resyncThreshold(1.0)
+    , m_maxConsecutiveDrops(8)
+    , m_anchored(false)
+    , m_anchorClock(0.0)
+    , m_anchorPts(0.0)
+    , m_lastPts(0.0)
+    , m_heldPts(0.0)
+    , m_holding(false)
+    , m_consecutiveDrops(0)
+    , m_jitterSumMs(0.0)
+{
+}
+
+void FramePacer::SetRate(double rate) {
+    rate = std::max(0.0, rate);
+    if (rate == m_rate) {
+        return;
+    }
+
+    // Continue from the current stream position at the new speed
+    if (m_anchored) {
+        double now = m_clock->Now();
+        m_anchorPts = m_anchorPts + (now - m_anchorClock) * m_rate;
+        m_anchorClock = now;
+    }
+    m_rate = rate;
+    LOG_DEBUG("FramePacer: rate ", rate);
+}
+
+void FramePacer::Reset() {
+    m_anchored = false;
+    m_holding = false;
+    m_consecutiveDrops = 0;
+}
+
+PaceAction FramePacer::Check(double pts) {
+    double now = m_clock->Now();
+
+    if (!m_anchored || IsDiscontinuity(pts)) {
+        if (m_anchored) {
+            LOG_DEBUG("FramePacer: time stamp jump from ", m_lastPts, " to ", pts, " s, re-anchoring");
+            m_stats.resyncs++;
+        }
+        Anchor(pts, now);
+    }
+
+    if (m_rate <= 0.0) {
+        MarkHeld(pts);
+        return PaceAction::Hold;
+    }
+
+    double deadline = m_anchorClock + (pts - m_anchorPts) / m_rate;
+    double lateness = now - deadline;
+
+    if (lateness < 0.0) {
+        MarkHeld(pts);
+        return PaceAction::Hold;
+    }
+
+    m_holding = false;
+    m_lastPts = pts;
+
+    if (lateness > m_resyncThreshold) {
+        // Stalled far behind the clock: restart the schedule here instead of dropping it all
+        LOG_DEBUG("FramePacer: ", lateness * 1000.0, " ms behind, re-anchoring");
+        m_stats.resyncs++;
+        Anchor(pts, now);
+        lateness = 0.0;
+    } else if (lateness > m_lateTolerance &&
+               (m_maxConsecutiveDrops <= 0 || m_consecutiveDrops < m_maxConsecutiveDrops)) {
+        m_consecutiveDrops++;
+        m_stats.framesDropped++;
+        return PaceAction::Drop;
+    }
+
+    m_consecutiveDrops = 0;
+    m_stats.framesPresented++;
+
+    double jitterMs = std::fabs(lateness) * 1000.0;
+    m_jitterSumMs += jitterMs;
+    m_stats.maxJitterMs = std::max(m_stats.maxJitterMs, jitterMs);
+    m_stats.lastLatenessMs = lateness * 1000.0;
+    return PaceAction::Present;
+}
+
+PaceAction FramePacer::Wait(double pts, double maxWaitSeconds) {
+    if (m_rate <= 0.0) {
+        // Paused: nothing becomes due, give the caller its time slice back
+        m_clock->SleepFor(std::min(maxWaitSeconds, 0.010));
+        return Check(pts);
+    }
+
+    double remaining = maxWaitSeconds;
+    double untilDue = GetTimeUntilDue(pts);
+    if (untilDue > 0.0) {
+        MarkHeld(pts);
+    }
+    while (untilDue > 0.0 && remaining > 0.0) {
+        double step = std::min(untilDue, remaining);
+        m_clock->SleepFor(step);
+        remaining -= step;
+        untilDue = GetTimeUntilDue(pts);
+    }
+    return Check(pts);
+}
+
+double FramePacer::GetTimeUntilDue(double pts) {
+    if (!m_anchored || IsDiscontinuity(pts)) {
+        return 0.0;
+    }
+    if (m_rate <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double deadline = m_anchorClock + (pts - m_anchorPts) / m_rate;
+    return std::max(0.0, deadline - m_clock->Now());
+}
+
+double FramePacer::GetStreamTime() {
+    if (!m_anchored) {
+        return 0.0;
+    }
+    return m_anchorPts + (m_clock->Now() - m_anchorClock) * m_rate;
+}
+
+FramePacer::Stats FramePacer::GetStats() const {
+    Stats stats = m_stats;
+    if (stats.framesPresented > 0) {
+        stats.meanJitterMs = m_jitterSumMs / static_cast<double>(stats.framesPresented);
+    }
+    return stats;
+}
+
+void FramePacer::Anchor(double pts, double now) {
+    m_anchored = true;
+    m_anchorClock = now;
+    m_anchorPts = pts;
+    m_lastPts = pts;
+    m_holding = false;
+    m_consecutiveDrops = 0;
+}
+
+void FramePacer::MarkHeld(double pts) {
+    if (!m_holding || m_heldPts != pts) {
+        m_stats.framesHeld++;
+    }
+    m_holding = true;
+    m_heldPts = pts;
+}
+
+bool FramePacer::IsDiscontinuity(double pts) const {
+    // Output order is presentation order, so going backwards means a seek or loop
+    if (pts + 0.001 < m_lastPts) {
+        return true;
+    }
+    return pts - m_lastPts > m_resyncThreshold * std::max(1.0, m_rate);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Time source for FramePacer, in seconds. The default implementation follows
+ * std::chrono::steady_clock; an external master (e.g. an audio device clock) or a fake clock
+ * for headless testing can be supplied instead.
+ */
+class PresentationClock {
+public:
+    virtual ~PresentationClock() = default;
+
+    virtual double Now() = 0;
+
+    // Block for the given time; a fake clock advances itself instead
+    virtual void SleepFor(double seconds) = 0;
+};
+
+/**
+ * Monotonic wall clock (std::chrono::steady_clock).
+ */
+class SteadyPresentationClock : public PresentationClock {
+public:
+    double Now() override;
+    void SleepFor(double seconds) override;
+};
+
+/**
+ * Clock that only moves when told to; SleepFor() advances it by the requested time.
+ */
+class ManualPresentationClock : public PresentationClock {
+public:
+    explicit ManualPresentationClock(double start = 0.0) : m_now(start) {}
+
+    double Now() override { return m_now; }
+    void SleepFor(double seconds) override;
+
+    void Advance(double seconds) { m_now += seconds; }
+    void Set(double now) { m_now = now; }
+
+private:
+    double m_now;
+};
+
+enum class PaceAction {
+    Present,    // Frame is due: show it now
+    Hold,       // Frame is early: keep showing (repeat) the previous frame and ask again later
+    Drop        // Frame missed its deadline: discard it and pace the next one
+};
+
+/**
+ * Schedules decoded frames for their presentation time stamps against a clock.
+ *
+ * The first frame (and the first frame after Reset() or a time stamp discontinuity) anchors
+ * stream time to clock time; every later frame is due at
+ *     anchorClock + (pts - anchorPts) / rate.
+ * Frames more than the late tolerance past their deadline are dropped, except that a run of
+ * drops is capped so a decoder that cannot keep up still shows some frames. When the clock
+ * runs more than the resync threshold ahead of the stream (a network stall, a debugger
+ * break) the pacer re-anchors instead of dropping everything in between.
+ *
+ * Not thread-safe: use it from the thread that presents frames.
+ */
+class FramePacer {
+public:
+    struct Stats {
+        uint64_t framesPresented = 0;
+        uint64_t framesDropped = 0;
+        uint64_t framesHeld = 0;        // Frames that arrived early and had to wait
+        uint64_t resyncs = 0;           // Re-anchors after stalls or time stamp jumps
+        double meanJitterMs = 0.0;      // Mean |presentation - deadline| of presented frames
+        double maxJitterMs = 0.0;
+        double lastLatenessMs = 0.0;    // Presentation - deadline of the last presented frame
+    };
+
+    // The clock must outlive the pacer; nullptr uses an internal steady clock
+    explicit FramePacer(PresentationClock* clock = nullptr);
+
+    /**
+     * Change the playback rate (1.0 = real time, 2.0 = double speed, 0.0 = paused).
+     * Takes effect from the current stream position without a jump.
+     */
+    void SetRate(double rate);
+    double GetRate() const { return m_rate; }
+
+    // Lateness after which a frame is dropped (default 20 ms)
+    void SetLateTolerance(double seconds) { m_lateTolerance = seconds; }
+
+    // Lateness or time stamp jump after which the pacer re-anchors (default 1 s)
+    void SetResyncThreshold(double seconds) { m_resyncThreshold = seconds; }
+
+    // Consecutive drops after which a late frame is presented anyway (default 8, 0 = unlimited)
+    void SetMaxConsecutiveDrops(int count) { m_maxConsecutiveDrops = count; }
+
+    // Forget the anchor, e.g. after a seek; the next frame is presented immediately
+    void Reset();
+
+    /**
+     * Decide what to do with a frame at the current clock time without blocking.
+     * Call again with the same frame after a Hold.
+     */
+    PaceAction Check(double pts);
+
+    /**
+     * Sleep until the frame is due, then decide. Returns Hold if maxWaitSeconds elapsed
+     * first (or playback is paused), so a UI thread can pump messages between waits.
+     */
+    PaceAction Wait(double pts, double maxWaitSeconds);
+
+    // Clock time until the frame is due; 0 if due or late, negative never
+    double GetTimeUntilDue(double pts);
+
+    // Current stream position according to the clock
+    double GetStreamTime();
+
+    Stats GetStats() const;
+
+private:
+    SteadyPresentationClock m_steadyClock;
+    PresentationClock* m_clock;
+    double m_rate;
+    double m_lateTolerance;
+    double m_resyncThreshold;
+    int m_maxConsecutiveDrops;
+
+    bool m_anchored;
+    double m_anchorClock;
+    double m_anchorPts;
+    double m_lastPts;
+    double m_heldPts;
+    bool m_holding;
+    int m_consecutiveDrops;
+
+    Stats m_stats;
+    double m_jitterSumMs;
+
+    void Anchor(double pts, double now);
+    void MarkHeld(double pts);
+    bool IsDiscontinuity(double pts) const;
+};
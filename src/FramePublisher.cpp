@@ -0,0 +1,540 @@
+#include "FramePublisher.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Pool description at the start of the mapping, followed by the slot headers and the slots
+struct FramePoolHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;                    // DXGI_FORMAT
+    uint32_t slotCount;
+    uint32_t planeCount;
+    uint32_t rowBytes[2];               // Visible bytes per row
+    uint32_t rows[2];
+    uint32_t strides[2];                // Row pitch inside a slot
+    uint64_t planeOffsets[2];           // Plane start inside a slot
+    uint64_t slotSize;
+    uint64_t slotHeadersOffset;
+    uint64_t pixelsOffset;
+
+    alignas(64) std::atomic<uint64_t> latestSequence;   // 0 until the first frame
+    std::atomic<uint32_t> closed;
+};
+
+struct alignas(64) FrameSlotHeader {
+    std::atomic<uint64_t> lock;         // Sequence lock, odd while the slot is written
+    std::atomic<uint64_t> sequence;
+    std::atomic<double> presentationTime;
+};
+
+namespace {
+
+const uint32_t POOL_MAGIC = 0x50464356;     // "VCFP"
+const uint32_t POOL_VERSION = 1;
+const size_t HEADER_SIZE = 256;
+const size_t PAGE_SIZE = 4096;
+const size_t ROW_ALIGNMENT = 64;
+const int WAIT_SLICE_MS = 100;
+
+static_assert(sizeof(FramePoolHeader) <= HEADER_SIZE, "pool header too large");
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool GetPlaneLayout(DXGI_FORMAT format, int width, int height, FramePoolHeader& header) {
+    int chromaWidth = (width + 1) & ~1;
+    switch (format) {
+        case DXGI_FORMAT_NV12:
+            header.planeCount = 2;
+            header.rowBytes[0] = width;
+            header.rowBytes[1] = chromaWidth;
+            break;
+        case DXGI_FORMAT_P010:
+            header.planeCount = 2;
+            header.rowBytes[0] = width * 2;
+            header.rowBytes[1] = chromaWidth * 2;
+            break;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            header.planeCount = 1;
+            header.rowBytes[0] = width * 4;
+            header.rowBytes[1] = 0;
+            break;
+        default:
+            return false;
+    }
+    header.rows[0] = height;
+    header.rows[1] = header.planeCount > 1 ? (height + 1) / 2 : 0;
+    return true;
+}
+
+#ifdef _WIN32
+std::wstring ToWide(const std::string& utf8) {
+    std::wstring wide;
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0);
+    if (wlen > 0) {
+        wide.resize(wlen);
+        MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wide[0], wlen);
+    }
+    return wide;
+}
+#endif
+
+void ReleasePool(const void* view, void*& mapping, void* (&frameEvents)[2]) {
+#ifdef _WIN32
+    if (view) {
+        UnmapViewOfFile(view);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    for (void*& event : frameEvents) {
+        if (event) {
+            CloseHandle(event);
+        }
+    }
+#else
+    (void)view;
+#endif
+    mapping = nullptr;
+    frameEvents[0] = nullptr;
+    frameEvents[1] = nullptr;
+}
+
+} // namespace
+
+FramePublisher::FramePublisher()
+    : m_header(nullptr)
+    , m_slots(nullptr)
+    , m_pixels(nullptr)
+    , m_mapping(nullptr)
+    , m_frameEvents{ nullptr, nullptr }
+{
+}
+
+FramePublisher::~FramePublisher() {
+    Close();
+}
+
+bool FramePublisher::Create(const std::string& name, int width, int height, DXGI_FORMAT format, int slotCount) {
+    Close();
+
+    FramePoolHeader layout = {};
+    if (width <= 0 || height <= 0 || !GetPlaneLayout(format, width, height, layout)) {
+        LOG_ERROR("FramePublisher - unsupported frame layout ", width, "x", height, ", format ", format);
+        return false;
+    }
+    slotCount = std::max(2, slotCount);
+
+#ifdef _WIN32
+    // Slot layout: each plane row-aligned, each slot page-aligned
+    uint64_t slotSize = 0;
+    for (uint32_t plane = 0; plane < layout.planeCount; plane++) {
+        layout.strides[plane] = static_cast<uint32_t>(AlignUp(layout.rowBytes[plane], ROW_ALIGNMENT));
+        layout.planeOffsets[plane] = slotSize;
+        slotSize += static_cast<uint64_t>(layout.strides[plane]) * layout.rows[plane];
+    }
+    slotSize = AlignUp(static_cast<size_t>(slotSize), PAGE_SIZE);
+    uint64_t pixelsOffset = AlignUp(HEADER_SIZE + sizeof(FrameSlotHeader) * slotCount, PAGE_SIZE);
+    uint64_t mappingSize = pixelsOffset + slotSize * slotCount;
+
+    for (int i = 0; i < 2; i++) {
+        m_frameEvents[i] = CreateEventW(nullptr, TRUE, FALSE, ToWide(name + "_frame" + std::to_string(i)).c_str());
+        if (!m_frameEvents[i]) {
+            LOG_ERROR("FramePublisher - failed to create events for: ", name);
+            ReleasePool(nullptr, m_mapping, m_frameEvents);
+            return false;
+        }
+    }
+
+    m_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(mappingSize >> 32),
+                                   static_cast<DWORD>(mappingSize & 0xFFFFFFFF), ToWide(name).c_str());
+    if (!m_mapping) {
+        LOG_ERROR("FramePublisher - failed to create mapping: ", name);
+        ReleasePool(nullptr, m_mapping, m_frameEvents);
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        LOG_ERROR("FramePublisher - a frame pool with this name already exists: ", name);
+        ReleasePool(nullptr, m_mapping, m_frameEvents);
+        return false;
+    }
+
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(mappingSize));
+    if (!view) {
+        LOG_ERROR("FramePublisher - failed to map view of: ", name);
+        ReleasePool(nullptr, m_mapping, m_frameEvents);
+        return false;
+    }
+
+    uint8_t* base = static_cast<uint8_t*>(view);
+    m_header = new (view) FramePoolHeader();
+    m_header->version = POOL_VERSION;
+    m_header->width = width;
+    m_header->height = height;
+    m_header->format = format;
+    m_header->slotCount = slotCount;
+    m_header->planeCount = layout.planeCount;
+    for (int plane = 0; plane < 2; plane++) {
+        m_header->rowBytes[plane] = layout.rowBytes[plane];
+        m_header->rows[plane] = layout.rows[plane];
+        m_header->strides[plane] = layout.strides[plane];
+        m_header->planeOffsets[plane] = layout.planeOffsets[plane];
+    }
+    m_header->slotSize = slotSize;
+    m_header->slotHeadersOffset = HEADER_SIZE;
+    m_header->pixelsOffset = pixelsOffset;
+
+    m_slots = reinterpret_cast<FrameSlotHeader*>(base + HEADER_SIZE);
+    for (int i = 0; i < slotCount; i++) {
+        new (&m_slots[i]) FrameSlotHeader();
+    }
+    m_pixels = base + pixelsOffset;
+    m_header->magic.store(POOL_MAGIC, std::memory_order_release);   // Ready for subscribers
+
+    m_stats = Stats();
+    LOG_INFO("FramePublisher - created pool ", name, ": ", slotCount, " slots of ", width, "x", height,
+             " (", mappingSize / (1024 * 1024), " MB)");
+    return true;
+#else
+    LOG_ERROR("FramePublisher - shared frame pools are only supported on Windows: ", name);
+    return false;
+#endif
+}
+
+bool FramePublisher::Publish(const uint8_t* const planes[2], const int strides[2], double presentationTime) {
+    if (!m_header) {
+        LOG_ERROR("FramePublisher::Publish - pool not created");
+        return false;
+    }
+
+#ifdef _WIN32
+    uint64_t sequence = m_header->latestSequence.load(std::memory_order_relaxed) + 1;
+    uint32_t index = static_cast<uint32_t>((sequence - 1) % m_header->slotCount);
+    FrameSlotHeader& slot = m_slots[index];
+
+    // Waiters for the frame after this one block on the other event
+    ResetEvent(m_frameEvents[(sequence + 1) % 2]);
+
+    uint64_t lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.sequence.store(sequence, std::memory_order_relaxed);
+    slot.presentationTime.store(presentationTime, std::memory_order_relaxed);
+    uint8_t* destination = m_pixels + index * m_header->slotSize;
+    for (uint32_t plane = 0; plane < m_header->planeCount; plane++) {
+        uint8_t* dst = destination + m_header->planeOffsets[plane];
+        const uint8_t* src = planes[plane];
+        for (uint32_t row = 0; row < m_header->rows[plane]; row++) {
+            memcpy(dst, src, m_header->rowBytes[plane]);
+            dst += m_header->strides[plane];
+            src += strides[plane];
+        }
+        m_stats.bytesPublished += static_cast<uint64_t>(m_header->rowBytes[plane]) * m_header->rows[plane];
+    }
+
+    slot.lock.store(lock + 2, std::memory_order_release);
+    m_header->latestSequence.store(sequence, std::memory_order_release);
+    SetEvent(m_frameEvents[sequence % 2]);
+
+    m_stats.framesPublished++;
+    return true;
+#else
+    (void)planes;
+    (void)strides;
+    (void)presentationTime;
+    return false;
+#endif
+}
+
+bool FramePublisher::PublishTexture(ID3D11Texture2D* texture, double presentationTime) {
+    if (!m_header || !texture) {
+        LOG_ERROR("FramePublisher::PublishTexture - pool not created or no texture");
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+    if (desc.Format != static_cast<DXGI_FORMAT>(m_header->format) ||
+        desc.Width < m_header->width || desc.Height < m_header->height) {
+        LOG_ERROR("FramePublisher::PublishTexture - texture ", desc.Width, "x", desc.Height, " format ", desc.Format,
+                  " does not match the pool (", m_header->width, "x", m_header->height, " format ", m_header->format, ")");
+        return false;
+    }
+
+    auto readbackStart = std::chrono::steady_clock::now();
+
+    ComPtr<ID3D11Device> device;
+    texture->GetDevice(&device);
+    ComPtr<ID3D11DeviceContext> context;
+    device->GetImmediateContext(&context);
+
+    // Staging copy of the whole (possibly padded) texture, recreated when the size changes
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    if (m_staging) {
+        m_staging->GetDesc(&stagingDesc);
+    }
+    if (!m_staging || stagingDesc.Width != desc.Width || stagingDesc.Height != desc.Height) {
+        stagingDesc = desc;
+        stagingDesc.MipLevels = 1;
+        stagingDesc.ArraySize = 1;
+        stagingDesc.Usage = D3D11_USAGE_STAGING;
+        stagingDesc.BindFlags = 0;
+        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        stagingDesc.MiscFlags = 0;
+        m_staging.Reset();
+        HRESULT hr = device->CreateTexture2D(&stagingDesc, nullptr, &m_staging);
+        if (FAILED(hr)) {
+            LOG_ERROR("FramePublisher::PublishTexture - failed to create staging texture. HRESULT: 0x", std::hex, hr);
+            return false;
+        }
+    }
+
+    context->CopyResource(m_staging.Get(), texture);
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = context->Map(m_staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr)) {
+        LOG_ERROR("FramePublisher::PublishTexture - failed to map staging texture. HRESULT: 0x", std::hex, hr);
+        return false;
+    }
+
+    // Two-plane formats store the UV plane right after the (padded) Y plane
+    const uint8_t* data = static_cast<const uint8_t*>(mapped.pData);
+    const uint8_t* planes[2] = { data, data + static_cast<size_t>(mapped.RowPitch) * desc.Height };
+    int strides[2] = { static_cast<int>(mapped.RowPitch), static_cast<int>(mapped.RowPitch) };
+    bool published = Publish(planes, strides, presentationTime);
+    context->Unmap(m_staging.Get(), 0);
+
+    m_stats.readbackMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readbackStart).count();
+    return published;
+}
+
+void FramePublisher::Close() {
+    m_staging.Reset();
+    if (!m_header) {
+        return;
+    }
+
+    m_header->closed.store(1, std::memory_order_release);
+#ifdef _WIN32
+    SetEvent(m_frameEvents[0]);
+    SetEvent(m_frameEvents[1]);
+#endif
+    LOG_DEBUG("FramePublisher::Close - pool closed after ", m_stats.framesPublished, " frames");
+    ReleasePool(m_header, m_mapping, m_frameEvents);
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_pixels = nullptr;
+}
+
+FrameSubscriber::FrameSubscriber()
+    : m_header(nullptr)
+    , m_slots(nullptr)
+    , m_pixels(nullptr)
+    , m_mapping(nullptr)
+    , m_frameEvents{ nullptr, nullptr }
+    , m_lastSequence(0)
+{
+}
+
+FrameSubscriber::~FrameSubscriber() {
+    Close();
+}
+
+bool FrameSubscriber::Open(const std::string& name) {
+    Close();
+
+#ifdef _WIN32
+    m_mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, ToWide(name).c_str());
+    if (!m_mapping) {
+        LOG_DEBUG("FrameSubscriber::Open - no frame pool named ", name);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        LOG_ERROR("FrameSubscriber - failed to map view of: ", name);
+        ReleasePool(nullptr, m_mapping, m_frameEvents);
+        return false;
+    }
+
+    const FramePoolHeader* header = static_cast<const FramePoolHeader*>(view);
+    if (header->magic.load(std::memory_order_acquire) != POOL_MAGIC || header->version != POOL_VERSION) {
+        LOG_ERROR("FrameSubscriber - ", name, " is not a compatible frame pool (or not initialized yet)");
+        ReleasePool(view, m_mapping, m_frameEvents);
+        return false;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        m_frameEvents[i] = OpenEventW(SYNCHRONIZE, FALSE, ToWide(name + "_frame" + std::to_string(i)).c_str());
+        if (!m_frameEvents[i]) {
+            LOG_ERROR("FrameSubscriber - failed to open events for: ", name);
+            ReleasePool(view, m_mapping, m_frameEvents);
+            return false;
+        }
+    }
+
+    const uint8_t* base = static_cast<const uint8_t*>(view);
+    m_header = header;
+    m_slots = reinterpret_cast<const FrameSlotHeader*>(base + header->slotHeadersOffset);
+    m_pixels = base + header->pixelsOffset;
+
+    // The newest frame at attach time is the first one available
+    uint64_t latest = header->latestSequence.load(std::memory_order_acquire);
+    m_lastSequence = latest > 0 ? latest - 1 : 0;
+    m_stats = Stats();
+
+    LOG_INFO("FrameSubscriber - attached to ", name, ": ", header->width, "x", header->height,
+             ", ", header->slotCount, " slots");
+    return true;
+#else
+    LOG_ERROR("FrameSubscriber - shared frame pools are only supported on Windows: ", name);
+    return false;
+#endif
+}
+
+void FrameSubscriber::Close() {
+    if (!m_header) {
+        return;
+    }
+
+    ReleasePool(m_header, m_mapping, m_frameEvents);
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_pixels = nullptr;
+}
+
+bool FrameSubscriber::WaitForFrame(int timeoutMs) {
+    if (!m_header) {
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+    while (true) {
+        uint64_t latest = m_header->latestSequence.load(std::memory_order_acquire);
+        if (latest > m_lastSequence) {
+            return true;
+        }
+        if (m_header->closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+#ifdef _WIN32
+        // The event for frame latest + 1 was reset before latest was published. Waits are
+        // sliced so a subscriber that slept through two frames re-checks soon.
+        WaitForSingleObject(m_frameEvents[(latest + 1) % 2], static_cast<DWORD>(std::min<int64_t>(remaining, WAIT_SLICE_MS)));
+#endif
+    }
+}
+
+bool FrameSubscriber::AcquireLatest(SharedFrame& frame) {
+    if (!m_header) {
+        return false;
+    }
+
+    // A slot overwritten during acquisition means a newer frame exists: retry with that one
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint64_t latest = m_header->latestSequence.load(std::memory_order_acquire);
+        if (latest <= m_lastSequence) {
+            return false;
+        }
+        if (Acquire(latest, frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameSubscriber::AcquireNext(SharedFrame& frame) {
+    if (!m_header) {
+        return false;
+    }
+
+    uint64_t latest = m_header->latestSequence.load(std::memory_order_acquire);
+    uint64_t oldest = latest > m_header->slotCount ? latest - m_header->slotCount + 1 : 1;
+    for (uint64_t sequence = std::max(m_lastSequence + 1, oldest); sequence <= latest; sequence++) {
+        // The oldest slot is the next one to be overwritten; move on if it already was
+        if (Acquire(sequence, frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FrameSubscriber::IsValid(const SharedFrame& frame) {
+    if (!m_header || frame.slot < 0) {
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_slots[frame.slot].lock.load(std::memory_order_relaxed) != frame.lockValue) {
+        m_stats.framesTorn++;
+        return false;
+    }
+    return true;
+}
+
+uint64_t FrameSubscriber::GetLatestSequence() const {
+    return m_header ? m_header->latestSequence.load(std::memory_order_acquire) : 0;
+}
+
+bool FrameSubscriber::IsPublisherClosed() const {
+    return !m_header || m_header->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool FrameSubscriber::Acquire(uint64_t sequence, SharedFrame& frame) {
+    uint32_t index = static_cast<uint32_t>((sequence - 1) % m_header->slotCount);
+    const FrameSlotHeader& slot = m_slots[index];
+
+    uint64_t lock = slot.lock.load(std::memory_order_acquire);
+    uint64_t slotSequence = slot.sequence.load(std::memory_order_relaxed);
+    double presentationTime = slot.presentationTime.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if ((lock & 1) || slot.lock.load(std::memory_order_relaxed) != lock) {
+        m_stats.framesTorn++;
+        return false;
+    }
+    if (slotSequence != sequence) {
+        return false;   // Already overwritten by a newer frame
+    }
+
+    frame.sequence = sequence;
+    frame.presentationTime = presentationTime;
+    frame.width = static_cast<int>(m_header->width);
+    frame.height = static_cast<int>(m_header->height);
+    frame.format = static_cast<DXGI_FORMAT>(m_header->format);
+    const uint8_t* pixels = m_pixels + index * m_header->slotSize;
+    for (int plane = 0; plane < 2; plane++) {
+        bool present = static_cast<uint32_t>(plane) < m_header->planeCount;
+        frame.planes[plane] = present ? pixels + m_header->planeOffsets[plane] : nullptr;
+        frame.strides[plane] = present ? static_cast<int>(m_header->strides[plane]) : 0;
+    }
+    frame.slot = static_cast<int>(index);
+    frame.lockValue = lock;
+
+    if (sequence > m_lastSequence + 1) {
+        m_stats.framesSkipped += sequence - m_lastSequence - 1;
+    }
+    m_lastSequence = sequence;
+    m_stats.framesAcquired++;
+    return true;
+}
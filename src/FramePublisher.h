@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <d3d11.h>
+#include <dxgiformat.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+struct FramePoolHeader;
+struct FrameSlotHeader;
+
+/**
+ * Publishes decoded frames into a named shared-memory pool of fixed slots, so several
+ * processes can consume one decoded stream instead of each decoding it again.
+ *
+ * Every slot is guarded by a sequence lock: the publisher never waits for subscribers and
+ * simply overwrites the oldest slot, while subscribers read frames in place and check
+ * afterwards whether the slot was overwritten under them. Subscribers attach and detach at
+ * any time without the publisher noticing.
+ *
+ * Supported formats: NV12 and P010 (Y plane + interleaved UV plane), B8G8R8A8 / R8G8B8A8.
+ */
+class FramePublisher {
+public:
+    struct Stats {
+        uint64_t framesPublished = 0;
+        uint64_t bytesPublished = 0;
+        double readbackMs = 0.0;        // Total time spent in GPU readback (PublishTexture)
+    };
+
+    FramePublisher();
+    ~FramePublisher();
+
+    /**
+     * Create the frame pool.
+     * @param name Object name, e.g. "Local\\camera1_frames"
+     * @param width Visible frame width
+     * @param height Visible frame height
+     * @param format Pixel format of published frames
+     * @param slotCount Frames kept in the pool; a subscriber has roughly slotCount frame
+     *                  intervals to finish with a frame before it is overwritten
+     */
+    bool Create(const std::string& name, int width, int height, DXGI_FORMAT format, int slotCount = 8);
+
+    // Publish a CPU frame (planes[1]/strides[1] are ignored for single-plane formats)
+    bool Publish(const uint8_t* const planes[2], const int strides[2], double presentationTime);
+
+    /**
+     * Publish a decoded texture, e.g. from VideoCapture::read(). The texture is read back
+     * through a staging texture on the device's immediate context and copied straight into
+     * the shared slot. Texture padding beyond the visible size is skipped.
+     */
+    bool PublishTexture(ID3D11Texture2D* texture, double presentationTime);
+
+    // Mark the stream as ended and release the pool (subscribers keep their mappings)
+    void Close();
+
+    bool IsOpen() const { return m_header != nullptr; }
+    Stats GetStats() const { return m_stats; }
+
+private:
+    FramePoolHeader* m_header;
+    FrameSlotHeader* m_slots;
+    uint8_t* m_pixels;
+    void* m_mapping;                    // HANDLE
+    void* m_frameEvents[2];             // HANDLE, manual-reset, alternate per frame
+    ComPtr<ID3D11Texture2D> m_staging;
+    Stats m_stats;
+};
+
+/**
+ * A frame mapped from a FramePublisher pool. The planes point into read-only shared memory
+ * and stay readable, but their content is only trustworthy if FrameSubscriber::IsValid()
+ * still returns true after the frame has been processed.
+ */
+struct SharedFrame {
+    uint64_t sequence = 0;              // 1 for the first published frame
+    double presentationTime = 0.0;
+    int width = 0;
+    int height = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    const uint8_t* planes[2] = {};
+    int strides[2] = {};
+    int slot = -1;
+    uint64_t lockValue = 0;             // Slot sequence lock at acquisition
+};
+
+/**
+ * Read-only view of a FramePublisher pool in another (or the same) process.
+ */
+class FrameSubscriber {
+public:
+    struct Stats {
+        uint64_t framesAcquired = 0;
+        uint64_t framesSkipped = 0;     // Published frames this subscriber never acquired
+        uint64_t framesTorn = 0;        // Overwritten while being acquired or processed
+    };
+
+    FrameSubscriber();
+    ~FrameSubscriber();
+
+    // Attach to a pool created by FramePublisher::Create(); fails if it does not exist yet
+    bool Open(const std::string& name);
+    void Close();
+
+    /**
+     * Wait until a frame newer than the last acquired one is published.
+     * @return false on timeout or when the publisher has closed the pool
+     */
+    bool WaitForFrame(int timeoutMs);
+
+    // Map the newest frame, skipping anything older
+    bool AcquireLatest(SharedFrame& frame);
+
+    // Map the frame after the last acquired one (or the oldest still in the pool)
+    bool AcquireNext(SharedFrame& frame);
+
+    // True if the frame's slot has not been overwritten since it was acquired
+    bool IsValid(const SharedFrame& frame);
+
+    uint64_t GetLatestSequence() const;
+    bool IsPublisherClosed() const;
+    bool IsOpen() const { return m_header != nullptr; }
+    Stats GetStats() const { return m_stats; }
+
+private:
+    const FramePoolHeader* m_header;
+    const FrameSlotHeader* m_slots;
+    const uint8_t* m_pixels;
+    void* m_mapping;
+    void* m_frameEvents[2];
+    uint64_t m_lastSequence;
+    Stats m_stats;
+
+    bool Acquire(uint64_t sequence, SharedFrame& frame);
+};
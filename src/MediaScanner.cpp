@@ -0,0 +1,161 @@
+#include "MediaScanner.h"
+#include "Logger.h"
+#include <thread>
+#include <mutex>
+#include <semaphore>
+#include <algorithm>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+#include <libavutil/error.h>
+}
+
+MediaScanner::MediaScanner()
+    : m_threadCount(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))
+    , m_maxOpenFiles(16)
+    , m_probeSize(512 * 1024)
+    , m_cancelled(false)
+{
+}
+
+MediaScanner::~MediaScanner() {
+}
+
+void MediaScanner::SetThreadCount(int count) {
+    m_threadCount = std::max(1, count);
+}
+
+void MediaScanner::SetMaxOpenFiles(int count) {
+    m_maxOpenFiles = std::max(1, count);
+}
+
+void MediaScanner::SetProbeSize(int64_t bytes) {
+    m_probeSize = std::max<int64_t>(32, bytes);
+}
+
+bool MediaScanner::Scan(const std::vector<std::string>& paths, ResultCallback callback) {
+    m_cancelled = false;
+
+    if (paths.empty()) {
+        return true;
+    }
+
+    std::atomic<size_t> nextIndex(0);
+    std::mutex callbackMutex;
+    std::counting_semaphore<> openFiles(m_maxOpenFiles);
+
+    auto worker = [&]() {
+        while (!m_cancelled) {
+            size_t index = nextIndex++;
+            if (index >= paths.size()) {
+                break;
+            }
+
+            openFiles.acquire();
+            MediaInfo info = ProbeFile(paths[index]);
+            openFiles.release();
+
+            if (callback) {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                callback(info);
+            }
+        }
+    };
+
+    int threadCount = static_cast<int>(std::min<size_t>(m_threadCount, paths.size()));
+    LOG_INFO("Scanning ", paths.size(), " files on ", threadCount, " threads (max ", m_maxOpenFiles, " open files)");
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (m_cancelled) {
+        LOG_INFO("Scan cancelled after ", std::min(nextIndex.load(), paths.size()), " files");
+        return false;
+    }
+    return true;
+}
+
+void MediaScanner::Cancel() {
+    m_cancelled = true;
+}
+
+MediaInfo MediaScanner::ProbeFile(const std::string& path) const {
+    MediaInfo info;
+    info.path = path;
+
+    AVDictionary* options = nullptr;
+    av_dict_set_int(&options, "probesize", m_probeSize, 0);
+
+    AVFormatContext* formatContext = nullptr;
+    int ret = avformat_open_input(&formatContext, path.c_str(), nullptr, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        info.error = errorBuf;
+        LOG_DEBUG("MediaScanner - cannot open ", path, ": ", errorBuf);
+        return info;
+    }
+
+    int videoIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    AVStream* stream = videoIndex >= 0 ? formatContext->streams[videoIndex] : nullptr;
+
+    // Header-only containers already carry everything; analyse a bounded prefix otherwise
+    bool headersComplete = stream && stream->codecpar->width > 0 && stream->codecpar->height > 0 &&
+                           formatContext->duration != AV_NOPTS_VALUE;
+    if (!headersComplete) {
+        formatContext->max_analyze_duration = AV_TIME_BASE / 2;
+        ret = avformat_find_stream_info(formatContext, nullptr);
+        if (ret < 0) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            info.error = errorBuf;
+            avformat_close_input(&formatContext);
+            return info;
+        }
+        videoIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        stream = videoIndex >= 0 ? formatContext->streams[videoIndex] : nullptr;
+    }
+
+    if (!stream) {
+        info.error = "No video stream";
+        avformat_close_input(&formatContext);
+        return info;
+    }
+
+    info.container = formatContext->iformat ? formatContext->iformat->name : "";
+    info.codecId = stream->codecpar->codec_id;
+    info.codec = avcodec_get_name(info.codecId);
+    info.width = stream->codecpar->width;
+    info.height = stream->codecpar->height;
+
+    if (formatContext->duration != AV_NOPTS_VALUE) {
+        info.duration = static_cast<double>(formatContext->duration) / AV_TIME_BASE;
+    } else if (stream->duration != AV_NOPTS_VALUE) {
+        info.duration = static_cast<double>(stream->duration) * av_q2d(stream->time_base);
+    }
+
+    if (stream->avg_frame_rate.num != 0 && stream->avg_frame_rate.den != 0) {
+        info.frameRate = av_q2d(stream->avg_frame_rate);
+    } else if (stream->r_frame_rate.num != 0 && stream->r_frame_rate.den != 0) {
+        info.frameRate = av_q2d(stream->r_frame_rate);
+    }
+
+    if (stream->nb_frames > 0) {
+        info.frameCount = stream->nb_frames;
+        info.frameCountExact = true;
+    } else if (info.duration > 0.0 && info.frameRate > 0.0) {
+        info.frameCount = static_cast<int64_t>(info.duration * info.frameRate);
+    }
+
+    info.valid = true;
+    avformat_close_input(&formatContext);
+    return info;
+}
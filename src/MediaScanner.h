@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Basic properties of a media file, read from its container headers.
+ */
+struct MediaInfo {
+    std::string path;
+    bool valid = false;
+    std::string error;
+
+    std::string container;      // Demuxer short name, e.g. "mov,mp4,m4a,3gp,3g2,mj2"
+    std::string codec;          // Video codec name, e.g. "h264"
+    AVCodecID codecId = AV_CODEC_ID_NONE;
+    int width = 0;
+    int height = 0;
+    double duration = 0.0;      // Seconds
+    double frameRate = 0.0;
+    int64_t frameCount = 0;
+    bool frameCountExact = false;   // False when estimated from duration and frame rate
+};
+
+/**
+ * Headless parallel scanner for large media libraries.
+ * Probes files on a pool of worker threads without creating decoders or a D3D11 device,
+ * reading only the container headers (moov, EBML/Tracks, PAT/PMT). Streams whose headers
+ * lack the resolution (e.g. MPEG-TS) fall back to a small, bounded stream analysis.
+ */
+class MediaScanner {
+public:
+    // Invoked once per file from a worker thread; calls are serialized
+    using ResultCallback = std::function<void(const MediaInfo& info)>;
+
+    MediaScanner();
+    ~MediaScanner();
+
+    // Number of worker threads (default: hardware concurrency)
+    void SetThreadCount(int count);
+
+    // Upper bound on files open at the same time (default: 16)
+    void SetMaxOpenFiles(int count);
+
+    // Byte budget for the fallback stream analysis (default: 512 KB)
+    void SetProbeSize(int64_t bytes);
+
+    /**
+     * Scan files and stream results to the callback as they complete.
+     * Blocks until every file has been reported or Cancel() is called.
+     * @return false if the scan was cancelled
+     */
+    bool Scan(const std::vector<std::string>& paths, ResultCallback callback);
+
+    // Stop handing out new files (safe to call from the callback or another thread)
+    void Cancel();
+
+    // Probe a single file on the calling thread
+    MediaInfo ProbeFile(const std::string& path) const;
+
+private:
+    int m_threadCount;
+    int m_maxOpenFiles;
+    int64_t m_probeSize;
+    std::atomic<bool> m_cancelled;
+};
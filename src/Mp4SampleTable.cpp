@@ -0,0 +1,482 @@
+#include "Mp4SampleTable.h"
+#include "IDataSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const uint64_t MAX_MOOV_SIZE = 256ULL * 1024 * 1024;
+
+constexpr uint32_t FourCC(const char (&name)[5]) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(name[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(name[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(name[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(name[3]));
+}
+
+uint16_t ReadU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t ReadU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint64_t ReadU64(const uint8_t* p) {
+    return (static_cast<uint64_t>(ReadU32(p)) << 32) | ReadU32(p + 4);
+}
+
+// Calls visitor(type, payload, payloadSize) for every box in [data, data + size)
+template<typename Visitor>
+bool ForEachBox(const uint8_t* data, size_t size, Visitor visitor) {
+    size_t position = 0;
+    while (position + 8 <= size) {
+        uint64_t boxSize = ReadU32(data + position);
+        uint32_t type = ReadU32(data + position + 4);
+        size_t headerSize = 8;
+
+        if (boxSize == 1) {
+            if (position + 16 > size) {
+                return false;
+            }
+            boxSize = ReadU64(data + position + 8);
+            headerSize = 16;
+        } else if (boxSize == 0) {
+            boxSize = size - position;
+        }
+
+        if (boxSize < headerSize || boxSize > size - position) {
+            return false;
+        }
+
+        if (!visitor(type, data + position + headerSize, static_cast<size_t>(boxSize - headerSize))) {
+            return false;
+        }
+        position += static_cast<size_t>(boxSize);
+    }
+    return true;
+}
+
+// Number of entries of entrySize bytes following a full box header and entry count,
+// or -1 if the table is truncated
+int64_t TableEntries(const uint8_t* data, size_t size, size_t entrySize, size_t headerSize = 8) {
+    if (size < headerSize) {
+        return -1;
+    }
+    uint64_t count = ReadU32(data + headerSize - 4);
+    if (count * entrySize > size - headerSize) {
+        return -1;
+    }
+    return static_cast<int64_t>(count);
+}
+
+int ReadFully(IDataSource* source, uint8_t* buffer, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        int bytesRead = source->Read(buffer + total, static_cast<int>(size - total));
+        if (bytesRead <= 0) {
+            break;
+        }
+        total += bytesRead;
+    }
+    return static_cast<int>(total);
+}
+
+} // namespace
+
+struct Mp4SampleTable::TrackTables {
+    struct ChunkRun {
+        uint32_t firstChunk;
+        uint32_t samplesPerChunk;
+    };
+
+    bool isVideo = false;
+    uint32_t timescale = 0;
+    int64_t editMediaTime = 0;          // media timescale
+    int64_t editEmptyDuration = 0;      // media timescale
+
+    std::vector<std::pair<uint32_t, uint32_t>> timeToSample;        // count, delta
+    std::vector<std::pair<uint32_t, int32_t>> compositionOffsets;   // count, offset
+    std::vector<uint32_t> syncSamples;                              // 1-based sample numbers
+    bool hasSyncTable = false;
+
+    uint32_t sampleCount = 0;
+    uint32_t constantSampleSize = 0;
+    std::vector<uint32_t> sampleSizes;
+
+    std::vector<ChunkRun> sampleToChunk;
+    std::vector<int64_t> chunkOffsets;
+};
+
+Mp4SampleTable::Mp4SampleTable()
+    : m_timescale(0)
+{
+}
+
+Mp4SampleTable::~Mp4SampleTable() {
+}
+
+bool Mp4SampleTable::Parse(IDataSource* source) {
+    Clear();
+
+    if (!source || !source->IsSeekable()) {
+        return false;
+    }
+
+    std::vector<uint8_t> moov;
+    if (!FindMoov(source, moov)) {
+        LOG_DEBUG("Mp4SampleTable - no moov box found");
+        return false;
+    }
+
+    if (!ParseMoov(moov.data(), moov.size())) {
+        Clear();
+        return false;
+    }
+
+    LOG_DEBUG("Mp4SampleTable - ", m_samples.size(), " frames, ", m_keyframes.size(),
+              " keyframes, timescale ", m_timescale);
+    return true;
+}
+
+void Mp4SampleTable::Clear() {
+    m_samples.clear();
+    m_keyframes.clear();
+    m_presentationTimesUs.clear();
+    m_timescale = 0;
+}
+
+int64_t Mp4SampleTable::FrameToTimeUs(int64_t frameNumber) const {
+    if (frameNumber < 0 || frameNumber >= static_cast<int64_t>(m_presentationTimesUs.size())) {
+        return -1;
+    }
+    return m_presentationTimesUs[static_cast<size_t>(frameNumber)];
+}
+
+int64_t Mp4SampleTable::TimeUsToFrame(int64_t timeUs) const {
+    // Allow half a millisecond for rounding of seconds-based timestamps
+    auto it = std::upper_bound(m_presentationTimesUs.begin(), m_presentationTimesUs.end(), timeUs + 500);
+    return static_cast<int64_t>(it - m_presentationTimesUs.begin()) - 1;
+}
+
+bool Mp4SampleTable::FindMoov(IDataSource* source, std::vector<uint8_t>& moov) {
+    const int64_t fileSize = source->GetSize();
+    int64_t offset = 0;
+
+    // Walk top-level box headers; mdat is skipped by its size, so a moov at the end of the
+    // file costs one header read per preceding box plus the moov read itself
+    while (fileSize < 0 || offset < fileSize) {
+        if (source->Seek(offset, SEEK_SET) < 0) {
+            return false;
+        }
+
+        uint8_t header[16];
+        int headerBytes = ReadFully(source, header, sizeof(header));
+        if (headerBytes < 8) {
+            return false;
+        }
+
+        uint64_t boxSize = ReadU32(header);
+        uint32_t type = ReadU32(header + 4);
+        uint64_t headerSize = 8;
+
+        if (boxSize == 1) {
+            if (headerBytes < 16) {
+                return false;
+            }
+            boxSize = ReadU64(header + 8);
+            headerSize = 16;
+        } else if (boxSize == 0) {
+            if (fileSize < 0) {
+                return false;
+            }
+            boxSize = static_cast<uint64_t>(fileSize - offset);
+        }
+
+        // Stop at the first header that is not a plausible four-character code (not an MP4)
+        for (int i = 4; i < 8; i++) {
+            if (header[i] < 0x20 || header[i] > 0x7E) {
+                return false;
+            }
+        }
+
+        if (boxSize < headerSize) {
+            return false;
+        }
+
+        if (type == FourCC("moov")) {
+            uint64_t payloadSize = boxSize - headerSize;
+            if (payloadSize > MAX_MOOV_SIZE) {
+                LOG_WARNING("Mp4SampleTable - moov box too large: ", payloadSize, " bytes");
+                return false;
+            }
+
+            moov.resize(static_cast<size_t>(payloadSize));
+            if (source->Seek(offset + static_cast<int64_t>(headerSize), SEEK_SET) < 0) {
+                return false;
+            }
+            return ReadFully(source, moov.data(), moov.size()) == static_cast<int>(moov.size());
+        }
+
+        offset += static_cast<int64_t>(boxSize);
+    }
+
+    return false;
+}
+
+bool Mp4SampleTable::ParseMoov(const uint8_t* data, size_t size) {
+    uint32_t movieTimescale = 0;
+    std::vector<std::pair<const uint8_t*, size_t>> tracks;
+
+    bool ok = ForEachBox(data, size, [&](uint32_t type, const uint8_t* payload, size_t payloadSize) {
+        if (type == FourCC("mvhd") && payloadSize >= 24) {
+            movieTimescale = ReadU32(payload + (payload[0] == 1 ? 20 : 12));
+        } else if (type == FourCC("trak")) {
+            tracks.emplace_back(payload, payloadSize);
+        }
+        return true;
+    });
+
+    if (!ok) {
+        LOG_DEBUG("Mp4SampleTable - malformed moov box");
+        return false;
+    }
+
+    for (const auto& track : tracks) {
+        TrackTables tables;
+        if (!ParseTrak(track.first, track.second, movieTimescale, tables)) {
+            continue;
+        }
+        if (tables.isVideo && tables.sampleCount > 0) {
+            return BuildSamples(tables);
+        }
+    }
+
+    return false;
+}
+
+bool Mp4SampleTable::ParseTrak(const uint8_t* data, size_t size, uint32_t movieTimescale, TrackTables& tables) {
+    uint64_t emptyEditDuration = 0;     // movie timescale
+
+    auto parseStbl = [&](uint32_t type, const uint8_t* p, size_t n) {
+        if (type == FourCC("stts")) {
+            int64_t count = TableEntries(p, n, 8);
+            if (count < 0) return false;
+            for (int64_t i = 0; i < count; i++) {
+                tables.timeToSample.emplace_back(ReadU32(p + 8 + i * 8), ReadU32(p + 12 + i * 8));
+            }
+        } else if (type == FourCC("ctts")) {
+            int64_t count = TableEntries(p, n, 8);
+            if (count < 0) return false;
+            for (int64_t i = 0; i < count; i++) {
+                tables.compositionOffsets.emplace_back(ReadU32(p + 8 + i * 8),
+                                                       static_cast<int32_t>(ReadU32(p + 12 + i * 8)));
+            }
+        } else if (type == FourCC("stss")) {
+            int64_t count = TableEntries(p, n, 4);
+            if (count < 0) return false;
+            tables.hasSyncTable = true;
+            for (int64_t i = 0; i < count; i++) {
+                tables.syncSamples.push_back(ReadU32(p + 8 + i * 4));
+            }
+        } else if (type == FourCC("stsz")) {
+            if (n < 12) return false;
+            tables.constantSampleSize = ReadU32(p + 4);
+            tables.sampleCount = ReadU32(p + 8);
+            if (tables.constantSampleSize == 0) {
+                int64_t count = TableEntries(p, n, 4, 12);
+                if (count < 0) return false;
+                for (int64_t i = 0; i < count; i++) {
+                    tables.sampleSizes.push_back(ReadU32(p + 12 + i * 4));
+                }
+            }
+        } else if (type == FourCC("stz2")) {
+            if (n < 12) return false;
+            uint8_t fieldSize = p[7];
+            tables.sampleCount = ReadU32(p + 8);
+            if (fieldSize != 4 && fieldSize != 8 && fieldSize != 16) return false;
+            if ((static_cast<uint64_t>(tables.sampleCount) * fieldSize + 7) / 8 > n - 12) return false;
+            for (uint32_t i = 0; i < tables.sampleCount; i++) {
+                const uint8_t* entry = p + 12;
+                if (fieldSize == 16) {
+                    tables.sampleSizes.push_back(ReadU16(entry + i * 2));
+                } else if (fieldSize == 8) {
+                    tables.sampleSizes.push_back(entry[i]);
+                } else {
+                    uint8_t packed = entry[i / 2];
+                    tables.sampleSizes.push_back((i % 2 == 0) ? (packed >> 4) : (packed & 0x0F));
+                }
+            }
+        } else if (type == FourCC("stsc")) {
+            int64_t count = TableEntries(p, n, 12);
+            if (count < 0) return false;
+            for (int64_t i = 0; i < count; i++) {
+                tables.sampleToChunk.push_back({ReadU32(p + 8 + i * 12), ReadU32(p + 12 + i * 12)});
+            }
+        } else if (type == FourCC("stco")) {
+            int64_t count = TableEntries(p, n, 4);
+            if (count < 0) return false;
+            for (int64_t i = 0; i < count; i++) {
+                tables.chunkOffsets.push_back(ReadU32(p + 8 + i * 4));
+            }
+        } else if (type == FourCC("co64")) {
+            int64_t count = TableEntries(p, n, 8);
+            if (count < 0) return false;
+            for (int64_t i = 0; i < count; i++) {
+                tables.chunkOffsets.push_back(static_cast<int64_t>(ReadU64(p + 8 + i * 8)));
+            }
+        }
+        return true;
+    };
+
+    auto parseMdia = [&](uint32_t type, const uint8_t* p, size_t n) {
+        if (type == FourCC("mdhd") && n >= 24) {
+            tables.timescale = ReadU32(p + (p[0] == 1 ? 20 : 12));
+        } else if (type == FourCC("hdlr") && n >= 12) {
+            tables.isVideo = ReadU32(p + 8) == FourCC("vide");
+        } else if (type == FourCC("minf")) {
+            return ForEachBox(p, n, [&](uint32_t minfType, const uint8_t* q, size_t m) {
+                return minfType != FourCC("stbl") || ForEachBox(q, m, parseStbl);
+            });
+        }
+        return true;
+    };
+
+    auto parseElst = [&](const uint8_t* p, size_t n) {
+        bool version1 = n > 0 && p[0] == 1;
+        size_t entrySize = version1 ? 20 : 12;
+        int64_t count = TableEntries(p, n, entrySize);
+        if (count < 0) return false;
+        for (int64_t i = 0; i < count; i++) {
+            const uint8_t* entry = p + 8 + i * entrySize;
+            uint64_t segmentDuration = version1 ? ReadU64(entry) : ReadU32(entry);
+            int64_t mediaTime = version1 ? static_cast<int64_t>(ReadU64(entry + 8))
+                                         : static_cast<int32_t>(ReadU32(entry + 4));
+            if (mediaTime == -1) {
+                emptyEditDuration += segmentDuration;
+            } else {
+                tables.editMediaTime = mediaTime;
+                break;
+            }
+        }
+        return true;
+    };
+
+    bool ok = ForEachBox(data, size, [&](uint32_t type, const uint8_t* p, size_t n) {
+        if (type == FourCC("mdia")) {
+            return ForEachBox(p, n, parseMdia);
+        } else if (type == FourCC("edts")) {
+            return ForEachBox(p, n, [&](uint32_t edtsType, const uint8_t* q, size_t m) {
+                return edtsType != FourCC("elst") || parseElst(q, m);
+            });
+        }
+        return true;
+    });
+
+    if (!ok || tables.timescale == 0) {
+        return false;
+    }
+
+    if (emptyEditDuration > 0 && movieTimescale > 0) {
+        tables.editEmptyDuration = static_cast<int64_t>(emptyEditDuration * tables.timescale / movieTimescale);
+    }
+    return true;
+}
+
+bool Mp4SampleTable::BuildSamples(const TrackTables& tables) {
+    const uint32_t count = tables.sampleCount;
+    if (tables.constantSampleSize == 0 && tables.sampleSizes.size() < count) {
+        LOG_DEBUG("Mp4SampleTable - sample size table is truncated");
+        return false;
+    }
+    if (tables.timeToSample.empty() || tables.sampleToChunk.empty() || tables.chunkOffsets.empty()) {
+        LOG_DEBUG("Mp4SampleTable - incomplete sample table (fragmented file?)");
+        return false;
+    }
+
+    m_samples.resize(count);
+    const int64_t shift = tables.editEmptyDuration - tables.editMediaTime;
+
+    // Sizes and decode times
+    int64_t dts = 0;
+    size_t sttsRun = 0;
+    uint32_t sttsLeft = tables.timeToSample[0].first;
+    uint32_t delta = tables.timeToSample[0].second;
+    for (uint32_t i = 0; i < count; i++) {
+        while (sttsLeft == 0 && sttsRun + 1 < tables.timeToSample.size()) {
+            sttsRun++;
+            sttsLeft = tables.timeToSample[sttsRun].first;
+            delta = tables.timeToSample[sttsRun].second;
+        }
+
+        Sample& sample = m_samples[i];
+        sample.size = tables.constantSampleSize ? tables.constantSampleSize : tables.sampleSizes[i];
+        sample.dts = dts + shift;
+        sample.pts = sample.dts;
+        sample.keyframe = !tables.hasSyncTable;
+
+        dts += delta;
+        if (sttsLeft > 0) {
+            sttsLeft--;
+        }
+    }
+
+    // Composition offsets
+    uint32_t sample = 0;
+    for (const auto& run : tables.compositionOffsets) {
+        for (uint32_t i = 0; i < run.first && sample < count; i++, sample++) {
+            m_samples[sample].pts += run.second;
+        }
+    }
+
+    // Sync samples
+    for (uint32_t number : tables.syncSamples) {
+        if (number >= 1 && number <= count) {
+            m_samples[number - 1].keyframe = true;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (m_samples[i].keyframe) {
+            m_keyframes.push_back(i);
+        }
+    }
+
+    // Byte offsets from the chunk layout
+    sample = 0;
+    const uint32_t chunkCount = static_cast<uint32_t>(tables.chunkOffsets.size());
+    for (size_t run = 0; run < tables.sampleToChunk.size() && sample < count; run++) {
+        uint32_t firstChunk = tables.sampleToChunk[run].firstChunk;
+        uint32_t lastChunk = run + 1 < tables.sampleToChunk.size() ? tables.sampleToChunk[run + 1].firstChunk - 1 : chunkCount;
+        for (uint32_t chunk = firstChunk; chunk <= lastChunk && sample < count; chunk++) {
+            if (chunk == 0 || chunk > chunkCount) {
+                LOG_DEBUG("Mp4SampleTable - invalid chunk index ", chunk);
+                m_samples.clear();
+                m_keyframes.clear();
+                return false;
+            }
+            int64_t offset = tables.chunkOffsets[chunk - 1];
+            for (uint32_t i = 0; i < tables.sampleToChunk[run].samplesPerChunk && sample < count; i++, sample++) {
+                m_samples[sample].offset = offset;
+                offset += m_samples[sample].size;
+            }
+        }
+    }
+
+    if (sample < count) {
+        LOG_DEBUG("Mp4SampleTable - chunk table covers only ", sample, " of ", count, " samples");
+        m_samples.clear();
+        m_keyframes.clear();
+        return false;
+    }
+
+    m_timescale = tables.timescale;
+    m_presentationTimesUs.reserve(count);
+    for (const Sample& s : m_samples) {
+        m_presentationTimesUs.push_back(s.pts * 1000000 / m_timescale);
+    }
+    std::sort(m_presentationTimesUs.begin(), m_presentationTimesUs.end());
+
+    return true;
+}
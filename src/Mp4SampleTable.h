@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class IDataSource;
+
+/**
+ * Lightweight MP4/MOV sample table reader.
+ * Reads only the moov box (walking top-level box headers, so moov-at-end files cost a
+ * single extra read) and decodes stsz/stz2, stss, stts, ctts, stsc and stco/co64 of the
+ * first video track. This gives the exact frame count, per-frame presentation times,
+ * the keyframe list and sample byte offsets without running the FFmpeg probe.
+ * Fragmented files (sample data described by moof boxes) are not covered.
+ */
+class Mp4SampleTable {
+public:
+    struct Sample {
+        int64_t offset;     // Byte offset in the file
+        uint32_t size;      // Bytes
+        int64_t dts;        // Decode time (media timescale)
+        int64_t pts;        // Presentation time (media timescale, edit list applied)
+        bool keyframe;
+    };
+
+    Mp4SampleTable();
+    ~Mp4SampleTable();
+
+    /**
+     * Parse the sample table of the first video track.
+     * The source position is left undefined; callers must seek before reading again.
+     * @return true if a non-empty video sample table was found
+     */
+    bool Parse(IDataSource* source);
+    void Clear();
+
+    bool IsValid() const { return !m_samples.empty(); }
+    uint32_t GetTimescale() const { return m_timescale; }
+
+    // Samples in decode order
+    const std::vector<Sample>& GetSamples() const { return m_samples; }
+
+    // Decode-order indices of sync samples
+    const std::vector<uint32_t>& GetKeyframes() const { return m_keyframes; }
+
+    // Exact number of video frames
+    int64_t GetFrameCount() const { return static_cast<int64_t>(m_samples.size()); }
+
+    // Presentation times in display order, in microseconds
+    const std::vector<int64_t>& GetPresentationTimesUs() const { return m_presentationTimesUs; }
+
+    // Presentation time of a frame in display order (microseconds), or -1 if out of range
+    int64_t FrameToTimeUs(int64_t frameNumber) const;
+
+    // Display-order index of the frame shown at the given time, or -1 before the first frame
+    int64_t TimeUsToFrame(int64_t timeUs) const;
+
+private:
+    struct TrackTables;
+
+    std::vector<Sample> m_samples;
+    std::vector<uint32_t> m_keyframes;
+    std::vector<int64_t> m_presentationTimesUs;
+    uint32_t m_timescale;
+
+    bool FindMoov(IDataSource* source, std::vector<uint8_t>& moov);
+    bool ParseMoov(const uint8_t* data, size_t size);
+    bool ParseTrak(const uint8_t* data, size_t size, uint32_t movieTimescale, TrackTables& tables);
+    bool BuildSamples(const TrackTables& tables);
+};
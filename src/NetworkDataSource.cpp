@@ -0,0 +1,458 @@
+#include "NetworkDataSource.h"
+#include "NetworkReactor.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#endif
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavformat/avio.h>
+}
+
+namespace {
+
+const uintptr_t NO_SOCKET = ~static_cast<uintptr_t>(0);    // INVALID_SOCKET
+const size_t MIN_BUFFER_SIZE = 128 * 1024;
+const size_t UDP_RECEIVE_SPACE = 65536;                     // Largest datagram, never truncated
+const size_t TCP_RECEIVE_SPACE = 4096;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+// The one overlapped receive a source keeps outstanding
+struct NetworkDataSource::ReceiveOperation {
+#ifdef _WIN32
+    OVERLAPPED overlapped;
+    WSABUF buffers[2];
+    DWORD flags;
+#endif
+};
+
+NetworkDataSource::NetworkDataSource(NetworkReactor& reactor)
+    : m_reactor(reactor)
+    , m_socket(NO_SOCKET)
+    , m_isUdp(false)
+    , m_localPort(0)
+    , m_ringMask(0)
+    , m_bufferSize(1024 * 1024)
+    , m_minReceiveSpace(TCP_RECEIVE_SPACE)
+    , m_writeCount(0)
+    , m_readCount(0)
+    , m_position(0)
+    , m_receive(std::make_unique<ReceiveOperation>())
+    , m_receivePending(false)
+    , m_closing(false)
+    , m_receivePaused(false)
+    , m_eof(false)
+    , m_readerWaiting(false)
+    , m_readTimeoutMs(5000)
+    , m_callbackArmed(true)
+    , m_receives(0)
+    , m_receivePauses(0)
+    , m_callbacks(0)
+{
+}
+
+NetworkDataSource::~NetworkDataSource() {
+    Close();
+}
+
+int NetworkDataSource::Read(uint8_t* buffer, int size) {
+    if (size <= 0) {
+        return 0;
+    }
+
+    uint64_t readCount = m_readCount.load(std::memory_order_relaxed);
+    uint64_t available = m_writeCount.load(std::memory_order_acquire) - readCount;
+
+    if (available == 0 && !m_eof && m_readTimeoutMs > 0) {
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        m_readerWaiting = true;
+        m_dataAvailable.wait_for(lock, std::chrono::milliseconds(m_readTimeoutMs), [this, readCount]() {
+            return m_writeCount.load() != readCount || m_eof;
+        });
+        m_readerWaiting = false;
+        available = m_writeCount.load(std::memory_order_acquire) - readCount;
+    }
+
+    if (available == 0) {
+        // Data committed before the end of stream was flagged is still delivered
+        bool ended = m_eof;
+        available = m_writeCount.load(std::memory_order_acquire) - readCount;
+        if (available == 0) {
+            if (ended) {
+                LOG_DEBUG("NetworkDataSource::Read - EOF reached");
+                return AVERROR_EOF;
+            }
+            if (m_readTimeoutMs > 0) {
+                LOG_WARNING("NetworkDataSource::Read - no data within ", m_readTimeoutMs, " ms");
+            }
+            return AVERROR(EAGAIN);
+        }
+    }
+
+    // Copy out of the ring, wrapping at most once
+    size_t toRead = static_cast<size_t>(std::min<uint64_t>(available, static_cast<uint64_t>(size)));
+    size_t offset = static_cast<size_t>(readCount) & m_ringMask;
+    size_t first = std::min(toRead, m_ring.size() - offset);
+    memcpy(buffer, m_ring.data() + offset, first);
+    if (first < toRead) {
+        memcpy(buffer + first, m_ring.data(), toRead - first);
+    }
+
+    m_readCount.store(readCount + toRead);
+    m_position += static_cast<int64_t>(toRead);
+
+    ResumeReceive();
+    return static_cast<int>(toRead);
+}
+
+int64_t NetworkDataSource::Seek(int64_t offset, int whence) {
+    // Live stream: only position queries are answered
+    if (whence == SEEK_CUR && offset == 0) {
+        return m_position;
+    }
+    if (whence == AVSEEK_SIZE) {
+        return -1;
+    }
+    return AVERROR(ENOSYS);
+}
+
+int64_t NetworkDataSource::GetSize() const {
+    return -1;
+}
+
+bool NetworkDataSource::IsSeekable() const {
+    return false;
+}
+
+void NetworkDataSource::SetBufferSize(size_t bytes) {
+    m_bufferSize = RoundUpToPowerOfTwo(std::max(bytes, MIN_BUFFER_SIZE));
+}
+
+void NetworkDataSource::SetReadTimeout(int milliseconds) {
+    m_readTimeoutMs = std::max(0, milliseconds);
+}
+
+void NetworkDataSource::SetDataCallback(DataCallback callback) {
+    m_dataCallback = std::move(callback);
+}
+
+bool NetworkDataSource::OpenUdp(int port, const std::string& bindAddress) {
+#ifdef _WIN32
+    Close();
+
+    SOCKET socket = WSASocketW(AF_INET, SOCK_DGRAM, IPPROTO_UDP, nullptr, 0, WSA_FLAG_OVERLAPPED);
+    if (socket == INVALID_SOCKET) {
+        LOG_ERROR("NetworkDataSource - failed to create UDP socket: ", WSAGetLastError());
+        return false;
+    }
+
+    // Let the kernel absorb bursts while the ring is full
+    int receiveBuffer = static_cast<int>(std::min<size_t>(m_bufferSize, 8 * 1024 * 1024));
+    setsockopt(socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<u_short>(port));
+    if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1) {
+        LOG_ERROR("NetworkDataSource - invalid bind address: ", bindAddress);
+        closesocket(socket);
+        return false;
+    }
+
+    if (bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR) {
+        LOG_ERROR("NetworkDataSource - cannot bind UDP ", bindAddress, ":", port, ": ", WSAGetLastError());
+        closesocket(socket);
+        return false;
+    }
+
+    sockaddr_in local = {};
+    int localLength = sizeof(local);
+    getsockname(socket, reinterpret_cast<sockaddr*>(&local), &localLength);
+    m_localPort = ntohs(local.sin_port);
+
+    if (!Attach(socket, true)) {
+        return false;
+    }
+
+    LOG_DEBUG("NetworkDataSource - receiving UDP on ", bindAddress, ":", m_localPort);
+    return true;
+#else
+    (void)port;
+    LOG_ERROR("NetworkDataSource - only supported on Windows: udp ", bindAddress);
+    return false;
+#endif
+}
+
+bool NetworkDataSource::OpenTcp(const std::string& host, int port) {
+#ifdef _WIN32
+    Close();
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        LOG_ERROR("NetworkDataSource - cannot resolve ", host);
+        return false;
+    }
+
+    SOCKET socket = INVALID_SOCKET;
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        socket = WSASocketW(address->ai_family, address->ai_socktype, address->ai_protocol,
+                            nullptr, 0, WSA_FLAG_OVERLAPPED);
+        if (socket == INVALID_SOCKET) {
+            continue;
+        }
+        if (connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+            break;
+        }
+        closesocket(socket);
+        socket = INVALID_SOCKET;
+    }
+    freeaddrinfo(addresses);
+
+    if (socket == INVALID_SOCKET) {
+        LOG_ERROR("NetworkDataSource - cannot connect to ", host, ":", port);
+        return false;
+    }
+
+    m_localPort = 0;
+    if (!Attach(socket, false)) {
+        return false;
+    }
+
+    LOG_DEBUG("NetworkDataSource - connected to ", host, ":", port);
+    return true;
+#else
+    LOG_ERROR("NetworkDataSource - only supported on Windows: tcp ", host, ":", port);
+    return false;
+#endif
+}
+
+void NetworkDataSource::Close() {
+#ifdef _WIN32
+    {
+        std::unique_lock<std::mutex> lock(m_ioMutex);
+        if (m_socket == NO_SOCKET) {
+            return;
+        }
+
+        // Closing the socket aborts the outstanding receive; wait until the reactor has seen it
+        m_closing = true;
+        closesocket(static_cast<SOCKET>(m_socket));
+        m_receiveDone.wait(lock, [this]() { return !m_receivePending; });
+        m_socket = NO_SOCKET;
+    }
+
+    m_reactor.Unregister(this);
+    m_eof = true;
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_dataAvailable.notify_all();
+    }
+#endif
+}
+
+bool NetworkDataSource::ArmDataCallback() {
+    m_callbackArmed = true;
+    if (GetAvailable() == 0 && !m_eof) {
+        return true;
+    }
+
+    // Data raced in: keep reading, unless the reactor already took the notification
+    return !m_callbackArmed.exchange(false);
+}
+
+bool NetworkDataSource::IsOpen() const {
+    return m_socket != NO_SOCKET;
+}
+
+bool NetworkDataSource::IsEOF() const {
+    return m_eof && GetAvailable() == 0;
+}
+
+int NetworkDataSource::GetLocalPort() const {
+    return m_localPort;
+}
+
+size_t NetworkDataSource::GetAvailable() const {
+    return static_cast<size_t>(m_writeCount.load(std::memory_order_acquire) -
+                               m_readCount.load(std::memory_order_acquire));
+}
+
+NetworkDataSource::Stats NetworkDataSource::GetStats() const {
+    Stats stats;
+    stats.bytesReceived = m_writeCount;
+    stats.receives = m_receives;
+    stats.receivePauses = m_receivePauses;
+    stats.callbacks = m_callbacks;
+    stats.bytesBuffered = GetAvailable();
+    return stats;
+}
+
+bool NetworkDataSource::Attach(uintptr_t socket, bool isUdp) {
+#ifdef _WIN32
+    m_ring.assign(m_bufferSize, 0);
+    m_ringMask = m_ring.size() - 1;
+    m_minReceiveSpace = isUdp ? UDP_RECEIVE_SPACE : TCP_RECEIVE_SPACE;
+    m_writeCount = 0;
+    m_readCount = 0;
+    m_position = 0;
+    m_isUdp = isUdp;
+    m_closing = false;
+    m_receivePaused = false;
+    m_eof = false;
+    m_callbackArmed = true;
+
+    if (!m_reactor.Register(this, socket)) {
+        closesocket(static_cast<SOCKET>(socket));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    m_socket = socket;
+    if (!PostReceive()) {
+        m_reactor.Unregister(this);
+        closesocket(static_cast<SOCKET>(socket));
+        m_socket = NO_SOCKET;
+        return false;
+    }
+    m_receivePending = true;
+    return true;
+#else
+    (void)socket;
+    (void)isUdp;
+    return false;
+#endif
+}
+
+size_t NetworkDataSource::GetFreeSpace() const {
+    return m_ring.size() - static_cast<size_t>(m_writeCount.load(std::memory_order_relaxed) - m_readCount.load());
+}
+
+bool NetworkDataSource::ReceiveOrPause() {
+    // Called with m_ioMutex held, no receive outstanding
+    if (GetFreeSpace() < m_minReceiveSpace) {
+        m_receivePaused = true;
+        m_receivePauses++;
+
+        // The reader may have freed space before it could see the pause
+        if (GetFreeSpace() < m_minReceiveSpace) {
+            return true;
+        }
+        m_receivePaused = false;
+    }
+
+    if (!PostReceive()) {
+        return false;
+    }
+    m_receivePending = true;
+    return true;
+}
+
+bool NetworkDataSource::PostReceive() {
+#ifdef _WIN32
+    // Receive straight into the free part of the ring (two pieces when it wraps)
+    size_t freeSpace = GetFreeSpace();
+    size_t offset = static_cast<size_t>(m_writeCount.load(std::memory_order_relaxed)) & m_ringMask;
+    size_t first = std::min(freeSpace, m_ring.size() - offset);
+
+    ReceiveOperation& receive = *m_receive;
+    memset(&receive.overlapped, 0, sizeof(receive.overlapped));
+    receive.buffers[0].buf = reinterpret_cast<char*>(m_ring.data() + offset);
+    receive.buffers[0].len = static_cast<ULONG>(first);
+    receive.buffers[1].buf = reinterpret_cast<char*>(m_ring.data());
+    receive.buffers[1].len = static_cast<ULONG>(freeSpace - first);
+    receive.flags = 0;
+
+    DWORD bufferCount = receive.buffers[1].len > 0 ? 2 : 1;
+    if (WSARecv(static_cast<SOCKET>(m_socket), receive.buffers, bufferCount, nullptr, &receive.flags,
+                &receive.overlapped, nullptr) == SOCKET_ERROR) {
+        int error = WSAGetLastError();
+        if (error != WSA_IO_PENDING) {
+            LOG_ERROR("NetworkDataSource - receive failed: ", error);
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void NetworkDataSource::ResumeReceive() {
+    if (!m_receivePaused) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    if (!m_receivePaused || m_receivePending || m_closing || GetFreeSpace() < m_minReceiveSpace) {
+        return;
+    }
+    m_receivePaused = false;
+    if (!ReceiveOrPause()) {
+        m_eof = true;
+    }
+}
+
+void NetworkDataSource::OnReceiveComplete(uint32_t bytes, bool success) {
+    if (success && bytes > 0) {
+        m_writeCount.fetch_add(bytes);
+        m_receives++;
+        WakeReader();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_ioMutex);
+
+        // TCP: zero bytes is an orderly shutdown. UDP: errors such as ICMP port unreachable are not fatal
+        bool ended = m_closing || (!m_isUdp && (!success || bytes == 0));
+        if (!ended) {
+            m_receivePending = false;
+            if (ReceiveOrPause()) {
+                return;
+            }
+            m_receivePending = true; // Posting failed: finish below like any other end of stream
+        } else if (!m_closing) {
+            LOG_INFO("NetworkDataSource - ", success ? "connection closed by peer" : "receive failed");
+        }
+    }
+
+    // The source must stay alive until m_receivePending is cleared
+    m_eof = true;
+    WakeReader();
+
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    m_receivePending = false;
+    m_receiveDone.notify_all();
+}
+
+void NetworkDataSource::WakeReader() {
+    if (m_readerWaiting) {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_dataAvailable.notify_one();
+    }
+
+    if (m_dataCallback && m_callbackArmed.exchange(false)) {
+        m_callbacks++;
+        m_dataCallback();
+    }
+}
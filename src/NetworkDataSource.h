@@ -0,0 +1,122 @@
+#pragma once
+
+#include "IDataSource.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+class NetworkReactor;
+
+/**
+ * Network byte stream received through a shared NetworkReactor.
+ * Data arrives over TCP (any byte stream, e.g. MPEG-TS or fragmented MP4 over TCP) or UDP
+ * (datagrams are concatenated, e.g. MPEG-TS over UDP) into a single-producer/single-consumer
+ * ring buffer: the reactor writes, Read() consumes without taking a lock. When the ring is
+ * full, receiving pauses (TCP applies backpressure to the sender, UDP drops in the socket
+ * buffer) and resumes as soon as Read() frees space.
+ *
+ * Read() blocks up to the read timeout. With a data callback and a read timeout of 0, a
+ * task scheduler can instead drain the source whenever the callback fires: the callback runs
+ * on a reactor thread once per idle-to-data transition, after ArmDataCallback() succeeded.
+ */
+class NetworkDataSource : public IDataSource {
+public:
+    using DataCallback = std::function<void()>;
+
+    struct Stats {
+        uint64_t bytesReceived = 0;
+        uint64_t receives = 0;              // Completed receive operations
+        uint64_t receivePauses = 0;         // Times the ring was too full to receive
+        uint64_t callbacks = 0;             // Data callback invocations
+        size_t bytesBuffered = 0;           // Received, not yet read
+    };
+
+    explicit NetworkDataSource(NetworkReactor& reactor);
+    ~NetworkDataSource() override;
+
+    // IDataSource interface
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    int64_t GetSize() const override;
+    bool IsSeekable() const override;
+
+    // Configuration (before opening)
+    void SetBufferSize(size_t bytes);           // Ring size, rounded up to a power of two (default: 1 MB)
+    void SetReadTimeout(int milliseconds);      // Maximum wait in Read(), 0 = never wait (default: 5000 ms)
+    void SetDataCallback(DataCallback callback);
+
+    /**
+     * Receive UDP datagrams.
+     * @param port Local port, 0 picks a free port (see GetLocalPort())
+     * @param bindAddress Local address to bind
+     */
+    bool OpenUdp(int port, const std::string& bindAddress = "0.0.0.0");
+
+    // Connect to a TCP server and receive its byte stream
+    bool OpenTcp(const std::string& host, int port);
+
+    void Close();
+
+    /**
+     * Re-enable the data callback after draining the source.
+     * @return false if data arrived in the meantime (keep reading instead of waiting)
+     */
+    bool ArmDataCallback();
+
+    bool IsOpen() const;
+    bool IsEOF() const;
+    int GetLocalPort() const;
+    size_t GetAvailable() const;
+    Stats GetStats() const;
+
+private:
+    friend class NetworkReactor;
+
+    struct ReceiveOperation;
+
+    NetworkReactor& m_reactor;
+    uintptr_t m_socket;
+    bool m_isUdp;
+    int m_localPort;
+
+    // Ring buffer: monotonic byte counters, written by the reactor and the reader respectively
+    std::vector<uint8_t> m_ring;
+    size_t m_ringMask;
+    size_t m_bufferSize;
+    size_t m_minReceiveSpace;
+    std::atomic<uint64_t> m_writeCount;
+    std::atomic<uint64_t> m_readCount;
+    int64_t m_position;
+
+    std::unique_ptr<ReceiveOperation> m_receive;
+    std::mutex m_ioMutex;                   // Socket handle and posting of receives
+    std::condition_variable m_receiveDone;
+    bool m_receivePending;
+    bool m_closing;
+    std::atomic<bool> m_receivePaused;
+    std::atomic<bool> m_eof;
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_dataAvailable;
+    std::atomic<bool> m_readerWaiting;
+    int m_readTimeoutMs;
+
+    DataCallback m_dataCallback;
+    std::atomic<bool> m_callbackArmed;
+
+    std::atomic<uint64_t> m_receives;
+    std::atomic<uint64_t> m_receivePauses;
+    std::atomic<uint64_t> m_callbacks;
+
+    bool Attach(uintptr_t socket, bool isUdp);
+    size_t GetFreeSpace() const;
+    bool ReceiveOrPause();
+    bool PostReceive();
+    void ResumeReceive();
+    void OnReceiveComplete(uint32_t bytes, bool success);
+    void WakeReader();
+};
@@ -0,0 +1,175 @@
+#include "NetworkReactor.h"
+#include "NetworkDataSource.h"
+#include "Logger.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+NetworkReactor::NetworkReactor()
+    : m_completionPort(nullptr)
+    , m_running(false)
+    , m_winsockStarted(false)
+    , m_completions(0)
+    , m_batches(0)
+    , m_bytesReceived(0)
+    , m_sources(0)
+{
+}
+
+NetworkReactor::~NetworkReactor() {
+    Stop();
+}
+
+bool NetworkReactor::Start(int threads) {
+#ifdef _WIN32
+    if (m_running) {
+        return true;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        LOG_ERROR("NetworkReactor - WSAStartup failed");
+        return false;
+    }
+    m_winsockStarted = true;
+
+    threads = std::max(1, threads);
+    m_completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, static_cast<DWORD>(threads));
+    if (!m_completionPort) {
+        LOG_ERROR("NetworkReactor - failed to create I/O completion port: ", GetLastError());
+        WSACleanup();
+        m_winsockStarted = false;
+        return false;
+    }
+
+    m_running = true;
+    for (int i = 0; i < threads; i++) {
+        m_threads.emplace_back(&NetworkReactor::Run, this);
+    }
+
+    LOG_INFO("NetworkReactor started with ", threads, " thread(s)");
+    return true;
+#else
+    (void)threads;
+    LOG_ERROR("NetworkReactor - only supported on Windows");
+    return false;
+#endif
+}
+
+void NetworkReactor::Stop() {
+#ifdef _WIN32
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    if (m_sources > 0) {
+        LOG_WARNING("NetworkReactor - stopping with ", m_sources.load(), " source(s) still open");
+    }
+
+    // One wake-up per thread; completion key 0 means stop
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        PostQueuedCompletionStatus(m_completionPort, 0, 0, nullptr);
+    }
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+
+    CloseHandle(m_completionPort);
+    m_completionPort = nullptr;
+
+    if (m_winsockStarted) {
+        WSACleanup();
+        m_winsockStarted = false;
+    }
+    LOG_INFO("NetworkReactor stopped");
+#endif
+}
+
+bool NetworkReactor::IsRunning() const {
+    return m_running;
+}
+
+int NetworkReactor::GetThreadCount() const {
+    return static_cast<int>(m_threads.size());
+}
+
+NetworkReactor::Stats NetworkReactor::GetStats() const {
+    Stats stats;
+    stats.completions = m_completions;
+    stats.batches = m_batches;
+    stats.bytesReceived = m_bytesReceived;
+    stats.sources = m_sources;
+    return stats;
+}
+
+bool NetworkReactor::Register(NetworkDataSource* source, uintptr_t socket) {
+#ifdef _WIN32
+    if (!m_running) {
+        LOG_ERROR("NetworkReactor - Start() must be called before opening sources");
+        return false;
+    }
+
+    // The source pointer is the completion key of every receive on this socket
+    if (!CreateIoCompletionPort(reinterpret_cast<HANDLE>(socket), m_completionPort,
+                                reinterpret_cast<ULONG_PTR>(source), 0)) {
+        LOG_ERROR("NetworkReactor - failed to register socket: ", GetLastError());
+        return false;
+    }
+
+    m_sources++;
+    return true;
+#else
+    (void)source;
+    (void)socket;
+    return false;
+#endif
+}
+
+void NetworkReactor::Unregister(NetworkDataSource* source) {
+    (void)source;
+    m_sources--;
+}
+
+void NetworkReactor::Run() {
+#ifdef _WIN32
+    const ULONG MAX_ENTRIES = 64;
+    OVERLAPPED_ENTRY entries[MAX_ENTRIES];
+
+    while (true) {
+        ULONG count = 0;
+        if (!GetQueuedCompletionStatusEx(m_completionPort, entries, MAX_ENTRIES, &count, INFINITE, FALSE)) {
+            LOG_ERROR("NetworkReactor - completion port wait failed: ", GetLastError());
+            return;
+        }
+        m_batches++;
+
+        int stops = 0;
+        for (ULONG i = 0; i < count; i++) {
+            if (entries[i].lpCompletionKey == 0) {
+                stops++;
+                continue;
+            }
+
+            NetworkDataSource* source = reinterpret_cast<NetworkDataSource*>(entries[i].lpCompletionKey);
+            DWORD bytes = entries[i].dwNumberOfBytesTransferred;
+            bool success = entries[i].lpOverlapped->Internal == 0; // NTSTATUS of the receive
+
+            m_completions++;
+            m_bytesReceived += bytes;
+            source->OnReceiveComplete(bytes, success);
+        }
+
+        if (stops > 0) {
+            // Hand stop requests meant for other threads back to the port
+            for (int i = 1; i < stops; i++) {
+                PostQueuedCompletionStatus(m_completionPort, 0, 0, nullptr);
+            }
+            return;
+        }
+    }
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+class NetworkDataSource;
+
+/**
+ * Shared receive reactor for network data sources.
+ * A small pool of threads waits on one I/O completion port for every registered socket,
+ * so hundreds of streams do not each need their own reader thread. Each NetworkDataSource
+ * keeps one overlapped receive outstanding that writes straight into its ring buffer; when
+ * it completes, only that source's reader (or data callback) is woken.
+ *
+ * Start() the reactor before opening sources on it and close all sources before Stop().
+ */
+class NetworkReactor {
+public:
+    struct Stats {
+        uint64_t completions = 0;       // Receive completions processed
+        uint64_t batches = 0;           // Completion port dequeues (each up to 64 completions)
+        uint64_t bytesReceived = 0;
+        int sources = 0;                // Currently registered sources
+    };
+
+    NetworkReactor();
+    ~NetworkReactor();
+
+    /**
+     * Create the completion port and its threads.
+     * @param threads Reactor threads; 1 is enough for most hosts, each thread handles
+     *                completions for any source
+     */
+    bool Start(int threads = 1);
+    void Stop();
+
+    bool IsRunning() const;
+    int GetThreadCount() const;
+    Stats GetStats() const;
+
+private:
+    friend class NetworkDataSource;
+
+    void* m_completionPort;             // HANDLE
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_running;
+    bool m_winsockStarted;
+
+    std::atomic<uint64_t> m_completions;
+    std::atomic<uint64_t> m_batches;
+    std::atomic<uint64_t> m_bytesReceived;
+    std::atomic<int> m_sources;
+
+    // Called by NetworkDataSource
+    bool Register(NetworkDataSource* source, uintptr_t socket);
+    void Unregister(NetworkDataSource* source);
+
+    void Run();
+};
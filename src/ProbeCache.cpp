@@ -0,0 +1,529 @@
+#include "ProbeCache.h"
+#include "Logger.h"
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+const uint32_t CACHE_MAGIC = 0x43505643; // "CVPC"
+const uint32_t CACHE_VERSION = 1;
+const size_t FINGERPRINT_BYTES = 65536;
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+// FNV-1a
+uint64_t HashBytes(const uint8_t* data, size_t size, uint64_t seed = 14695981039346656037ULL) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+class ByteWriter {
+public:
+    template<typename T>
+    void Put(const T& value) {
+        PutBytes(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
+    }
+
+    void PutBytes(const uint8_t* data, size_t size) {
+        m_data.insert(m_data.end(), data, data + size);
+    }
+
+    void PutString(const std::string& value) {
+        Put(static_cast<uint32_t>(value.size()));
+        PutBytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+    }
+
+    std::vector<uint8_t>& Data() { return m_data; }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_position(0), m_ok(true) {}
+
+    template<typename T>
+    T Get() {
+        T value{};
+        if (m_position + sizeof(T) > m_size) {
+            m_ok = false;
+            return value;
+        }
+        memcpy(&value, m_data + m_position, sizeof(T));
+        m_position += sizeof(T);
+        return value;
+    }
+
+    const uint8_t* GetBytes(size_t size) {
+        if (m_position + size > m_size) {
+            m_ok = false;
+            return nullptr;
+        }
+        const uint8_t* bytes = m_data + m_position;
+        m_position += size;
+        return bytes;
+    }
+
+    std::string GetString() {
+        uint32_t length = Get<uint32_t>();
+        const uint8_t* bytes = GetBytes(length);
+        return bytes ? std::string(reinterpret_cast<const char*>(bytes), length) : std::string();
+    }
+
+    bool Ok() const { return m_ok; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position;
+    bool m_ok;
+};
+
+struct CachedStream {
+    AVCodecParameters par;
+    const uint8_t* extradata;
+    uint32_t extradataSize;
+    AVRational timeBase;
+    AVRational avgFrameRate;
+    AVRational realFrameRate;
+    int64_t startTime;
+    int64_t duration;
+    int64_t frameCount;
+    const uint8_t* indexEntries;
+    uint32_t indexCount;
+};
+
+struct CachedIndexEntry {
+    int64_t pos;
+    int64_t timestamp;
+    int32_t size;
+    int32_t distance;
+    int32_t flags;
+};
+
+#ifdef _WIN32
+std::wstring ToWide(const std::string& utf8) {
+    std::wstring wide;
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0);
+    if (wlen > 0) {
+        wide.resize(wlen);
+        MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wide[0], wlen);
+    }
+    return wide;
+}
+
+// Read-only mapping of one cache entry
+class MappedEntry {
+public:
+    explicit MappedEntry(const std::string& path) : m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr), m_view(nullptr), m_size(0) {
+        m_file = CreateFileW(ToWide(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(EntryHeader))) {
+            return;
+        }
+
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            return;
+        }
+
+        m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_view) {
+            m_size = static_cast<size_t>(fileSize.QuadPart);
+        }
+    }
+
+    ~MappedEntry() {
+        if (m_view) {
+            UnmapViewOfFile(m_view);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+    }
+
+    const uint8_t* Data() const { return m_view; }
+    size_t Size() const { return m_size; }
+
+private:
+    HANDLE m_file;
+    HANDLE m_mapping;
+    const uint8_t* m_view;
+    size_t m_size;
+};
+#endif
+
+} // namespace
+
+ProbeCache::ProbeCache(const std::string& directory)
+    : m_directory(directory)
+{
+#ifdef _WIN32
+    if (!CreateDirectoryW(ToWide(directory).c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        LOG_WARNING("ProbeCache - cannot create cache directory: ", directory);
+    }
+#endif
+}
+
+ProbeCache::~ProbeCache() {
+}
+
+bool ProbeCache::Restore(const std::string& filePath, AVFormatContext* formatContext) {
+#ifdef _WIN32
+    if (!formatContext) {
+        return false;
+    }
+
+    FileKey key;
+    if (!ComputeKey(filePath, key)) {
+        return false;
+    }
+
+    MappedEntry entry(GetEntryPath(key));
+    if (!entry.Data()) {
+        LOG_DEBUG("ProbeCache miss (no entry): ", filePath);
+        return false;
+    }
+
+    EntryHeader header;
+    memcpy(&header, entry.Data(), sizeof(header));
+    const uint8_t* payload = entry.Data() + sizeof(header);
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+        header.payloadSize != entry.Size() - sizeof(header) ||
+        header.payloadHash != HashBytes(payload, static_cast<size_t>(header.payloadSize))) {
+        LOG_DEBUG("ProbeCache miss (invalid entry): ", filePath);
+        return false;
+    }
+
+    ByteReader reader(payload, static_cast<size_t>(header.payloadSize));
+    std::string cachedPath = reader.GetString();
+    int64_t cachedSize = reader.Get<int64_t>();
+    int64_t cachedModifiedTime = reader.Get<int64_t>();
+    uint64_t cachedFingerprint = reader.Get<uint64_t>();
+    if (!reader.Ok() || cachedPath != key.path || cachedSize != key.size ||
+        cachedModifiedTime != key.modifiedTime || cachedFingerprint != key.fingerprint) {
+        LOG_DEBUG("ProbeCache miss (stale entry): ", filePath);
+        return false;
+    }
+
+    int64_t duration = reader.Get<int64_t>();
+    int64_t startTime = reader.Get<int64_t>();
+    int64_t bitRate = reader.Get<int64_t>();
+    uint32_t streamCount = reader.Get<uint32_t>();
+    if (!reader.Ok() || streamCount != formatContext->nb_streams) {
+        LOG_DEBUG("ProbeCache miss (stream layout changed): ", filePath);
+        return false;
+    }
+
+    // Parse and validate every stream before touching the context
+    std::vector<CachedStream> streams(streamCount);
+    for (uint32_t i = 0; i < streamCount; i++) {
+        CachedStream& cached = streams[i];
+        AVCodecParameters& par = cached.par;
+        memset(&par, 0, sizeof(par));
+        par.codec_type = static_cast<AVMediaType>(reader.Get<int32_t>());
+        par.codec_id = static_cast<AVCodecID>(reader.Get<int32_t>());
+        par.codec_tag = reader.Get<uint32_t>();
+        par.format = reader.Get<int32_t>();
+        par.profile = reader.Get<int32_t>();
+        par.level = reader.Get<int32_t>();
+        par.width = reader.Get<int32_t>();
+        par.height = reader.Get<int32_t>();
+        par.sample_aspect_ratio = reader.Get<AVRational>();
+        par.framerate = reader.Get<AVRational>();
+        par.field_order = static_cast<AVFieldOrder>(reader.Get<int32_t>());
+        par.color_range = static_cast<AVColorRange>(reader.Get<int32_t>());
+        par.color_primaries = static_cast<AVColorPrimaries>(reader.Get<int32_t>());
+        par.color_trc = static_cast<AVColorTransferCharacteristic>(reader.Get<int32_t>());
+        par.color_space = static_cast<AVColorSpace>(reader.Get<int32_t>());
+        par.chroma_location = static_cast<AVChromaLocation>(reader.Get<int32_t>());
+        par.video_delay = reader.Get<int32_t>();
+        par.bit_rate = reader.Get<int64_t>();
+        cached.extradataSize = reader.Get<uint32_t>();
+        cached.extradata = reader.GetBytes(cached.extradataSize);
+        cached.timeBase = reader.Get<AVRational>();
+        cached.avgFrameRate = reader.Get<AVRational>();
+        cached.realFrameRate = reader.Get<AVRational>();
+        cached.startTime = reader.Get<int64_t>();
+        cached.duration = reader.Get<int64_t>();
+        cached.frameCount = reader.Get<int64_t>();
+        cached.indexCount = reader.Get<uint32_t>();
+        cached.indexEntries = reader.GetBytes(static_cast<size_t>(cached.indexCount) * sizeof(CachedIndexEntry));
+
+        AVStream* stream = formatContext->streams[i];
+        if (!reader.Ok() ||
+            stream->codecpar->codec_type != par.codec_type ||
+            (stream->codecpar->codec_id != AV_CODEC_ID_NONE && stream->codecpar->codec_id != par.codec_id) ||
+            stream->time_base.num != cached.timeBase.num || stream->time_base.den != cached.timeBase.den) {
+            LOG_DEBUG("ProbeCache miss (stream ", i, " changed): ", filePath);
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < streamCount; i++) {
+        const CachedStream& cached = streams[i];
+        AVStream* stream = formatContext->streams[i];
+        AVCodecParameters* par = stream->codecpar;
+
+        par->codec_id = cached.par.codec_id;
+        par->codec_tag = cached.par.codec_tag;
+        par->format = cached.par.format;
+        par->profile = cached.par.profile;
+        par->level = cached.par.level;
+        par->width = cached.par.width;
+        par->height = cached.par.height;
+        par->sample_aspect_ratio = cached.par.sample_aspect_ratio;
+        par->framerate = cached.par.framerate;
+        par->field_order = cached.par.field_order;
+        par->color_range = cached.par.color_range;
+        par->color_primaries = cached.par.color_primaries;
+        par->color_trc = cached.par.color_trc;
+        par->color_space = cached.par.color_space;
+        par->chroma_location = cached.par.chroma_location;
+        par->video_delay = cached.par.video_delay;
+        par->bit_rate = cached.par.bit_rate;
+
+        if (cached.extradataSize > 0) {
+            av_freep(&par->extradata);
+            par->extradata = static_cast<uint8_t*>(av_mallocz(cached.extradataSize + AV_INPUT_BUFFER_PADDING_SIZE));
+            if (!par->extradata) {
+                par->extradata_size = 0;
+                LOG_ERROR("ProbeCache - failed to allocate extradata");
+                return false;
+            }
+            memcpy(par->extradata, cached.extradata, cached.extradataSize);
+            par->extradata_size = static_cast<int>(cached.extradataSize);
+        }
+
+        stream->avg_frame_rate = cached.avgFrameRate;
+        stream->r_frame_rate = cached.realFrameRate;
+        stream->start_time = cached.startTime;
+        stream->duration = cached.duration;
+        stream->nb_frames = cached.frameCount;
+
+        // Containers without an index in the header (e.g. Matroska without cues) benefit most
+        if (cached.indexCount > 0 && avformat_index_get_entries_count(stream) == 0) {
+            for (uint32_t j = 0; j < cached.indexCount; j++) {
+                CachedIndexEntry indexEntry;
+                memcpy(&indexEntry, cached.indexEntries + j * sizeof(CachedIndexEntry), sizeof(indexEntry));
+                av_add_index_entry(stream, indexEntry.pos, indexEntry.timestamp, indexEntry.size,
+                                   indexEntry.distance, indexEntry.flags);
+            }
+        }
+    }
+
+    formatContext->duration = duration;
+    formatContext->start_time = startTime;
+    formatContext->bit_rate = bitRate;
+
+    LOG_DEBUG("ProbeCache hit: ", filePath);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ProbeCache::Store(const std::string& filePath, AVFormatContext* formatContext) {
+    if (!formatContext) {
+        return false;
+    }
+
+    FileKey key;
+    if (!ComputeKey(filePath, key)) {
+        return false;
+    }
+
+    ByteWriter writer;
+    writer.PutString(key.path);
+    writer.Put(key.size);
+    writer.Put(key.modifiedTime);
+    writer.Put(key.fingerprint);
+
+    writer.Put(static_cast<int64_t>(formatContext->duration));
+    writer.Put(static_cast<int64_t>(formatContext->start_time));
+    writer.Put(static_cast<int64_t>(formatContext->bit_rate));
+    writer.Put(static_cast<uint32_t>(formatContext->nb_streams));
+
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        AVStream* stream = formatContext->streams[i];
+        const AVCodecParameters* par = stream->codecpar;
+
+        writer.Put(static_cast<int32_t>(par->codec_type));
+        writer.Put(static_cast<int32_t>(par->codec_id));
+        writer.Put(static_cast<uint32_t>(par->codec_tag));
+        writer.Put(static_cast<int32_t>(par->format));
+        writer.Put(static_cast<int32_t>(par->profile));
+        writer.Put(static_cast<int32_t>(par->level));
+        writer.Put(static_cast<int32_t>(par->width));
+        writer.Put(static_cast<int32_t>(par->height));
+        writer.Put(par->sample_aspect_ratio);
+        writer.Put(par->framerate);
+        writer.Put(static_cast<int32_t>(par->field_order));
+        writer.Put(static_cast<int32_t>(par->color_range));
+        writer.Put(static_cast<int32_t>(par->color_primaries));
+        writer.Put(static_cast<int32_t>(par->color_trc));
+        writer.Put(static_cast<int32_t>(par->color_space));
+        writer.Put(static_cast<int32_t>(par->chroma_location));
+        writer.Put(static_cast<int32_t>(par->video_delay));
+        writer.Put(static_cast<int64_t>(par->bit_rate));
+        writer.Put(static_cast<uint32_t>(par->extradata_size > 0 ? par->extradata_size : 0));
+        if (par->extradata_size > 0) {
+            writer.PutBytes(par->extradata, par->extradata_size);
+        }
+        writer.Put(stream->time_base);
+        writer.Put(stream->avg_frame_rate);
+        writer.Put(stream->r_frame_rate);
+        writer.Put(static_cast<int64_t>(stream->start_time));
+        writer.Put(static_cast<int64_t>(stream->duration));
+        writer.Put(static_cast<int64_t>(stream->nb_frames));
+
+        // Keyframe index of video streams
+        std::vector<CachedIndexEntry> keyframes;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            int count = avformat_index_get_entries_count(stream);
+            for (int j = 0; j < count; j++) {
+                const AVIndexEntry* indexEntry = avformat_index_get_entry(stream, j);
+                if (indexEntry && (indexEntry->flags & AVINDEX_KEYFRAME)) {
+                    keyframes.push_back({indexEntry->pos, indexEntry->timestamp, indexEntry->size,
+                                         indexEntry->min_distance, indexEntry->flags});
+                }
+            }
+        }
+        writer.Put(static_cast<uint32_t>(keyframes.size()));
+        if (!keyframes.empty()) {
+            writer.PutBytes(reinterpret_cast<const uint8_t*>(keyframes.data()), keyframes.size() * sizeof(CachedIndexEntry));
+        }
+    }
+
+    const std::vector<uint8_t>& payload = writer.Data();
+    EntryHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.payloadSize = payload.size();
+    header.payloadHash = HashBytes(payload.data(), payload.size());
+
+    std::vector<uint8_t> data(sizeof(header) + payload.size());
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), payload.data(), payload.size());
+
+    if (!WriteEntry(GetEntryPath(key), data)) {
+        return false;
+    }
+
+    LOG_DEBUG("ProbeCache stored: ", filePath, " (", data.size(), " bytes)");
+    return true;
+}
+
+bool ProbeCache::ComputeKey(const std::string& filePath, FileKey& key) const {
+#ifdef _WIN32
+    std::wstring wpath = ToWide(filePath);
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &attributes)) {
+        return false;
+    }
+
+    key.path = filePath;
+    key.size = (static_cast<int64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    key.modifiedTime = (static_cast<int64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+                       attributes.ftLastWriteTime.dwLowDateTime;
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // Fingerprint the head and tail of the file, where container headers live
+    std::vector<uint8_t> buffer(FINGERPRINT_BYTES);
+    uint64_t fingerprint = HashBytes(reinterpret_cast<const uint8_t*>(&key.size), sizeof(key.size));
+    DWORD bytesRead = 0;
+    if (ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr)) {
+        fingerprint = HashBytes(buffer.data(), bytesRead, fingerprint);
+    }
+
+    if (key.size > static_cast<int64_t>(FINGERPRINT_BYTES)) {
+        LARGE_INTEGER tailOffset;
+        tailOffset.QuadPart = key.size - static_cast<int64_t>(FINGERPRINT_BYTES);
+        if (SetFilePointerEx(file, tailOffset, nullptr, FILE_BEGIN) &&
+            ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr)) {
+            fingerprint = HashBytes(buffer.data(), bytesRead, fingerprint);
+        }
+    }
+
+    CloseHandle(file);
+    key.fingerprint = fingerprint;
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::string ProbeCache::GetEntryPath(const FileKey& key) const {
+    uint64_t pathHash = HashBytes(reinterpret_cast<const uint8_t*>(key.path.data()), key.path.size());
+    std::ostringstream oss;
+    oss << m_directory << "/" << std::hex << std::setw(16) << std::setfill('0') << pathHash << ".probe";
+    return oss.str();
+}
+
+bool ProbeCache::WriteEntry(const std::string& entryPath, const std::vector<uint8_t>& data) const {
+#ifdef _WIN32
+    // Write a private temporary file, then atomically replace the entry so readers in
+    // other processes never observe a partial file
+    std::ostringstream tempPath;
+    tempPath << entryPath << "." << GetCurrentProcessId() << "." << GetCurrentThreadId() << ".tmp";
+    std::wstring wtemp = ToWide(tempPath.str());
+
+    HANDLE file = CreateFileW(wtemp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_WARNING("ProbeCache - cannot create ", tempPath.str());
+        return false;
+    }
+
+    DWORD written = 0;
+    bool ok = WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) && written == data.size();
+    CloseHandle(file);
+
+    if (ok) {
+        ok = MoveFileExW(wtemp.c_str(), ToWide(entryPath).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+        if (!ok) {
+            // Another process may hold the entry mapped; its copy is equally valid
+            LOG_DEBUG("ProbeCache - entry busy, skipping store: ", entryPath);
+        }
+    }
+
+    if (!ok) {
+        DeleteFileW(wtemp.c_str());
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
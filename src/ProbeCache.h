@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * Persistent cache of stream analysis results.
+ * After the first open of a file, the codec parameters, stream layout, duration, frame count
+ * and video keyframe index are stored on disk so later opens can skip avformat_find_stream_info.
+ *
+ * Entries are keyed by path, size, modification time and a fingerprint of the first and last
+ * 64 KB of the file. Each entry is a separate file that is memory-mapped for reading and
+ * replaced atomically on write, so several processes can share one cache directory.
+ */
+class ProbeCache {
+public:
+    explicit ProbeCache(const std::string& directory);
+    ~ProbeCache();
+
+    /**
+     * Restore cached analysis into a freshly opened format context.
+     * @param filePath File the context was opened from
+     * @param formatContext Context returned by avformat_open_input
+     * @return true on a cache hit; stream info probing can then be skipped
+     */
+    bool Restore(const std::string& filePath, AVFormatContext* formatContext);
+
+    /**
+     * Store the analysis of a probed format context.
+     * @param filePath File the context was opened from
+     * @param formatContext Context after avformat_find_stream_info
+     * @return true if the entry was written
+     */
+    bool Store(const std::string& filePath, AVFormatContext* formatContext);
+
+    const std::string& GetDirectory() const { return m_directory; }
+
+private:
+    struct FileKey {
+        std::string path;
+        int64_t size;
+        int64_t modifiedTime;
+        uint64_t fingerprint;
+    };
+
+    std::string m_directory;
+
+    bool ComputeKey(const std::string& filePath, FileKey& key) const;
+    std::string GetEntryPath(const FileKey& key) const;
+    bool WriteEntry(const std::string& entryPath, const std::vector<uint8_t>& data) const;
+};
@@ -0,0 +1,425 @@
+#include "SharedMemoryDataSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavformat/avio.h>
+}
+
+// Layout at the start of the mapping, shared by both processes. Producer and consumer fields
+// live on separate cache lines.
+struct SharedRingHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t capacity;                  // Power of two
+
+    alignas(64) std::atomic<uint64_t> writeCount;
+    std::atomic<uint32_t> readerWaiting;
+    std::atomic<uint32_t> eof;
+
+    alignas(64) std::atomic<uint64_t> readCount;
+    std::atomic<uint32_t> writerWaiting;
+    std::atomic<uint32_t> readerAttached;
+};
+
+namespace {
+
+const uint32_t RING_MAGIC = 0x52534356;     // "VCSR"
+const uint32_t RING_VERSION = 1;
+const size_t DATA_OFFSET = 256;
+const size_t MIN_CAPACITY = 64 * 1024;
+
+static_assert(sizeof(SharedRingHeader) <= DATA_OFFSET, "ring header overlaps data");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+#ifdef _WIN32
+std::wstring ToWide(const std::string& utf8) {
+    std::wstring wide;
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, nullptr, 0);
+    if (wlen > 0) {
+        wide.resize(wlen);
+        MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wide[0], wlen);
+    }
+    return wide;
+}
+#endif
+
+void ReleaseRing(SharedRingHeader*& header, uint8_t*& data, void*& mapping, void*& dataEvent, void*& spaceEvent) {
+#ifdef _WIN32
+    if (header) {
+        UnmapViewOfFile(header);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (dataEvent) {
+        CloseHandle(dataEvent);
+    }
+    if (spaceEvent) {
+        CloseHandle(spaceEvent);
+    }
+#endif
+    header = nullptr;
+    data = nullptr;
+    mapping = nullptr;
+    dataEvent = nullptr;
+    spaceEvent = nullptr;
+}
+
+int RemainingMs(std::chrono::steady_clock::time_point deadline) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<int64_t>(0, remaining.count()));
+}
+
+} // namespace
+
+SharedMemoryWriter::SharedMemoryWriter()
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_mapping(nullptr)
+    , m_dataEvent(nullptr)
+    , m_spaceEvent(nullptr)
+    , m_writeTimeoutMs(1000)
+{
+}
+
+SharedMemoryWriter::~SharedMemoryWriter() {
+    Close();
+}
+
+bool SharedMemoryWriter::Create(const std::string& name, size_t capacity) {
+    Close();
+
+#ifdef _WIN32
+    capacity = RoundUpToPowerOfTwo(std::max(capacity, MIN_CAPACITY));
+
+    // Events first, so a reader that finds the mapping also finds them
+    m_dataEvent = CreateEventW(nullptr, FALSE, FALSE, ToWide(name + "_data").c_str());
+    m_spaceEvent = CreateEventW(nullptr, FALSE, FALSE, ToWide(name + "_space").c_str());
+    if (!m_dataEvent || !m_spaceEvent) {
+        LOG_ERROR("SharedMemoryWriter - failed to create events for: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    uint64_t mappingSize = DATA_OFFSET + static_cast<uint64_t>(capacity);
+    m_mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(mappingSize >> 32),
+                                   static_cast<DWORD>(mappingSize & 0xFFFFFFFF), ToWide(name).c_str());
+    if (!m_mapping) {
+        LOG_ERROR("SharedMemoryWriter - failed to create mapping: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        LOG_ERROR("SharedMemoryWriter - a ring with this name already exists: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(mappingSize));
+    if (!view) {
+        LOG_ERROR("SharedMemoryWriter - failed to map view of: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    m_header = new (view) SharedRingHeader();
+    m_data = static_cast<uint8_t*>(view) + DATA_OFFSET;
+    m_header->version = RING_VERSION;
+    m_header->capacity = capacity;
+    m_header->magic.store(RING_MAGIC, std::memory_order_release);   // Ready for readers
+
+    m_stats = Stats();
+    LOG_INFO("SharedMemoryWriter - created ring ", name, " (", capacity / 1024, " KB)");
+    return true;
+#else
+    LOG_ERROR("SharedMemoryWriter - shared memory rings are only supported on Windows: ", name);
+    return false;
+#endif
+}
+
+bool SharedMemoryWriter::Write(const uint8_t* data, size_t size) {
+    if (!m_header) {
+        LOG_ERROR("SharedMemoryWriter::Write - ring not created");
+        return false;
+    }
+
+#ifdef _WIN32
+    const uint64_t capacity = m_header->capacity;
+    uint64_t writeCount = m_header->writeCount.load(std::memory_order_relaxed);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_writeTimeoutMs);
+    size_t written = 0;
+
+    while (written < size) {
+        uint64_t readCount = m_header->readCount.load(std::memory_order_acquire);
+        size_t space = static_cast<size_t>(capacity - (writeCount - readCount));
+
+        if (space == 0) {
+            if (!m_header->readerAttached.load(std::memory_order_acquire)) {
+                LOG_WARNING("SharedMemoryWriter::Write - ring full and no reader attached");
+                return false;
+            }
+
+            // Announce the wait, then re-check: pairs with the reader publishing readCount
+            m_header->writerWaiting.store(1, std::memory_order_seq_cst);
+            if (m_header->readCount.load(std::memory_order_seq_cst) == readCount) {
+                int remainingMs = RemainingMs(deadline);
+                if (remainingMs == 0) {
+                    m_header->writerWaiting.store(0, std::memory_order_relaxed);
+                    LOG_WARNING("SharedMemoryWriter::Write - reader did not free space within ", m_writeTimeoutMs, " ms");
+                    return false;
+                }
+                m_stats.waits++;
+                WaitForSingleObject(m_spaceEvent, static_cast<DWORD>(remainingMs));
+            }
+            m_header->writerWaiting.store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        size_t chunk = std::min(space, size - written);
+        size_t offset = static_cast<size_t>(writeCount & (capacity - 1));
+        size_t first = std::min(chunk, static_cast<size_t>(capacity) - offset);
+        memcpy(m_data + offset, data + written, first);
+        if (first < chunk) {
+            memcpy(m_data, data + written + first, chunk - first);
+        }
+
+        writeCount += chunk;
+        written += chunk;
+        m_header->writeCount.store(writeCount, std::memory_order_seq_cst);
+        if (m_header->readerWaiting.load(std::memory_order_seq_cst)) {
+            SetEvent(m_dataEvent);
+            m_stats.wakeups++;
+        }
+    }
+
+    m_stats.bytesWritten += size;
+    return true;
+#else
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+void SharedMemoryWriter::Close() {
+    if (!m_header) {
+        return;
+    }
+
+    m_header->eof.store(1, std::memory_order_seq_cst);
+#ifdef _WIN32
+    SetEvent(m_dataEvent);
+#endif
+    ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+    LOG_DEBUG("SharedMemoryWriter::Close - ring closed after ", m_stats.bytesWritten, " bytes");
+}
+
+void SharedMemoryWriter::SetWriteTimeout(int milliseconds) {
+    m_writeTimeoutMs = std::max(0, milliseconds);
+}
+
+bool SharedMemoryWriter::IsReaderAttached() const {
+    return m_header && m_header->readerAttached.load(std::memory_order_acquire) != 0;
+}
+
+size_t SharedMemoryWriter::GetCapacity() const {
+    return m_header ? static_cast<size_t>(m_header->capacity) : 0;
+}
+
+SharedMemoryDataSource::SharedMemoryDataSource()
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_mapping(nullptr)
+    , m_dataEvent(nullptr)
+    , m_spaceEvent(nullptr)
+    , m_position(0)
+    , m_readTimeoutMs(5000)
+{
+}
+
+SharedMemoryDataSource::~SharedMemoryDataSource() {
+    Close();
+}
+
+bool SharedMemoryDataSource::Open(const std::string& name) {
+    Close();
+
+#ifdef _WIN32
+    m_mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, ToWide(name).c_str());
+    if (!m_mapping) {
+        LOG_DEBUG("SharedMemoryDataSource::Open - no ring named ", name);
+        return false;
+    }
+
+    void* view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!view) {
+        LOG_ERROR("SharedMemoryDataSource - failed to map view of: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+    m_header = static_cast<SharedRingHeader*>(view);
+
+    if (m_header->magic.load(std::memory_order_acquire) != RING_MAGIC || m_header->version != RING_VERSION) {
+        LOG_ERROR("SharedMemoryDataSource - ", name, " is not a compatible ring (or not initialized yet)");
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    uint32_t expected = 0;
+    if (!m_header->readerAttached.compare_exchange_strong(expected, 1)) {
+        LOG_ERROR("SharedMemoryDataSource - ring already has a reader: ", name);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    m_dataEvent = OpenEventW(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, ToWide(name + "_data").c_str());
+    m_spaceEvent = OpenEventW(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, ToWide(name + "_space").c_str());
+    if (!m_dataEvent || !m_spaceEvent) {
+        LOG_ERROR("SharedMemoryDataSource - failed to open events for: ", name);
+        m_header->readerAttached.store(0, std::memory_order_release);
+        ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(view) + DATA_OFFSET;
+    m_position = 0;
+    m_stats = Stats();
+    LOG_INFO("SharedMemoryDataSource - attached to ", name, " (", m_header->capacity / 1024, " KB)");
+    return true;
+#else
+    LOG_ERROR("SharedMemoryDataSource - shared memory rings are only supported on Windows: ", name);
+    return false;
+#endif
+}
+
+void SharedMemoryDataSource::Close() {
+    if (!m_header) {
+        return;
+    }
+
+    m_header->readerAttached.store(0, std::memory_order_seq_cst);
+#ifdef _WIN32
+    SetEvent(m_spaceEvent);     // A writer blocked on a full ring fails fast instead of timing out
+#endif
+    ReleaseRing(m_header, m_data, m_mapping, m_dataEvent, m_spaceEvent);
+}
+
+int SharedMemoryDataSource::Read(uint8_t* buffer, int size) {
+    if (!m_header) {
+        LOG_ERROR("SharedMemoryDataSource::Read - not open");
+        return AVERROR(EINVAL);
+    }
+    if (size <= 0) {
+        return 0;
+    }
+
+#ifdef _WIN32
+    const uint64_t capacity = m_header->capacity;
+    uint64_t readCount = m_header->readCount.load(std::memory_order_relaxed);
+    uint64_t writeCount = m_header->writeCount.load(std::memory_order_acquire);
+
+    if (writeCount == readCount) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_readTimeoutMs);
+        while (writeCount == readCount) {
+            if (m_header->eof.load(std::memory_order_acquire)) {
+                writeCount = m_header->writeCount.load(std::memory_order_acquire);
+                if (writeCount == readCount) {
+                    LOG_DEBUG("SharedMemoryDataSource::Read - EOF reached");
+                    return AVERROR_EOF;
+                }
+                break;
+            }
+
+            int remainingMs = RemainingMs(deadline);
+            if (remainingMs == 0) {
+                return AVERROR(EAGAIN);
+            }
+
+            // Announce the wait, then re-check: pairs with the writer publishing writeCount
+            m_header->readerWaiting.store(1, std::memory_order_seq_cst);
+            writeCount = m_header->writeCount.load(std::memory_order_seq_cst);
+            if (writeCount == readCount && !m_header->eof.load(std::memory_order_seq_cst)) {
+                m_stats.waits++;
+                WaitForSingleObject(m_dataEvent, static_cast<DWORD>(remainingMs));
+                writeCount = m_header->writeCount.load(std::memory_order_acquire);
+            }
+            m_header->readerWaiting.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t toRead = static_cast<size_t>(std::min<uint64_t>(static_cast<uint64_t>(size), writeCount - readCount));
+    size_t offset = static_cast<size_t>(readCount & (capacity - 1));
+    size_t first = std::min(toRead, static_cast<size_t>(capacity) - offset);
+    memcpy(buffer, m_data + offset, first);
+    if (first < toRead) {
+        memcpy(buffer + first, m_data, toRead - first);
+    }
+
+    m_header->readCount.store(readCount + toRead, std::memory_order_seq_cst);
+    if (m_header->writerWaiting.load(std::memory_order_seq_cst)) {
+        SetEvent(m_spaceEvent);
+    }
+
+    m_position += static_cast<int64_t>(toRead);
+    m_stats.bytesRead += toRead;
+    return static_cast<int>(toRead);
+#else
+    (void)buffer;
+    return AVERROR(ENOSYS);
+#endif
+}
+
+int64_t SharedMemoryDataSource::Seek(int64_t offset, int whence) {
+    // Live stream: only position queries are answered
+    if (whence == SEEK_CUR && offset == 0) {
+        return m_position;
+    }
+    if (whence == AVSEEK_SIZE) {
+        return -1;
+    }
+    return AVERROR(ENOSYS);
+}
+
+int64_t SharedMemoryDataSource::GetSize() const {
+    return -1;
+}
+
+bool SharedMemoryDataSource::IsSeekable() const {
+    return false;
+}
+
+void SharedMemoryDataSource::SetReadTimeout(int milliseconds) {
+    m_readTimeoutMs = std::max(0, milliseconds);
+}
+
+bool SharedMemoryDataSource::IsOpen() const {
+    return m_header != nullptr;
+}
+
+SharedMemoryDataSource::Stats SharedMemoryDataSource::GetStats() const {
+    Stats stats = m_stats;
+    if (m_header) {
+        stats.bytesBuffered = static_cast<size_t>(m_header->writeCount.load(std::memory_order_acquire) -
+                                                  m_header->readCount.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
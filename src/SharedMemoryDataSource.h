@@ -0,0 +1,99 @@
+#pragma once
+
+#include "IDataSource.h"
+#include <string>
+
+struct SharedRingHeader;
+
+/**
+ * Writer side of a named shared-memory byte ring, for handing a compressed stream from a
+ * capture process to a decode process. The writer creates the ring; one SharedMemoryDataSource
+ * in another process attaches to it by name.
+ *
+ * Data is copied once, straight into the shared ring. Producer and consumer synchronize through
+ * atomic counters in the mapping; the named events are only signalled when the other side is
+ * actually waiting, so a stream that keeps flowing needs no system calls.
+ */
+class SharedMemoryWriter {
+public:
+    struct Stats {
+        uint64_t bytesWritten = 0;
+        uint64_t waits = 0;             // Times Write() blocked on a full ring
+        uint64_t wakeups = 0;           // Events signalled to a waiting reader
+    };
+
+    SharedMemoryWriter();
+    ~SharedMemoryWriter();
+
+    /**
+     * Create the ring.
+     * @param name Object name, e.g. "Local\\camera1" (session) or "Global\\camera1"
+     * @param capacity Ring size in bytes, rounded up to a power of two
+     */
+    bool Create(const std::string& name, size_t capacity = 8 * 1024 * 1024);
+
+    /**
+     * Append data, blocking while the ring is full.
+     * Fails if no reader frees space within the write timeout, or if the ring is full and no
+     * reader is attached.
+     */
+    bool Write(const uint8_t* data, size_t size);
+
+    // Signal end of stream and release the ring (the reader keeps its mapping until it closes)
+    void Close();
+
+    void SetWriteTimeout(int milliseconds);     // Default: 1000 ms
+    bool IsReaderAttached() const;
+    size_t GetCapacity() const;
+    Stats GetStats() const { return m_stats; }
+
+private:
+    SharedRingHeader* m_header;
+    uint8_t* m_data;
+    void* m_mapping;                    // HANDLE
+    void* m_dataEvent;                  // HANDLE, signalled for the reader
+    void* m_spaceEvent;                 // HANDLE, signalled for the writer
+    int m_writeTimeoutMs;
+    Stats m_stats;
+};
+
+/**
+ * Reader side of a SharedMemoryWriter ring, exposed as a live IDataSource.
+ * Only one reader can attach to a ring at a time. Read() blocks up to the read timeout and
+ * returns AVERROR_EOF once the writer closed and all data has been read.
+ */
+class SharedMemoryDataSource : public IDataSource {
+public:
+    struct Stats {
+        uint64_t bytesRead = 0;
+        uint64_t waits = 0;             // Times Read() blocked on an empty ring
+        size_t bytesBuffered = 0;       // Written, not yet read
+    };
+
+    SharedMemoryDataSource();
+    ~SharedMemoryDataSource() override;
+
+    // Attach to a ring created by SharedMemoryWriter::Create(); fails if it does not exist yet
+    bool Open(const std::string& name);
+    void Close();
+
+    // IDataSource interface
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    int64_t GetSize() const override;
+    bool IsSeekable() const override;
+
+    void SetReadTimeout(int milliseconds);      // Maximum wait in Read(), 0 = never wait (default: 5000 ms)
+    bool IsOpen() const;
+    Stats GetStats() const;
+
+private:
+    SharedRingHeader* m_header;
+    uint8_t* m_data;
+    void* m_mapping;
+    void* m_dataEvent;
+    void* m_spaceEvent;
+    int64_t m_position;
+    int m_readTimeoutMs;
+    Stats m_stats;
+};
@@ -0,0 +1,194 @@
+#include "TemporalLayerFilter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// AV1 OBU types that carry (part of) a frame
+const int OBU_FRAME_HEADER = 3;
+const int OBU_TILE_GROUP = 4;
+const int OBU_FRAME = 6;
+const int OBU_REDUNDANT_FRAME_HEADER = 7;
+
+// HEVC NAL unit types below this are VCL (slice data)
+const int HEVC_FIRST_NON_VCL = 32;
+
+// -1 (all layers) compares above every layer
+int LayerLimit(int layer) {
+    return layer < 0 ? INT_MAX : layer;
+}
+
+// Temporal id of an HEVC NAL unit header, or -1 for a non-VCL unit
+int HevcNalTemporalId(const uint8_t* nal, size_t size) {
+    if (size < 2) {
+        return -1;
+    }
+    int type = (nal[0] >> 1) & 0x3f;
+    int temporalIdPlus1 = nal[1] & 0x07;
+    if (type >= HEVC_FIRST_NON_VCL || temporalIdPlus1 == 0) {
+        return -1;
+    }
+    return temporalIdPlus1 - 1;
+}
+
+bool ReadLeb128(const uint8_t* data, size_t size, size_t& position, uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < 8; i++) {
+        if (position >= size) {
+            return false;
+        }
+        uint8_t byte = data[position++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << (i * 7);
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TemporalLayerFilter::TemporalLayerFilter()
+    : m_codecId(AV_CODEC_ID_NONE)
+    , m_nalLengthSize(0)
+    , m_requestedLayer(-1)
+    , m_activeLayer(-1)
+{
+}
+
+void TemporalLayerFilter::Configure(const AVCodecParameters* codecParams) {
+    m_codecId = codecParams->codec_id;
+    m_nalLengthSize = 0;
+
+    // hvcC (MP4, Matroska) instead of Annex B: lengthSizeMinusOne in byte 21
+    if (m_codecId == AV_CODEC_ID_HEVC && codecParams->extradata_size >= 23 && codecParams->extradata[0] == 1) {
+        m_nalLengthSize = (codecParams->extradata[21] & 0x03) + 1;
+    }
+
+    // A new stream starts at a keyframe
+    m_activeLayer = m_requestedLayer;
+}
+
+void TemporalLayerFilter::SetMaxLayer(int layer) {
+    m_requestedLayer = std::max(-1, layer);
+}
+
+bool TemporalLayerFilter::Accept(const AVPacket* packet) {
+    int requested = m_requestedLayer;
+    if (requested != m_activeLayer &&
+        (LayerLimit(requested) < LayerLimit(m_activeLayer) || (packet->flags & AV_PKT_FLAG_KEY))) {
+        LOG_INFO("Temporal layer limit changed from ", m_activeLayer, " to ", requested, " (-1 = all)");
+        m_activeLayer = requested;
+    }
+
+    int temporalId = GetTemporalId(packet);
+    bool accepted = temporalId <= LayerLimit(m_activeLayer);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.highestLayer = std::max(m_stats.highestLayer, temporalId);
+    m_stats.activeLayer = m_activeLayer;
+    if (accepted) {
+        m_stats.framesPassed++;
+        m_stats.bytesPassed += packet->size;
+    } else {
+        m_stats.framesDropped++;
+        m_stats.bytesDropped += packet->size;
+    }
+    return accepted;
+}
+
+int TemporalLayerFilter::GetTemporalId(const AVPacket* packet) const {
+    if (!packet->data || packet->size <= 0) {
+        return -1;
+    }
+
+    switch (m_codecId) {
+        case AV_CODEC_ID_HEVC: return GetHevcTemporalId(packet->data, static_cast<size_t>(packet->size));
+        case AV_CODEC_ID_AV1: return GetAv1TemporalId(packet->data, static_cast<size_t>(packet->size));
+        default: return -1;
+    }
+}
+
+TemporalLayerStats TemporalLayerFilter::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void TemporalLayerFilter::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats = TemporalLayerStats();
+}
+
+int TemporalLayerFilter::GetHevcTemporalId(const uint8_t* data, size_t size) const {
+    // All VCL NAL units of an access unit share the temporal id; the first one decides
+    if (m_nalLengthSize > 0) {
+        size_t position = 0;
+        while (position + m_nalLengthSize <= size) {
+            size_t nalSize = 0;
+            for (int i = 0; i < m_nalLengthSize; i++) {
+                nalSize = (nalSize << 8) | data[position + i];
+            }
+            position += m_nalLengthSize;
+            if (nalSize > size - position) {
+                break;
+            }
+
+            int temporalId = HevcNalTemporalId(data + position, nalSize);
+            if (temporalId >= 0) {
+                return temporalId;
+            }
+            position += nalSize;
+        }
+        return -1;
+    }
+
+    // Annex B: the NAL header follows each 00 00 01 start code
+    for (size_t position = 0; position + 3 < size; position++) {
+        if (data[position] == 0 && data[position + 1] == 0 && data[position + 2] == 1) {
+            int temporalId = HevcNalTemporalId(data + position + 3, size - position - 3);
+            if (temporalId >= 0) {
+                return temporalId;
+            }
+            position += 2;
+        }
+    }
+    return -1;
+}
+
+int TemporalLayerFilter::GetAv1TemporalId(const uint8_t* data, size_t size) const {
+    // Low overhead bitstream format: the lowest layer of any frame in the temporal unit decides,
+    // so a unit is only dropped when none of its frames is needed
+    int temporalId = -1;
+    size_t position = 0;
+    while (position < size) {
+        uint8_t header = data[position++];
+        int type = (header >> 3) & 0x0f;
+        bool hasExtension = (header & 0x04) != 0;
+        bool hasSize = (header & 0x02) != 0;
+
+        int obuTemporalId = -1;
+        if (hasExtension) {
+            if (position >= size) {
+                break;
+            }
+            obuTemporalId = data[position++] >> 5;
+        }
+
+        uint64_t obuSize = size - position;
+        if (hasSize && !ReadLeb128(data, size, position, obuSize)) {
+            break;
+        }
+        if (obuSize > size - position) {
+            break;
+        }
+
+        bool frame = type == OBU_FRAME_HEADER || type == OBU_TILE_GROUP || type == OBU_FRAME ||
+                     type == OBU_REDUNDANT_FRAME_HEADER;
+        if (frame && obuTemporalId >= 0 && (temporalId < 0 || obuTemporalId < temporalId)) {
+            temporalId = obuTemporalId;
+        }
+        position += static_cast<size_t>(obuSize);
+    }
+    return temporalId;
+}
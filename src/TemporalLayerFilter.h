@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "../include/VideoCapture.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Drops packets above a temporal layer before they reach the decoder, for streams encoded
+ * with temporal scalability. Lower layers never reference higher ones, so the remaining
+ * packets form a valid stream at a fraction of the frame rate and decode cost.
+ *
+ * The layer of a packet is read from its headers: nuh_temporal_id_plus1 of the first VCL
+ * NAL unit for HEVC (Annex B or length-prefixed), the temporal_id of the OBU extension
+ * headers for AV1. Packets without layer information (other codecs, AV1 without extension
+ * headers, parameter-set-only packets) always pass.
+ *
+ * Lowering the layer takes effect with the next packet. Raising it waits for a keyframe,
+ * because frames of the added layers may reference frames that were dropped before it.
+ * SetMaxLayer() and GetStats() can be called from any thread, Accept() from the decoding thread.
+ */
+class TemporalLayerFilter {
+public:
+    TemporalLayerFilter();
+
+    // Prepare for a stream (codec and NAL length size); statistics are kept
+    void Configure(const AVCodecParameters* codecParams);
+
+    // Highest temporal layer to decode, 0 = base layer only, -1 = all layers
+    void SetMaxLayer(int layer);
+    int GetMaxLayer() const { return m_requestedLayer; }
+
+    // Return false if the packet belongs to a layer above the active limit
+    bool Accept(const AVPacket* packet);
+
+    // Temporal layer of a packet, -1 if it carries none
+    int GetTemporalId(const AVPacket* packet) const;
+
+    TemporalLayerStats GetStats() const;
+    void ResetStats();
+
+private:
+    AVCodecID m_codecId;
+    int m_nalLengthSize;                // HEVC: 0 for Annex B start codes, else hvcC length size
+    std::atomic<int> m_requestedLayer;
+    int m_activeLayer;                  // Limit in effect, follows m_requestedLayer at keyframes
+
+    TemporalLayerStats m_stats;
+    mutable std::mutex m_statsMutex;
+
+    int GetHevcTemporalId(const uint8_t* data, size_t size) const;
+    int GetAv1TemporalId(const uint8_t* data, size_t size) const;
+};
@@ -0,0 +1,320 @@
+#include "TimeShiftBuffer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+TimeShiftBuffer::TimeShiftBuffer()
+    : m_storage(nullptr)
+    , m_capacity(0)
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+    , m_firstSequence(0)
+    , m_cursor(0)
+    , m_writeOffset(0)
+    , m_windowSeconds(0.0)
+    , m_timeBase{0, 1}
+    , m_streamIndex(0)
+{
+}
+
+TimeShiftBuffer::~TimeShiftBuffer() {
+    Close();
+}
+
+bool TimeShiftBuffer::Initialize(double windowSeconds, size_t maxBytes, AVRational timeBase, const std::string& spillPath) {
+    Close();
+
+    if (windowSeconds <= 0.0 || maxBytes == 0 || timeBase.den == 0) {
+        LOG_ERROR("TimeShiftBuffer::Initialize - invalid window (", windowSeconds, " s, ", maxBytes, " bytes)");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (spillPath.empty()) {
+        m_heapStorage.resize(maxBytes);
+        m_storage = m_heapStorage.data();
+    } else if (!MapSpillFile(spillPath, maxBytes)) {
+        return false;
+    }
+
+    m_capacity = maxBytes;
+    m_windowSeconds = windowSeconds;
+    m_timeBase = timeBase;
+
+    LOG_INFO("Time-shift buffer enabled: ", windowSeconds, " seconds, ", maxBytes, " bytes",
+             (spillPath.empty() ? "" : " (memory-mapped: "), spillPath, (spillPath.empty() ? "" : ")"));
+    return true;
+}
+
+void TimeShiftBuffer::Close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+#ifdef _WIN32
+    if (m_mappingHandle) {
+        UnmapViewOfFile(m_storage);
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle) {
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_fileHandle = nullptr;
+    }
+#endif
+
+    m_heapStorage.clear();
+    m_heapStorage.shrink_to_fit();
+    m_storage = nullptr;
+    m_capacity = 0;
+
+    m_entries.clear();
+    m_keyframes.clear();
+    m_firstSequence = 0;
+    m_cursor = 0;
+    m_writeOffset = 0;
+}
+
+void TimeShiftBuffer::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_firstSequence += m_entries.size();
+    m_cursor = m_firstSequence;
+    m_entries.clear();
+    m_keyframes.clear();
+}
+
+bool TimeShiftBuffer::Push(const AVPacket* packet, bool followLive) {
+    if (!packet || packet->size <= 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_storage) {
+        return false;
+    }
+
+    if (static_cast<size_t>(packet->size) > m_capacity) {
+        LOG_WARNING("TimeShiftBuffer::Push - packet of ", packet->size, " bytes exceeds ring capacity");
+        return false;
+    }
+
+    const bool atLiveEdge = followLive && m_cursor == m_firstSequence + m_entries.size();
+
+    Entry entry;
+    entry.offset = m_writeOffset;
+    entry.size = packet->size;
+    entry.pts = packet->pts;
+    entry.dts = packet->dts;
+    entry.duration = packet->duration;
+    entry.flags = packet->flags;
+
+    // Make room for the payload
+    while (!m_entries.empty() && (m_writeOffset + entry.size - m_entries.front().offset) > m_capacity) {
+        EvictOldestGop();
+    }
+
+    // Enforce the time window, keeping at least the newest GOP
+    double newestTime = EntryTime(entry);
+    while (m_keyframes.size() > 1 && newestTime - EntryTime(m_entries.front()) > m_windowSeconds) {
+        EvictOldestGop();
+    }
+
+    CopyIn(m_writeOffset, packet->data, packet->size);
+    m_writeOffset += entry.size;
+
+    uint64_t sequence = m_firstSequence + m_entries.size();
+    m_entries.push_back(entry);
+    if (entry.flags & AV_PKT_FLAG_KEY) {
+        m_keyframes.push_back(sequence);
+    }
+    m_streamIndex = packet->stream_index;
+
+    if (atLiveEdge || m_cursor < m_firstSequence) {
+        m_cursor = atLiveEdge ? sequence + 1 : m_firstSequence;
+    }
+
+    return true;
+}
+
+bool TimeShiftBuffer::ReadPacket(AVPacket* packet) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_cursor < m_firstSequence) {
+        // Cursor fell out of the window; resume at the oldest retained keyframe
+        m_cursor = m_firstSequence;
+    }
+
+    uint64_t index = m_cursor - m_firstSequence;
+    if (index >= m_entries.size()) {
+        return false;
+    }
+
+    const Entry& entry = m_entries[index];
+    if (av_new_packet(packet, entry.size) < 0) {
+        LOG_ERROR("TimeShiftBuffer::ReadPacket - failed to allocate packet");
+        return false;
+    }
+
+    CopyOut(entry.offset, packet->data, entry.size);
+    packet->pts = entry.pts;
+    packet->dts = entry.dts;
+    packet->duration = entry.duration;
+    packet->flags = entry.flags;
+    packet->stream_index = m_streamIndex;
+    packet->pos = -1;
+
+    m_cursor++;
+    return true;
+}
+
+bool TimeShiftBuffer::SeekToTime(double timeInSeconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_keyframes.empty()) {
+        return false;
+    }
+
+    // Last keyframe at or before the requested time
+    auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), timeInSeconds,
+        [this](double time, uint64_t sequence) {
+            return time < EntryTime(m_entries[sequence - m_firstSequence]);
+        });
+
+    if (it == m_keyframes.begin()) {
+        LOG_DEBUG("TimeShiftBuffer::SeekToTime - ", timeInSeconds, " is before the rewind window");
+        return false;
+    }
+
+    const Entry& last = m_entries.back();
+    if (timeInSeconds > EntryTime(last) + static_cast<double>(last.duration) * av_q2d(m_timeBase)) {
+        LOG_DEBUG("TimeShiftBuffer::SeekToTime - ", timeInSeconds, " is beyond the live edge");
+        return false;
+    }
+
+    m_cursor = *(--it);
+    LOG_DEBUG("TimeShiftBuffer::SeekToTime - cursor at keyframe ", EntryTime(m_entries[m_cursor - m_firstSequence]), " seconds");
+    return true;
+}
+
+bool TimeShiftBuffer::SeekToLive() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_keyframes.empty()) {
+        m_cursor = m_firstSequence + m_entries.size();
+        return false;
+    }
+
+    // Restart from the newest keyframe so the decoder can catch up to the live edge immediately
+    m_cursor = m_keyframes.back();
+    return true;
+}
+
+bool TimeShiftBuffer::IsAtLiveEdge() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cursor >= m_firstSequence + m_entries.size();
+}
+
+double TimeShiftBuffer::GetStartTime() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.empty() ? 0.0 : EntryTime(m_entries.front());
+}
+
+double TimeShiftBuffer::GetEndTime() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.empty() ? 0.0 : EntryTime(m_entries.back());
+}
+
+size_t TimeShiftBuffer::GetBytesUsed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.empty() ? 0 : static_cast<size_t>(m_writeOffset - m_entries.front().offset);
+}
+
+size_t TimeShiftBuffer::GetPacketCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+bool TimeShiftBuffer::MapSpillFile(const std::string& spillPath, size_t size) {
+#ifdef _WIN32
+    std::wstring wpath;
+    int wlen = MultiByteToWideChar(CP_UTF8, 0, spillPath.c_str(), -1, nullptr, 0);
+    if (wlen > 0) {
+        wpath.resize(wlen);
+        MultiByteToWideChar(CP_UTF8, 0, spillPath.c_str(), -1, &wpath[0], wlen);
+    }
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("TimeShiftBuffer - failed to create spill file: ", spillPath);
+        return false;
+    }
+
+    uint64_t mappingSize = static_cast<uint64_t>(size);
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(mappingSize >> 32),
+                                        static_cast<DWORD>(mappingSize & 0xFFFFFFFF), nullptr);
+    if (!mapping) {
+        LOG_ERROR("TimeShiftBuffer - failed to map spill file: ", spillPath);
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        LOG_ERROR("TimeShiftBuffer - failed to map view of spill file: ", spillPath);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_storage = static_cast<uint8_t*>(view);
+    return true;
+#else
+    LOG_ERROR("TimeShiftBuffer - spill files are only supported on Windows: ", spillPath);
+    return false;
+#endif
+}
+
+void TimeShiftBuffer::EvictOldestGop() {
+    // Drop the front entry, then everything up to the next keyframe
+    do {
+        if (!m_keyframes.empty() && m_keyframes.front() == m_firstSequence) {
+            m_keyframes.pop_front();
+        }
+        m_entries.pop_front();
+        m_firstSequence++;
+    } while (!m_entries.empty() && !(m_entries.front().flags & AV_PKT_FLAG_KEY));
+}
+
+void TimeShiftBuffer::CopyIn(uint64_t offset, const uint8_t* data, int size) {
+    size_t position = static_cast<size_t>(offset % m_capacity);
+    size_t first = std::min(static_cast<size_t>(size), m_capacity - position);
+    memcpy(m_storage + position, data, first);
+    if (first < static_cast<size_t>(size)) {
+        memcpy(m_storage, data + first, size - first);
+    }
+}
+
+void TimeShiftBuffer::CopyOut(uint64_t offset, uint8_t* data, int size) const {
+    size_t position = static_cast<size_t>(offset % m_capacity);
+    size_t first = std::min(static_cast<size_t>(size), m_capacity - position);
+    memcpy(data, m_storage + position, first);
+    if (first < static_cast<size_t>(size)) {
+        memcpy(data + first, m_storage, size - first);
+    }
+}
+
+double TimeShiftBuffer::EntryTime(const Entry& entry) const {
+    int64_t timestamp = entry.pts != AV_NOPTS_VALUE ? entry.pts : entry.dts;
+    if (timestamp == AV_NOPTS_VALUE) {
+        return 0.0;
+    }
+    return static_cast<double>(timestamp) * av_q2d(m_timeBase);
+}
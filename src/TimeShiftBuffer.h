@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Rewind window for live sources.
+ * Retains the last N seconds of compressed packets in a bounded byte ring, indexed by
+ * keyframe and time, with a read cursor that can be moved anywhere inside the window.
+ * The ring lives on the heap or, when a spill path is given, in a memory-mapped file so
+ * long windows do not have to stay resident in RAM.
+ * Eviction always drops whole GOPs, so the window starts on a keyframe.
+ * Thread-safe for concurrent pushing and reading.
+ */
+class TimeShiftBuffer {
+public:
+    TimeShiftBuffer();
+    ~TimeShiftBuffer();
+
+    /**
+     * Allocate the ring.
+     * @param windowSeconds How much history to retain
+     * @param maxBytes Capacity of the packet ring in bytes
+     * @param timeBase Time base of the packets that will be pushed
+     * @param spillPath Optional file to back the ring with (deleted on close)
+     * @return true on success
+     */
+    bool Initialize(double windowSeconds, size_t maxBytes, AVRational timeBase, const std::string& spillPath = "");
+    void Close();
+    void Clear();
+
+    /**
+     * Append a live packet, evicting the oldest GOPs if the window or capacity is exceeded.
+     * @param followLive Keep a cursor at the live edge there (the caller hands the packet on
+     *                   itself); false leaves the cursor on the new packet so ReadPacket() returns it
+     */
+    bool Push(const AVPacket* packet, bool followLive = true);
+
+    /**
+     * Read the packet at the cursor and advance it.
+     * @return false if the cursor is at the live edge
+     */
+    bool ReadPacket(AVPacket* packet);
+
+    // Cursor control
+    bool SeekToTime(double timeInSeconds);
+    bool SeekToLive();
+    bool IsAtLiveEdge() const;
+
+    // Window status
+    double GetStartTime() const;
+    double GetEndTime() const;
+    size_t GetBytesUsed() const;
+    size_t GetPacketCount() const;
+
+private:
+    struct Entry {
+        uint64_t offset;
+        int size;
+        int64_t pts;
+        int64_t dts;
+        int64_t duration;
+        int flags;
+    };
+
+    // Ring storage (heap or mapped view)
+    std::vector<uint8_t> m_heapStorage;
+    uint8_t* m_storage;
+    size_t m_capacity;
+    void* m_fileHandle;
+    void* m_mappingHandle;
+
+    std::deque<Entry> m_entries;
+    std::deque<uint64_t> m_keyframes;   // sequence numbers of keyframe entries
+    uint64_t m_firstSequence;           // sequence number of m_entries.front()
+    uint64_t m_cursor;                  // sequence number of the next packet to read
+    uint64_t m_writeOffset;
+
+    double m_windowSeconds;
+    AVRational m_timeBase;
+    int m_streamIndex;
+    mutable std::mutex m_mutex;
+
+    bool MapSpillFile(const std::string& spillPath, size_t size);
+    void EvictOldestGop();
+    void CopyIn(uint64_t offset, const uint8_t* data, int size);
+    void CopyOut(uint64_t offset, uint8_t* data, int size) const;
+    double EntryTime(const Entry& entry) const;
+};
@@ -1,326 +1,1813 @@
-#include "../include/VideoCapture.h"
-#include "VideoDemuxer.h"
-#include "VideoDecoder.h"
-#include "HardwareDecoder.h"
-#include "Logger.h"
-#include "FFmpegInitializer.h"
-
-extern "C" {
-#include <libavcodec/avcodec.h>
-}
-
-// Static member initialization
-ID3D11Device* VideoCapture::s_d3dDevice = nullptr;
-bool VideoCapture::s_initialized = false;
-
-VideoCapture::VideoCapture()
-    : m_opened(false)
-    , m_eof(false)
-    , m_frameCount(0)
-{
-}
-
-VideoCapture::~VideoCapture() {
-    release();
-}
-
-bool VideoCapture::Initialize(ID3D11Device* device) {
-    if (s_initialized) {
-        return true;
-    }
-
-    if (!device) {
-        LOG_ERROR("D3D11 device is required for VideoCapture initialization");
-        return false;
-    }
-
-    s_d3dDevice = device;
-    s_d3dDevice->AddRef(); // Keep reference to device
-
-    // Initialize FFmpeg and hardware decoder detection with D3D11 device
-    static FFmpegInitializer ffmpegInit;
-    if (!ffmpegInit.Initialize(s_d3dDevice)) {
-        LOG_ERROR("Failed to initialize FFmpeg");
-        return false;
-    }
-
-    s_initialized = true;
-    LOG_INFO("VideoCapture initialized successfully");
-    return true;
-}
-
-bool VideoCapture::open(const std::string& filename) {
-    if (!s_initialized) {
-        LOG_ERROR("VideoCapture::Initialize() must be called before opening files");
-        return false;
-    }
-
-    // Close any previously opened file
-    release();
-
-    // Create demuxer
-    m_demuxer = std::make_unique<VideoDemuxer>();
-    if (!m_demuxer->Open(filename)) {
-        LOG_ERROR("Failed to open video file: ", filename);
-        return false;
-    }
-
-    // Initialize decoder
-    if (!InitializeDecoder()) {
-        LOG_ERROR("Failed to initialize hardware decoder");
-        release();
-        return false;
-    }
-
-    // Calculate approximate frame count
-    double duration = m_demuxer->GetDuration();
-    double frameRate = m_demuxer->GetFrameRate();
-    if (duration > 0.0 && frameRate > 0.0) {
-        m_frameCount = static_cast<int64_t>(duration * frameRate);
-    } else {
-        m_frameCount = 0;
-    }
-
-    m_opened = true;
-    m_eof = false;
-    LOG_INFO("Video file opened successfully");
-    return true;
-}
-
-bool VideoCapture::open(IDataSource* dataSource, const std::string& format) {
-    if (!s_initialized) {
-        LOG_ERROR("VideoCapture::Initialize() must be called before opening data sources");
-        return false;
-    }
-
-    if (!dataSource) {
-        LOG_ERROR("Invalid data source");
-        return false;
-    }
-
-    // Close any previously opened source
-    release();
-
-    // Create demuxer
-    m_demuxer = std::make_unique<VideoDemuxer>();
-    if (!m_demuxer->Open(dataSource, format)) {
-        LOG_ERROR("Failed to open data source");
-        return false;
-    }
-
-    // Initialize decoder
-    if (!InitializeDecoder()) {
-        LOG_ERROR("Failed to initialize hardware decoder");
-        release();
-        return false;
-    }
-
-    // Calculate approximate frame count
-    double duration = m_demuxer->GetDuration();
-    double frameRate = m_demuxer->GetFrameRate();
-    if (duration > 0.0 && frameRate > 0.0) {
-        m_frameCount = static_cast<int64_t>(duration * frameRate);
-    } else {
-        m_frameCount = 0;
-    }
-
-    m_opened = true;
-    m_eof = false;
-    LOG_INFO("Data source opened successfully");
-    return true;
-}
-
-bool VideoCapture::read(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format) {
-    if (!m_opened || m_eof) {
-        return false;
-    }
-
-    if (!DecodeNextFrame()) {
-        m_eof = true;
-        return false;
-    }
-
-    if (!m_currentFrame || !m_currentFrame->valid) {
-        return false;
-    }
-
-    // Return texture reference
-    *outTexture = m_currentFrame->texture.Get();
-    if (*outTexture) {
-        (*outTexture)->AddRef(); // Caller must release
-    }
-
-    isYUV = m_currentFrame->isYUV;
-    format = m_currentFrame->format;
-
-    return true;
-}
-
-double VideoCapture::get(int propId) const {
-    if (!m_opened) {
-        return 0.0;
-    }
-
-    switch (propId) {
-        case CAP_PROP_FRAME_WIDTH:
-            return static_cast<double>(m_demuxer->GetWidth());
-
-        case CAP_PROP_FRAME_HEIGHT:
-            return static_cast<double>(m_demuxer->GetHeight());
-
-        case CAP_PROP_FPS:
-            return m_demuxer->GetFrameRate();
-
-        case CAP_PROP_FRAME_COUNT:
-            return static_cast<double>(m_frameCount);
-
-        case CAP_PROP_POS_MSEC:
-            if (m_currentFrame && m_currentFrame->valid) {
-                return m_currentFrame->presentationTime * 1000.0;
-            }
-            return 0.0;
-
-        case CAP_PROP_POS_FRAMES:
-            if (m_currentFrame && m_currentFrame->valid) {
-                double frameRate = m_demuxer->GetFrameRate();
-                if (frameRate > 0.0) {
-                    return m_currentFrame->presentationTime * frameRate;
-                }
-            }
-            return 0.0;
-
-        case CAP_PROP_POS_AVI_RATIO:
-            if (m_currentFrame && m_currentFrame->valid) {
-                double duration = m_demuxer->GetDuration();
-                if (duration > 0.0) {
-                    return m_currentFrame->presentationTime / duration;
-                }
-            }
-            return 0.0;
-
-        default:
-            LOG_WARNING("Unsupported property ID: ", propId);
-            return 0.0;
-    }
-}
-
-bool VideoCapture::set(int propId, double value) {
-    if (!m_opened) {
-        return false;
-    }
-
-    switch (propId) {
-        case CAP_PROP_POS_MSEC: {
-            double timeInSeconds = value / 1000.0;
-            if (m_demuxer->SeekToTime(timeInSeconds)) {
-                m_decoder->Flush();
-                m_eof = false;
-                return true;
-            }
-            return false;
-        }
-
-        case CAP_PROP_POS_FRAMES: {
-            int64_t frameNumber = static_cast<int64_t>(value);
-            if (m_demuxer->SeekToFrame(frameNumber)) {
-                m_decoder->Flush();
-                m_eof = false;
-                return true;
-            }
-            return false;
-        }
-
-        case CAP_PROP_POS_AVI_RATIO: {
-            double duration = m_demuxer->GetDuration();
-            if (duration > 0.0) {
-                double timeInSeconds = value * duration;
-                if (m_demuxer->SeekToTime(timeInSeconds)) {
-                    m_decoder->Flush();
-                    m_eof = false;
-                    return true;
-                }
-            }
-            return false;
-        }
-
-        default:
-            LOG_WARNING("Unsupported property ID for set: ", propId);
-            return false;
-    }
-}
-
-bool VideoCapture::isOpened() const {
-    return m_opened;
-}
-
-void VideoCapture::release() {
-    m_currentFrame.reset();
-    m_decoder.reset();
-    m_demuxer.reset();
-    m_opened = false;
-    m_eof = false;
-    m_frameCount = 0;
-}
-
-bool VideoCapture::InitializeDecoder() {
-    // Get decoder info
-    DecoderInfo decoderInfo = HardwareDecoder::GetBestDecoder(m_demuxer->GetCodecID());
-    if (decoderInfo.type != DecoderType::D3D11VA || !decoderInfo.available) {
-        LOG_ERROR("Hardware decoder not available - only hardware decoding is supported");
-        return false;
-    }
-
-    // Create decoder
-    m_decoder = std::make_unique<VideoDecoder>();
-    if (!m_decoder->Initialize(m_demuxer->GetCodecParameters(), decoderInfo, s_d3dDevice, m_demuxer->GetTimeBase())) {
-        LOG_ERROR("Failed to initialize video decoder");
-        return false;
-    }
-
-    // Create frame holder
-    m_currentFrame = std::make_unique<DecodedFrame>();
-
-    return true;
-}
-
-bool VideoCapture::DecodeNextFrame() {
-    if (!m_decoder || !m_demuxer) {
-        return false;
-    }
-
-    // Try to decode a frame (may need multiple packets)
-    const int MAX_ATTEMPTS = 100; // Prevent infinite loops
-    int attempts = 0;
-
-    while (attempts++ < MAX_ATTEMPTS) {
-        // Try to receive a frame first (decoder may have buffered frames)
-        if (m_decoder->ReceiveFrame(*m_currentFrame)) {
-            if (m_currentFrame->valid) {
-                return true; // Successfully decoded a frame
-            }
-        }
-
-        // Need more data, read a packet
-        AVPacket packet;
-        if (!m_demuxer->ReadFrame(&packet)) {
-            // End of file or error
-            // Flush decoder to get remaining frames
-            m_decoder->SendPacket(nullptr);
-            if (m_decoder->ReceiveFrame(*m_currentFrame) && m_currentFrame->valid) {
-                return true;
-            }
-            return false;
-        }
-
-        // Send packet to decoder
-        if (!m_decoder->SendPacket(&packet)) {
-            av_packet_unref(&packet);
-            return false;
-        }
-
-        av_packet_unref(&packet);
-    }
-
-    LOG_ERROR("Failed to decode frame after ", MAX_ATTEMPTS, " attempts");
-    return false;
-}
\ No newline at end of file
+#include "../include/VideoCapture.h"
+#include "VideoDemuxer.h"
+#include "VideoDecoder.h"
+#include "HardwareDecoder.h"
+#include "Logger.h"
+#include "FFmpegInitializer.h"
+#include "TimeShiftBuffer.h"
+#include "ProbeCache.h"
+#include "CaptureWatchdog.h"
+#include "TemporalLayerFilter.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// Static member initialization
+ID3D11Device* VideoCapture::s_d3dDevice = nullptr;
+bool VideoCapture::s_initialized = false;
+std::shared_ptr<ProbeCache> VideoCapture::s_probeCache;
+std::mutex VideoCapture::s_probeCacheMutex;
+
+namespace {
+
+// Pass a new rendition's or session's parameter sets to a reused decoder with the first packet
+void AttachNewExtradata(AVPacket* packet, const AVCodecParameters* codecParams) {
+    if (!packet || codecParams->extradata_size <= 0) {
+        return;
+    }
+    uint8_t* sideData = av_packet_new_side_data(packet, AV_PKT_DATA_NEW_EXTRADATA, codecParams->extradata_size);
+    if (sideData) {
+        memcpy(sideData, codecParams->extradata, codecParams->extradata_size);
+    }
+}
+
+void BuildStreamOptions(const std::string& url, const StreamOptions& options, AVDictionary** dictionary) {
+    bool rtsp = url.compare(0, 7, "rtsp://") == 0 || url.compare(0, 8, "rtsps://") == 0;
+
+    if (rtsp) {
+        switch (options.transport) {
+            case StreamTransport::Tcp:
+                av_dict_set(dictionary, "rtsp_transport", "tcp", 0);
+                break;
+            case StreamTransport::Udp:
+                av_dict_set(dictionary, "rtsp_transport", "udp", 0);
+                break;
+            case StreamTransport::Auto:
+                // FFmpeg's default: UDP first, TCP if the server refuses it or no packets arrive
+                break;
+        }
+        av_dict_set_int(dictionary, "reorder_queue_size", options.reorderQueueSize, 0);
+    }
+
+    if (options.transport != StreamTransport::Tcp) {
+        av_dict_set_int(dictionary, "buffer_size", 4 * 1024 * 1024, 0); // UDP socket buffer
+    }
+
+    av_dict_set_int(dictionary, "timeout", static_cast<int64_t>(options.timeoutMs) * 1000, 0);
+    av_dict_set_int(dictionary, "max_delay", static_cast<int64_t>(options.maxDelayMs) * 1000, 0);
+
+    if (options.lowLatency) {
+        av_dict_set(dictionary, "fflags", "nobuffer", 0);
+        av_dict_set_int(dictionary, "probesize", 256 * 1024, 0);
+        av_dict_set_int(dictionary, "analyzeduration", 500000, 0);
+    }
+}
+
+// Frames the decoder drops at a tier; KeyframesOnly is also filtered before the decoder
+AVDiscard FrameSkipFor(DecodeTier tier) {
+    switch (tier) {
+        case DecodeTier::Full: return AVDISCARD_DEFAULT;
+        case DecodeTier::SkipNonReference: return AVDISCARD_NONREF;
+        case DecodeTier::SkipBidirectional: return AVDISCARD_BIDIR;
+        case DecodeTier::KeyframesOnly: return AVDISCARD_NONKEY;
+    }
+    return AVDISCARD_DEFAULT;
+}
+
+const char* TierName(DecodeTier tier) {
+    switch (tier) {
+        case DecodeTier::Full: return "full";
+        case DecodeTier::SkipNonReference: return "skip non-reference";
+        case DecodeTier::SkipBidirectional: return "skip bidirectional";
+        case DecodeTier::KeyframesOnly: return "keyframes only";
+    }
+    return "unknown";
+}
+
+DemuxDeadlines ToDemuxDeadlines(const IoDeadlines& ioDeadlines) {
+    DemuxDeadlines deadlines;
+    deadlines.openMs = ioDeadlines.openMs;
+    deadlines.probeMs = ioDeadlines.probeMs;
+    deadlines.readMs = ioDeadlines.readMs;
+    deadlines.seekMs = ioDeadlines.seekMs;
+    return deadlines;
+}
+
+} // namespace
+
+// Background state of switchSource()
+struct VideoCapture::SourceSwitch {
+    std::function<bool(VideoDemuxer&)> openSource;
+    std::unique_ptr<VideoDemuxer> demuxer;
+    std::unique_ptr<VideoDecoder> decoder;      // Only when the current decoder cannot be reused
+    AVCodecID codecId = AV_CODEC_ID_NONE;       // Current decoder at switchSource(), read() may replace it
+    int profile = -1;
+    DemuxDeadlines deadlines;                   // I/O deadlines at switchSource()
+    AVPacket* keyframe = nullptr;               // First packet fed from the new source
+    double switchTime = 0.0;                    // Presentation time of that keyframe (seconds)
+    std::atomic<double> playbackTime{ -1.0 };   // Last frame returned by read()
+    std::atomic<bool> ready{ false };
+    std::atomic<bool> failed{ false };
+    std::atomic<bool> cancelled{ false };
+    std::thread thread;
+
+    ~SourceSwitch() {
+        av_packet_free(&keyframe);
+    }
+};
+
+// Background decode thread and frame queue of startAsync()
+struct VideoCapture::AsyncDecode {
+    static const int PROPERTY_COUNT = CAP_PROP_FRAME_COUNT + 1;
+
+    struct Entry {
+        DecodedFrame frame;
+        double properties[PROPERTY_COUNT] = {};     // get() values once this frame is handed out
+    };
+
+    std::deque<Entry> queue;
+    size_t queueDepth = 3;
+    FrameDelivery delivery = FrameDelivery::Sequential;
+    int64_t overwritten = 0;                        // Latest mode: frames replaced before read
+    bool ended = false;                             // Decoding stopped at end of stream or error
+    bool stopping = false;
+    double delivered[PROPERTY_COUNT] = {};          // Properties of the last frame handed out
+    HANDLE readyEvent = nullptr;                    // Manual-reset: queue not empty, or ended
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread thread;
+
+    ~AsyncDecode() {
+        if (readyEvent) {
+            CloseHandle(readyEvent);
+        }
+    }
+};
+
+// Reads the live source into the time-shift window while read() replays older packets
+struct VideoCapture::LiveIngest {
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+struct OpenHandle::State {
+    std::atomic<bool> cancelled{false};             // Interrupt flag handed to the demuxer
+    OpenStatus status = OpenStatus::Pending;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::thread thread;
+};
+
+OpenStatus OpenHandle::wait(int timeoutMs) const {
+    if (!m_state) {
+        return OpenStatus::Failed;
+    }
+
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    auto finished = [this]() { return m_state->status != OpenStatus::Pending; };
+    if (timeoutMs < 0) {
+        m_state->done.wait(lock, finished);
+    } else {
+        m_state->done.wait_for(lock, std::chrono::milliseconds(timeoutMs), finished);
+    }
+    return m_state->status;
+}
+
+OpenStatus OpenHandle::status() const {
+    if (!m_state) {
+        return OpenStatus::Failed;
+    }
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->status;
+}
+
+void OpenHandle::cancel() {
+    if (m_state) {
+        m_state->cancelled = true;
+    }
+}
+
+struct VideoCapture::DecodeErrors {
+    DecodeErrorPolicy policy;
+    DecodeErrorStats stats;                         // Guarded by mutex, read from any thread
+    int consecutive = 0;                            // Errors since the last good frame
+    bool recovering = false;
+    double lastGoodTime = -1.0;                     // Presentation time of the last good frame
+    mutable std::mutex mutex;
+};
+
+VideoCapture::VideoCapture()
+    : m_openInterrupt(nullptr)
+    , m_abortRequested(false)
+    , m_ioStatus(IoStatus::Ok)
+    , m_progress(std::make_unique<CaptureProgress>())
+    , m_skipToKeyframe(false)
+    , m_reconnectRequested(false)
+    , m_decodeErrors(std::make_unique<DecodeErrors>())
+    , m_requestedTier(DecodeTier::Full)
+    , m_activeTier(DecodeTier::Full)
+    , m_temporalFilter(std::make_unique<TemporalLayerFilter>())
+    , m_opened(false)
+    , m_eof(false)
+    , m_frameCount(0)
+    , m_seekTargetTime(-1.0)
+    , m_reconnectCount(0)
+{
+}
+
+VideoCapture::~VideoCapture() {
+    release();
+    m_watchdog.reset();
+}
+
+bool VideoCapture::Initialize(ID3D11Device* device) {
+    if (s_initialized) {
+        return true;
+    }
+
+    if (!device) {
+        LOG_ERROR("D3D11 device is required for VideoCapture initialization");
+        return false;
+    }
+
+    s_d3dDevice = device;
+    s_d3dDevice->AddRef(); // Keep reference to device
+
+    // Initialize FFmpeg and hardware decoder detection with D3D11 device
+    static FFmpegInitializer ffmpegInit;
+    if (!ffmpegInit.Initialize(s_d3dDevice)) {
+        LOG_ERROR("Failed to initialize FFmpeg");
+        return false;
+    }
+
+    s_initialized = true;
+    LOG_INFO("VideoCapture initialized successfully");
+    return true;
+}
+
+bool VideoCapture::EnableProbeCache(const std::string& directory) {
+    if (directory.empty()) {
+        LOG_ERROR("Probe cache directory is required");
+        return false;
+    }
+
+    // Demuxers hold their own reference, so replacing the cache never frees one in use
+    auto cache = std::make_shared<ProbeCache>(directory);
+    {
+        std::lock_guard<std::mutex> lock(s_probeCacheMutex);
+        s_probeCache = std::move(cache);
+    }
+    LOG_INFO("Probe cache enabled: ", directory);
+    return true;
+}
+
+bool VideoCapture::open(const std::string& filename) {
+    CancelPendingOpen();
+    return OpenFile(filename);
+}
+
+bool VideoCapture::open(IDataSource* dataSource, const std::string& format) {
+    CancelPendingOpen();
+    return OpenDataSource(dataSource, format);
+}
+
+bool VideoCapture::openStream(const std::string& url, const StreamOptions& options) {
+    CancelPendingOpen();
+    return OpenNetworkStream(url, options);
+}
+
+OpenHandle VideoCapture::openAsync(const std::string& filename) {
+    return StartAsyncOpen([this, filename]() { return OpenFile(filename); });
+}
+
+OpenHandle VideoCapture::openAsync(IDataSource* dataSource, const std::string& format) {
+    return StartAsyncOpen([this, dataSource, format]() { return OpenDataSource(dataSource, format); });
+}
+
+OpenHandle VideoCapture::openStreamAsync(const std::string& url, const StreamOptions& options) {
+    return StartAsyncOpen([this, url, options]() { return OpenNetworkStream(url, options); });
+}
+
+bool VideoCapture::OpenFile(const std::string& filename) {
+    if (!s_initialized) {
+        LOG_ERROR("VideoCapture::Initialize() must be called before opening files");
+        return false;
+    }
+
+    // Close any previously opened file
+    Close();
+    m_abortRequested = false;
+
+    // Create demuxer
+    m_demuxer = std::make_unique<VideoDemuxer>();
+    m_demuxer->SetProbeCache(GetProbeCache());
+    ConfigureDemuxer(*m_demuxer);
+    bool opened = m_demuxer->Open(filename);
+    UpdateIoStatus(*m_demuxer);
+    if (!opened) {
+        LOG_ERROR("Failed to open video file: ", filename);
+        Close();
+        return false;
+    }
+
+    // Initialize decoder
+    if (!InitializeDecoder()) {
+        LOG_ERROR("Failed to initialize hardware decoder");
+        Close();
+        return false;
+    }
+
+    UpdateFrameCount();
+
+    m_opened = true;
+    m_eof = false;
+    m_progress->ended = false;
+    LOG_INFO("Video file opened successfully");
+    return true;
+}
+
+bool VideoCapture::OpenDataSource(IDataSource* dataSource, const std::string& format) {
+    if (!s_initialized) {
+        LOG_ERROR("VideoCapture::Initialize() must be called before opening data sources");
+        return false;
+    }
+
+    if (!dataSource) {
+        LOG_ERROR("Invalid data source");
+        return false;
+    }
+
+    // Close any previously opened source
+    Close();
+    m_abortRequested = false;
+
+    // Create demuxer
+    m_demuxer = std::make_unique<VideoDemuxer>();
+    ConfigureDemuxer(*m_demuxer);
+    bool opened = m_demuxer->Open(dataSource, format);
+    UpdateIoStatus(*m_demuxer);
+    if (!opened) {
+        LOG_ERROR("Failed to open data source");
+        Close();
+        return false;
+    }
+
+    // Initialize decoder
+    if (!InitializeDecoder()) {
+        LOG_ERROR("Failed to initialize hardware decoder");
+        Close();
+        return false;
+    }
+
+    UpdateFrameCount();
+
+    m_opened = true;
+    m_eof = false;
+    m_progress->ended = false;
+    LOG_INFO("Data source opened successfully");
+    return true;
+}
+
+bool VideoCapture::OpenNetworkStream(const std::string& url, const StreamOptions& options) {
+    if (!s_initialized) {
+        LOG_ERROR("VideoCapture::Initialize() must be called before opening streams");
+        return false;
+    }
+
+    // Close any previously opened source
+    Close();
+    m_abortRequested = false;
+
+    m_streamUrl = url;
+    m_streamOptions = std::make_unique<StreamOptions>(options);
+
+    m_demuxer = OpenStreamDemuxer();
+    if (!m_demuxer) {
+        LOG_ERROR("Failed to open stream: ", url);
+        Close();
+        return false;
+    }
+
+    // Initialize decoder
+    if (!InitializeDecoder()) {
+        LOG_ERROR("Failed to initialize hardware decoder");
+        Close();
+        return false;
+    }
+
+    UpdateFrameCount();
+
+    m_opened = true;
+    m_eof = false;
+    m_progress->ended = false;
+    LOG_INFO("Stream opened successfully: ", url);
+    return true;
+}
+
+int VideoCapture::getReconnectCount() const {
+    return m_reconnectCount;
+}
+
+void VideoCapture::setIoDeadlines(const IoDeadlines& deadlines) {
+    m_ioDeadlines = deadlines;
+    if (!m_demuxer) {
+        return;
+    }
+
+    bool resume = SuspendAsync();
+    ConfigureDemuxer(*m_demuxer);
+    if (resume) {
+        ResumeAsync(false);
+    }
+}
+
+void VideoCapture::abort() {
+    // Whichever demuxer is current (it may be replaced by a reconnect) sees the shared flag.
+    // It stays set until the next public call starts, so a reconnect in progress stops too.
+    m_abortRequested = true;
+    {
+        std::lock_guard<std::mutex> lock(m_reconnectMutex);
+    }
+    m_reconnectWake.notify_all();
+}
+
+IoStatus VideoCapture::getLastIoStatus() const {
+    return m_ioStatus;
+}
+
+void VideoCapture::setDecodeErrorPolicy(const DecodeErrorPolicy& policy) {
+    bool resume = SuspendAsync();
+    m_decodeErrors->policy = policy;
+    if (m_decoder) {
+        m_decoder->SetErrorConcealment(policy.concealErrors);
+    }
+    if (resume) {
+        ResumeAsync(false);
+    }
+}
+
+DecodeErrorStats VideoCapture::getDecodeErrorStats() const {
+    std::lock_guard<std::mutex> lock(m_decodeErrors->mutex);
+    return m_decodeErrors->stats;
+}
+
+void VideoCapture::setDecodeTier(DecodeTier tier) {
+    m_requestedTier = tier;
+}
+
+DecodeTier VideoCapture::getDecodeTier() const {
+    return m_activeTier;
+}
+
+void VideoCapture::setMaxTemporalLayer(int layer) {
+    m_temporalFilter->SetMaxLayer(layer);
+}
+
+int VideoCapture::getMaxTemporalLayer() const {
+    return m_temporalFilter->GetMaxLayer();
+}
+
+TemporalLayerStats VideoCapture::getTemporalLayerStats() const {
+    return m_temporalFilter->GetStats();
+}
+
+bool VideoCapture::enableWatchdog(const WatchdogOptions& options) {
+    if (options.sourceStallMs <= 0 && options.demuxerStallMs <= 0 && options.decoderStallMs <= 0 &&
+        options.consumerStallMs <= 0) {
+        LOG_ERROR("enableWatchdog() - no stage has a stall threshold");
+        return false;
+    }
+
+    // The reading thread takes recovery requests from the watchdog
+    bool resume = SuspendAsync();
+    m_watchdog = std::make_unique<CaptureWatchdog>(options, *m_progress, [this]() { abort(); });
+    m_watchdog->Start();
+    if (resume) {
+        ResumeAsync(false);
+    }
+
+    LOG_INFO("Watchdog enabled (source ", options.sourceStallMs, " ms, demuxer ", options.demuxerStallMs,
+             " ms, decoder ", options.decoderStallMs, " ms, consumer ", options.consumerStallMs, " ms)");
+    return true;
+}
+
+void VideoCapture::disableWatchdog() {
+    if (!m_watchdog) {
+        return;
+    }
+
+    bool resume = SuspendAsync();
+    m_watchdog.reset();
+    if (resume) {
+        ResumeAsync(false);
+    }
+}
+
+int64_t VideoCapture::getStallCount() const {
+    return m_watchdog ? m_watchdog->GetStallCount() : 0;
+}
+
+bool VideoCapture::read(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format) {
+    if (m_async) {
+        return DequeueFrame(outTexture, isYUV, format, true);
+    }
+
+    m_abortRequested = false;
+    if (!DecodeFrame()) {
+        return false;
+    }
+    m_progress->framesConsumed++;
+
+    // Return texture reference
+    *outTexture = m_currentFrame->texture.Get();
+    if (*outTexture) {
+        (*outTexture)->AddRef(); // Caller must release
+    }
+
+    isYUV = m_currentFrame->isYUV;
+    format = m_currentFrame->format;
+
+    return true;
+}
+
+bool VideoCapture::DecodeFrame() {
+    m_progress->decoding = true;
+    m_progress->decodeCalled = true;
+    RunRecovery();
+
+    // Recovery actions RunRecovery() can carry out for this source, for the watchdog
+    m_progress->reconnectable = m_opened && m_streamOptions;
+    m_progress->live = m_opened && (m_timeShift || m_streamOptions || m_demuxer->GetDuration() <= 0.0);
+
+    bool decoded = DecodeSourceFrame();
+
+    // The watchdog interrupted a stalled read so its recovery could run here; carry on after it
+    if (!decoded && m_ioStatus == IoStatus::Aborted && RunRecovery() && ResetAbort()) {
+        decoded = DecodeSourceFrame();
+    }
+
+    if (decoded) {
+        m_progress->framesDecoded++;
+    }
+    m_progress->ended = m_eof || !m_opened;
+    m_progress->decoding = false;
+    return decoded;
+}
+
+bool VideoCapture::DecodeSourceFrame() {
+    if (!m_opened || m_eof) {
+        return false;
+    }
+
+    m_ioStatus = IoStatus::Ok;
+    bool decoded = DecodeNextFrame();
+    if (!decoded && m_ioStatus != IoStatus::Ok) {
+        // Timed out or aborted: report it, the next read() continues the stream
+        return false;
+    }
+
+    // Hand over to a primed switchSource() target once this source reaches its keyframe (or ends)
+    if (m_sourceSwitch && SourceSwitchDue(decoded) && CompleteSourceSwitch()) {
+        decoded = DecodeNextFrame();
+    }
+
+    if (!decoded) {
+        if (m_ioStatus == IoStatus::Ok) {
+            m_eof = true;
+        }
+        return false;
+    }
+
+    // Frame-accurate seek: discard frames between the keyframe and the requested frame
+    const double SEEK_TOLERANCE = 0.0005; // Half a millisecond of timestamp rounding
+    while (m_seekTargetTime >= 0.0 && m_currentFrame && m_currentFrame->valid &&
+           m_currentFrame->presentationTime < m_seekTargetTime - SEEK_TOLERANCE) {
+        if (!DecodeNextFrame()) {
+            if (m_ioStatus == IoStatus::Ok) {
+                m_seekTargetTime = -1.0;
+                m_eof = true;
+            }
+            return false;
+        }
+    }
+    m_seekTargetTime = -1.0;
+
+    if (!m_currentFrame || !m_currentFrame->valid) {
+        return false;
+    }
+
+    if (m_sourceSwitch) {
+        m_sourceSwitch->playbackTime = m_currentFrame->presentationTime;
+    }
+
+    return true;
+}
+
+double VideoCapture::get(int propId) const {
+    if (!m_opened) {
+        return 0.0;
+    }
+
+    // With background decoding, report the frame last handed out rather than the decode position
+    if (m_async && propId >= 0 && propId < AsyncDecode::PROPERTY_COUNT && propId != CAP_PROP_FOURCC) {
+        return m_async->delivered[propId];
+    }
+
+    return GetProperty(propId);
+}
+
+double VideoCapture::GetProperty(int propId) const {
+    switch (propId) {
+        case CAP_PROP_FRAME_WIDTH:
+            return static_cast<double>(m_demuxer->GetWidth());
+
+        case CAP_PROP_FRAME_HEIGHT:
+            return static_cast<double>(m_demuxer->GetHeight());
+
+        case CAP_PROP_FPS:
+            return m_demuxer->GetFrameRate();
+
+        case CAP_PROP_FRAME_COUNT:
+            return static_cast<double>(m_frameCount);
+
+        case CAP_PROP_POS_MSEC:
+            if (m_currentFrame && m_currentFrame->valid) {
+                return m_currentFrame->presentationTime * 1000.0;
+            }
+            return 0.0;
+
+        case CAP_PROP_POS_FRAMES:
+            if (m_currentFrame && m_currentFrame->valid) {
+                return static_cast<double>(m_demuxer->GetFrameNumber(m_currentFrame->presentationTime));
+            }
+            return 0.0;
+
+        case CAP_PROP_POS_AVI_RATIO:
+            if (m_currentFrame && m_currentFrame->valid) {
+                double duration = m_demuxer->GetDuration();
+                if (duration > 0.0) {
+                    return m_currentFrame->presentationTime / duration;
+                }
+            }
+            return 0.0;
+
+        default:
+            LOG_WARNING("Unsupported property ID: ", propId);
+            return 0.0;
+    }
+}
+
+bool VideoCapture::set(int propId, double value) {
+    if (!m_opened) {
+        return false;
+    }
+
+    bool resume = SuspendAsync();
+    m_abortRequested = false;
+    bool result = SetProperty(propId, value);
+    UpdateIoStatus(*m_demuxer);
+    if (resume) {
+        ResumeAsync(result);
+    }
+    return result;
+}
+
+bool VideoCapture::SetProperty(int propId, double value) {
+    switch (propId) {
+        case CAP_PROP_POS_MSEC: {
+            double timeInSeconds = value / 1000.0;
+            if (m_timeShift) {
+                return SeekTimeShift(timeInSeconds);
+            }
+            if (m_demuxer->SeekToTime(timeInSeconds)) {
+                m_decoder->Flush();
+                m_eof = false;
+                m_seekTargetTime = -1.0;
+                return true;
+            }
+            return false;
+        }
+
+        case CAP_PROP_POS_FRAMES: {
+            int64_t frameNumber = static_cast<int64_t>(value);
+            if (m_timeShift) {
+                double frameRate = m_demuxer->GetFrameRate();
+                return frameRate > 0.0 && SeekTimeShift(frameNumber / frameRate);
+            }
+            if (m_demuxer->SeekToFrame(frameNumber)) {
+                m_decoder->Flush();
+                m_eof = false;
+                m_seekTargetTime = m_demuxer->GetFrameTime(frameNumber);
+                return true;
+            }
+            return false;
+        }
+
+        case CAP_PROP_POS_AVI_RATIO: {
+            double duration = m_demuxer->GetDuration();
+            if (duration > 0.0 && !m_timeShift) {
+                double timeInSeconds = value * duration;
+                if (m_demuxer->SeekToTime(timeInSeconds)) {
+                    m_decoder->Flush();
+                    m_eof = false;
+                    m_seekTargetTime = -1.0;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        default:
+            LOG_WARNING("Unsupported property ID for set: ", propId);
+            return false;
+    }
+}
+
+bool VideoCapture::isOpened() const {
+    return m_opened;
+}
+
+bool VideoCapture::enableTimeShift(double windowSeconds, size_t maxBytes, const std::string& spillPath) {
+    if (!m_opened) {
+        LOG_ERROR("Time-shift requires an opened source");
+        return false;
+    }
+
+    auto timeShift = std::make_unique<TimeShiftBuffer>();
+    if (!timeShift->Initialize(windowSeconds, maxBytes, m_demuxer->GetTimeBase(), spillPath)) {
+        LOG_ERROR("Failed to enable time-shift buffer");
+        return false;
+    }
+
+    bool resume = SuspendAsync();
+    StopLiveIngest(true);
+    m_timeShift = std::move(timeShift);
+    if (resume) {
+        ResumeAsync(false);
+    }
+    return true;
+}
+
+bool VideoCapture::seekToLive() {
+    if (!m_opened || !m_timeShift) {
+        return false;
+    }
+
+    if (m_timeShift->IsAtLiveEdge()) {
+        return true;
+    }
+
+    bool resume = SuspendAsync();
+    m_timeShift->SeekToLive();
+    m_decoder->Flush();
+    m_eof = false;
+    if (resume) {
+        ResumeAsync(true);
+    }
+    return true;
+}
+
+bool VideoCapture::isLive() const {
+    return m_opened && (!m_timeShift || m_timeShift->IsAtLiveEdge());
+}
+
+bool VideoCapture::switchSource(const std::string& filename) {
+    bool resume = SuspendAsync();
+    bool result = BeginSourceSwitch([filename](VideoDemuxer& demuxer) {
+        return demuxer.Open(filename);
+    });
+    if (resume) {
+        ResumeAsync(false);
+    }
+    return result;
+}
+
+bool VideoCapture::switchSource(IDataSource* dataSource, const std::string& format) {
+    if (!dataSource) {
+        LOG_ERROR("Invalid data source");
+        return false;
+    }
+
+    bool resume = SuspendAsync();
+    bool result = BeginSourceSwitch([dataSource, format](VideoDemuxer& demuxer) {
+        return demuxer.Open(dataSource, format);
+    });
+    if (resume) {
+        ResumeAsync(false);
+    }
+    return result;
+}
+
+bool VideoCapture::isSwitchPending() const {
+    return m_sourceSwitch != nullptr;
+}
+
+bool VideoCapture::startAsync(int queueDepth, FrameDelivery delivery) {
+    if (!m_opened) {
+        LOG_ERROR("startAsync() requires an opened source");
+        return false;
+    }
+
+    if (m_async) {
+        return true;
+    }
+
+    // The decode thread issues decode and copy commands on the immediate context the
+    // application renders with; the device has to serialize them
+    if (!HardwareDecoder::EnableMultithreadProtection(s_d3dDevice)) {
+        LOG_ERROR("startAsync() - the D3D11 device cannot be used from several threads");
+        return false;
+    }
+
+    auto async = std::make_unique<AsyncDecode>();
+    async->delivery = delivery;
+    async->queueDepth = delivery == FrameDelivery::Latest ? 1 : static_cast<size_t>(std::max(1, queueDepth));
+    async->readyEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!async->readyEvent) {
+        LOG_ERROR("startAsync() - failed to create the frame-ready event");
+        return false;
+    }
+
+    for (int propId = 0; propId < AsyncDecode::PROPERTY_COUNT; propId++) {
+        if (propId != CAP_PROP_FOURCC) {
+            async->delivered[propId] = GetProperty(propId);
+        }
+    }
+
+    m_async = std::move(async);
+    m_async->thread = std::thread(&VideoCapture::RunAsyncDecode, this);
+
+    if (delivery == FrameDelivery::Latest) {
+        LOG_INFO("Background decoding started (latest frame)");
+    } else {
+        LOG_INFO("Background decoding started (queue depth ", m_async->queueDepth, ")");
+    }
+    return true;
+}
+
+void VideoCapture::stopAsync() {
+    if (!m_async) {
+        return;
+    }
+
+    // Frames still queued are dropped; read() continues after them
+    SuspendAsync();
+    m_async.reset();
+    LOG_INFO("Background decoding stopped");
+}
+
+bool VideoCapture::isAsync() const {
+    return m_async != nullptr;
+}
+
+HANDLE VideoCapture::getFrameReadyEvent() const {
+    return m_async ? m_async->readyEvent : nullptr;
+}
+
+bool VideoCapture::tryRead(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format) {
+    if (!m_async) {
+        LOG_ERROR("tryRead() requires startAsync()");
+        return false;
+    }
+
+    return DequeueFrame(outTexture, isYUV, format, false);
+}
+
+bool VideoCapture::isEndOfStream() const {
+    if (!m_opened) {
+        return true;
+    }
+
+    if (m_async) {
+        std::lock_guard<std::mutex> lock(m_async->mutex);
+        return m_async->ended && m_async->queue.empty();
+    }
+    return m_eof;
+}
+
+int64_t VideoCapture::getOverwrittenFrameCount() const {
+    if (!m_async) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_async->mutex);
+    return m_async->overwritten;
+}
+
+void VideoCapture::release() {
+    CancelPendingOpen();
+    Close();
+}
+
+void VideoCapture::ConfigureDemuxer(VideoDemuxer& demuxer) {
+    demuxer.SetDeadlines(ToDemuxDeadlines(m_ioDeadlines));
+    demuxer.SetAbortFlag(&m_abortRequested);
+    demuxer.SetInterruptFlag(m_openInterrupt);
+    demuxer.SetByteCounter(&m_progress->bytesIn);
+}
+
+std::shared_ptr<ProbeCache> VideoCapture::GetProbeCache() {
+    std::lock_guard<std::mutex> lock(s_probeCacheMutex);
+    return s_probeCache;
+}
+
+void VideoCapture::UpdateIoStatus(const VideoDemuxer& demuxer) {
+    switch (demuxer.GetLastInterrupt()) {
+        case DemuxInterrupt::Timeout:
+            m_ioStatus = IoStatus::TimedOut;
+            break;
+        case DemuxInterrupt::Aborted:
+            m_ioStatus = IoStatus::Aborted;
+            break;
+        default:
+            m_ioStatus = IoStatus::Ok;
+            break;
+    }
+}
+
+bool VideoCapture::RunRecovery() {
+    if (!m_watchdog || !m_opened) {
+        return false;
+    }
+
+    switch (m_watchdog->TakeRecovery()) {
+        case RecoveryAction::FlushDecoder:
+            LOG_INFO("Watchdog: flushing the decoder, resuming at the next keyframe");
+            m_decoder->Flush();
+            m_skipToKeyframe = true;
+            m_seekTargetTime = -1.0;
+            return true;
+
+        case RecoveryAction::SeekToLive:
+            if (m_timeShift) {
+                LOG_INFO("Watchdog: seeking to the live edge");
+                m_timeShift->SeekToLive();
+                m_decoder->Flush();
+            } else if (m_streamOptions || m_demuxer->GetDuration() <= 0.0) {
+                // Live sources are read at the live edge already; drop what is in flight
+                LOG_INFO("Watchdog: resuming at the next keyframe");
+                m_decoder->Flush();
+                m_skipToKeyframe = true;
+            } else {
+                LOG_WARNING("Watchdog: seek to live skipped, the source is not live");
+                return false;
+            }
+            m_seekTargetTime = -1.0;
+            m_eof = false;
+            return true;
+
+        case RecoveryAction::Reconnect:
+            if (!m_streamOptions) {
+                LOG_WARNING("Watchdog: reconnect skipped, the source was not opened with openStream()");
+                return false;
+            }
+            LOG_INFO("Watchdog: reconnecting to ", m_streamUrl);
+            m_reconnectRequested = true;
+            m_eof = false;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void VideoCapture::ApplyDecodeTier(DecodeTier tier) {
+    if (tier != m_activeTier) {
+        LOG_INFO("Decode tier changed from ", TierName(m_activeTier), " to ", TierName(tier));
+    }
+    m_decoder->SetFrameSkip(FrameSkipFor(tier));
+    m_activeTier = tier;
+}
+
+bool VideoCapture::HandleDecodeError(const char* what, bool resync) {
+    DecodeErrors& errors = *m_decodeErrors;
+    {
+        std::lock_guard<std::mutex> lock(errors.mutex);
+        errors.stats.decodeErrors++;
+    }
+    errors.consecutive++;
+
+    if (!errors.recovering) {
+        errors.recovering = true;
+        LOG_WARNING("Decode error (", what, ") after ", errors.lastGoodTime, " s",
+                    resync && errors.policy.resyncAtKeyframe ? ", resuming at the next keyframe" : "");
+    } else {
+        LOG_DEBUG("Decode error (", what, "), ", errors.consecutive, " since the last good frame");
+    }
+
+    if (errors.policy.maxConsecutiveErrors > 0 && errors.consecutive >= errors.policy.maxConsecutiveErrors) {
+        LOG_ERROR("Giving up after ", errors.consecutive, " decode errors without a good frame");
+        return false;
+    }
+
+    if (resync && errors.policy.resyncAtKeyframe) {
+        m_skipToKeyframe = true;
+    }
+    return true;
+}
+
+bool VideoCapture::AcceptFrame() {
+    DecodeErrors& errors = *m_decodeErrors;
+    const DecodedFrame& frame = *m_currentFrame;
+    std::lock_guard<std::mutex> lock(errors.mutex);
+
+    if (frame.corrupt) {
+        if (!errors.policy.concealErrors) {
+            errors.stats.corruptFramesDropped++;
+            errors.stats.framesLost++;
+            return false;
+        }
+        errors.stats.corruptFramesDelivered++;
+    }
+
+    if (errors.recovering) {
+        // Measured in stream time, so it means the same for files and live sources
+        double recoveryMs = errors.lastGoodTime >= 0.0
+            ? std::max(0.0, (frame.presentationTime - errors.lastGoodTime) * 1000.0) : 0.0;
+        errors.stats.recoveries++;
+        errors.stats.lastRecoveryMs = recoveryMs;
+        errors.stats.maxRecoveryMs = std::max(errors.stats.maxRecoveryMs, recoveryMs);
+        errors.stats.totalRecoveryMs += recoveryMs;
+        errors.recovering = false;
+        LOG_INFO("Recovered from ", errors.consecutive, " decode error(s) after ", recoveryMs, " ms of stream time");
+    }
+
+    errors.consecutive = 0;
+    errors.lastGoodTime = frame.presentationTime;
+    return true;
+}
+
+void VideoCapture::Close() {
+    stopAsync();
+    StopLiveIngest(true);
+    CancelSourceSwitch();
+    m_currentFrame.reset();
+    m_timeShift.reset();
+    m_decoder.reset();
+    m_demuxer.reset();
+    m_opened = false;
+    m_eof = false;
+    m_frameCount = 0;
+    m_seekTargetTime = -1.0;
+    m_streamOptions.reset();
+    m_streamUrl.clear();
+    m_reconnectCount = 0;
+    m_skipToKeyframe = false;
+    m_reconnectRequested = false;
+    m_progress->ended = true;
+
+    // The policy stays, counters start over with the next source
+    {
+        std::lock_guard<std::mutex> lock(m_decodeErrors->mutex);
+        m_decodeErrors->stats = DecodeErrorStats();
+    }
+    m_decodeErrors->consecutive = 0;
+    m_decodeErrors->recovering = false;
+    m_decodeErrors->lastGoodTime = -1.0;
+    m_temporalFilter->ResetStats();
+}
+
+bool VideoCapture::InitializeDecoder() {
+    // Get decoder info
+    DecoderInfo decoderInfo = HardwareDecoder::GetBestDecoder(m_demuxer->GetCodecID());
+    if (decoderInfo.type != DecoderType::D3D11VA || !decoderInfo.available) {
+        LOG_ERROR("Hardware decoder not available - only hardware decoding is supported");
+        return false;
+    }
+
+    // Create decoder
+    m_decoder = std::make_unique<VideoDecoder>();
+    m_decoder->SetCallMonitor(&m_progress->inDecoder, &m_progress->decoderCalls);
+    m_decoder->SetErrorConcealment(m_decodeErrors->policy.concealErrors);
+    ApplyDecodeTier(m_requestedTier);
+    m_temporalFilter->Configure(m_demuxer->GetCodecParameters());
+    if (!m_decoder->Initialize(m_demuxer->GetCodecParameters(), decoderInfo, s_d3dDevice, m_demuxer->GetTimeBase())) {
+        LOG_ERROR("Failed to initialize video decoder");
+        return false;
+    }
+
+    // Create frame holder
+    m_currentFrame = std::make_unique<DecodedFrame>();
+
+    return true;
+}
+
+void VideoCapture::UpdateFrameCount() {
+    // Prefer the exact count from the container, otherwise estimate it
+    m_frameCount = m_demuxer->GetFrameCount();
+    if (m_frameCount > 0) {
+        return;
+    }
+
+    double duration = m_demuxer->GetDuration();
+    double frameRate = m_demuxer->GetFrameRate();
+    if (duration > 0.0 && frameRate > 0.0) {
+        m_frameCount = static_cast<int64_t>(duration * frameRate);
+    } else {
+        m_frameCount = 0;
+    }
+}
+
+bool VideoCapture::DecodeNextFrame() {
+    if (!m_decoder || !m_demuxer) {
+        return false;
+    }
+
+    // Try to decode a frame (may need multiple packets)
+    const int MAX_ATTEMPTS = 100; // Prevent infinite loops
+    int attempts = 0;
+
+    while (attempts++ < MAX_ATTEMPTS) {
+        // Try to receive a frame first (decoder may have buffered frames)
+        if (m_decoder->ReceiveFrame(*m_currentFrame)) {
+            if (m_currentFrame->valid) {
+                if (AcceptFrame()) {
+                    return true; // Successfully decoded a frame
+                }
+
+                // Dropped as corrupt: the decoder is producing output, so no attempt was wasted.
+                // Receive again before sending, it may hold more frames.
+                attempts = 0;
+                if (!HandleDecodeError("frame decoded with errors", false)) {
+                    return false;
+                }
+                continue;
+            }
+        } else {
+            if (!HandleDecodeError("frame failed to decode", true)) {
+                return false;
+            }
+            continue;
+        }
+
+        // Need more data, read a packet
+        AVPacket packet;
+        if (!ReadPacket(&packet)) {
+            if (m_ioStatus != IoStatus::Ok) {
+                // Interrupted, not ended: keep the decoder as it is for the next read
+                return false;
+            }
+
+            // End of file or error
+            // Flush decoder to get remaining frames, under the same corrupt-frame policy
+            m_decoder->SendPacket(nullptr);
+            while (m_decoder->ReceiveFrame(*m_currentFrame) && m_currentFrame->valid) {
+                if (AcceptFrame()) {
+                    return true;
+                }
+                if (!HandleDecodeError("frame decoded with errors", false)) {
+                    return false;
+                }
+            }
+            return false;
+        }
+        m_progress->packetsDemuxed++;
+
+        // After a decode error or watchdog recovery, resume decoding at a keyframe
+        // (skipped packets are not attempts)
+        if (m_skipToKeyframe) {
+            if (!(packet.flags & AV_PKT_FLAG_KEY)) {
+                av_packet_unref(&packet);
+                std::lock_guard<std::mutex> lock(m_decodeErrors->mutex);
+                m_decodeErrors->stats.packetsDropped++;
+                m_decodeErrors->stats.framesLost++;
+                attempts--;
+                continue;
+            }
+            m_skipToKeyframe = false;
+        }
+
+        // Tier changes wait for a keyframe, so no frame decodes against skipped references
+        if (packet.flags & AV_PKT_FLAG_KEY) {
+            DecodeTier tier = m_requestedTier;
+            if (tier != m_activeTier) {
+                ApplyDecodeTier(tier);
+            }
+        } else if (m_activeTier == DecodeTier::KeyframesOnly) {
+            av_packet_unref(&packet);
+            attempts--;
+            continue;
+        }
+
+        // Packets above the temporal layer limit never reach the decoder
+        if (!m_temporalFilter->Accept(&packet)) {
+            av_packet_unref(&packet);
+            attempts--;
+            continue;
+        }
+
+        // Send packet to decoder; a rejected packet is dropped unless the policy ends the stream
+        if (!m_decoder->SendPacket(&packet)) {
+            av_packet_unref(&packet);
+            if (!HandleDecodeError("packet rejected by the decoder", true) ||
+                !m_decodeErrors->policy.skipCorruptPackets) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(m_decodeErrors->mutex);
+            m_decodeErrors->stats.packetsDropped++;
+            m_decodeErrors->stats.framesLost++;
+            attempts--;
+            continue;
+        }
+
+        av_packet_unref(&packet);
+    }
+
+    LOG_ERROR("Failed to decode frame after ", MAX_ATTEMPTS, " attempts");
+    return false;
+}
+
+bool VideoCapture::ReadPacket(AVPacket* packet) {
+    if (!m_timeShift) {
+        return ReadSourcePacket(packet);
+    }
+
+    // Replay from the rewind window until the cursor reaches the live edge; meanwhile the
+    // source keeps being read into the window so the live edge stays current
+    if (m_timeShift->ReadPacket(packet)) {
+        StartLiveIngest();
+        return true;
+    }
+
+    // At the live edge this thread reads the source again, after what was ingested up to now
+    if (m_liveIngest) {
+        StopLiveIngest(false);
+        if (m_timeShift->ReadPacket(packet)) {
+            return true;
+        }
+    }
+
+    if (!ReadSourcePacket(packet)) {
+        return false;
+    }
+
+    m_timeShift->Push(packet);
+    return true;
+}
+
+bool VideoCapture::ReadSourcePacket(AVPacket* packet) {
+    if (!m_reconnectRequested) {
+        bool read = m_demuxer->ReadFrame(packet);
+        UpdateIoStatus(*m_demuxer);
+        if (read) {
+            return true;
+        }
+
+        if (m_ioStatus != IoStatus::Ok || !m_streamOptions || !m_streamOptions->reconnect) {
+            return false;
+        }
+    }
+    m_reconnectRequested = false;
+
+    // Reopen the stream and resume at its first keyframe
+    while (Reconnect()) {
+        while (m_demuxer->ReadFrame(packet)) {
+            if (packet->flags & AV_PKT_FLAG_KEY) {
+                AttachNewExtradata(packet, m_demuxer->GetCodecParameters());
+                m_ioStatus = IoStatus::Ok;
+                return true;
+            }
+            av_packet_unref(packet);
+        }
+
+        UpdateIoStatus(*m_demuxer);
+        if (m_ioStatus != IoStatus::Ok) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void VideoCapture::StartLiveIngest() {
+    if (m_liveIngest) {
+        return;
+    }
+
+    // A file is not live: the window already holds everything up to the read position
+    if (!m_streamOptions && m_demuxer->GetDuration() > 0.0) {
+        return;
+    }
+
+    m_liveIngest = std::make_unique<LiveIngest>();
+    m_liveIngest->thread = std::thread(&VideoCapture::RunLiveIngest, this);
+    LOG_DEBUG("Time-shift: replaying, live ingest started");
+}
+
+void VideoCapture::StopLiveIngest(bool interrupt) {
+    if (!m_liveIngest) {
+        return;
+    }
+
+    // Without interrupting, the read in progress completes so no packet is lost
+    m_liveIngest->stopping = true;
+    if (interrupt) {
+        m_abortRequested = true;
+    }
+    m_liveIngest->thread.join();
+    m_liveIngest.reset();
+    if (interrupt) {
+        ResetAbort();
+    }
+    LOG_DEBUG("Time-shift: live ingest stopped");
+}
+
+void VideoCapture::RunLiveIngest() {
+    LiveIngest& ingest = *m_liveIngest;
+    AVPacket packet;
+
+    // The demuxer belongs to this thread until StopLiveIngest(); reconnects are left to read()
+    // once it is back at the live edge
+    while (!ingest.stopping) {
+        if (!m_demuxer->ReadFrame(&packet)) {
+            if (m_demuxer->GetLastInterrupt() == DemuxInterrupt::Timeout) {
+                continue;
+            }
+            break;
+        }
+        // read() has not seen this packet: leave a cursor at the live edge on it
+        m_timeShift->Push(&packet, false);
+        av_packet_unref(&packet);
+    }
+}
+
+std::unique_ptr<VideoDemuxer> VideoCapture::OpenStreamDemuxer() {
+    AVDictionary* options = nullptr;
+    BuildStreamOptions(m_streamUrl, *m_streamOptions, &options);
+
+    std::unique_ptr<VideoDemuxer> demuxer = std::make_unique<VideoDemuxer>();
+    ConfigureDemuxer(*demuxer);
+    bool opened = demuxer->Open(m_streamUrl, &options);
+    UpdateIoStatus(*demuxer);
+
+    // Anything left in the dictionary was not recognized by the protocol or demuxer
+    AVDictionaryEntry* entry = nullptr;
+    while ((entry = av_dict_get(options, "", entry, AV_DICT_IGNORE_SUFFIX)) != nullptr) {
+        LOG_DEBUG("Stream option not used: ", entry->key);
+    }
+    av_dict_free(&options);
+
+    if (!opened) {
+        return nullptr;
+    }
+    return demuxer;
+}
+
+bool VideoCapture::Reconnect() {
+    const StreamOptions& options = *m_streamOptions;
+    int delayMs = std::max(0, options.reconnectDelayMs);
+
+    for (int attempt = 1; options.maxReconnectAttempts <= 0 || attempt <= options.maxReconnectAttempts; attempt++) {
+        LOG_WARNING("Stream interrupted, reconnecting to ", m_streamUrl, " in ", delayMs, " ms (attempt ", attempt, ")");
+
+        // abort() ends the delay; the flag stays set, so it also covers the open that follows
+        {
+            std::unique_lock<std::mutex> lock(m_reconnectMutex);
+            if (m_reconnectWake.wait_for(lock, std::chrono::milliseconds(delayMs),
+                                         [this]() { return m_abortRequested.load(); })) {
+                LOG_WARNING("Reconnect to ", m_streamUrl, " aborted");
+                m_ioStatus = IoStatus::Aborted;
+                return false;
+            }
+        }
+        delayMs = std::min(delayMs * 2, std::max(delayMs, options.maxReconnectDelayMs));
+
+        std::unique_ptr<VideoDemuxer> demuxer = OpenStreamDemuxer();
+        if (!demuxer) {
+            if (m_ioStatus == IoStatus::Aborted) {
+                LOG_WARNING("Reconnect to ", m_streamUrl, " aborted");
+                return false;
+            }
+            continue;
+        }
+
+        bool compatible = m_decoder->IsCompatible(demuxer->GetCodecParameters());
+        m_demuxer = std::move(demuxer);
+
+        if (compatible) {
+            // Same codec and profile: keep the decoder, the new parameter sets travel with the first packet
+            m_decoder->Flush();
+            m_decoder->SetStreamTimebase(m_demuxer->GetTimeBase());
+        } else if (!InitializeDecoder()) {
+            LOG_ERROR("Failed to initialize hardware decoder after reconnecting");
+            return false;
+        }
+
+        m_reconnectCount++;
+        LOG_INFO("Reconnected to ", m_streamUrl, " (", m_reconnectCount, " reconnects)");
+        return true;
+    }
+
+    LOG_ERROR("Giving up on ", m_streamUrl, " after ", options.maxReconnectAttempts, " reconnect attempts");
+    return false;
+}
+
+bool VideoCapture::SeekTimeShift(double timeInSeconds) {
+    if (!m_timeShift->SeekToTime(timeInSeconds)) {
+        LOG_WARNING("Seek target ", timeInSeconds, " seconds is outside the time-shift window (",
+                    m_timeShift->GetStartTime(), " - ", m_timeShift->GetEndTime(), ")");
+        return false;
+    }
+
+    m_decoder->Flush();
+    m_eof = false;
+    return true;
+}
+bool VideoCapture::BeginSourceSwitch(std::function<bool(VideoDemuxer&)> openSource) {
+    if (!m_opened) {
+        LOG_ERROR("switchSource() requires an opened source");
+        return false;
+    }
+
+    if (m_timeShift) {
+        LOG_ERROR("switchSource() is not supported while time-shift is enabled");
+        return false;
+    }
+
+    CancelSourceSwitch();
+
+    m_sourceSwitch = std::make_unique<SourceSwitch>();
+    m_sourceSwitch->openSource = std::move(openSource);
+    m_sourceSwitch->codecId = m_decoder->GetCodecId();
+    m_sourceSwitch->profile = m_decoder->GetProfile();
+    m_sourceSwitch->deadlines = ToDemuxDeadlines(m_ioDeadlines);
+    if (m_currentFrame && m_currentFrame->valid) {
+        m_sourceSwitch->playbackTime = m_currentFrame->presentationTime;
+    }
+    m_sourceSwitch->thread = std::thread(&VideoCapture::PrimeSourceSwitch, this, m_sourceSwitch.get());
+
+    LOG_INFO("Switching source in the background");
+    return true;
+}
+
+void VideoCapture::PrimeSourceSwitch(SourceSwitch* pending) {
+    if (!pending->demuxer) {
+        // Same deadlines as the main open path; cancelling the switch interrupts a stalled source.
+        // CompleteSourceSwitch() hands the demuxer the capture's own flags.
+        auto demuxer = std::make_unique<VideoDemuxer>();
+        demuxer->SetProbeCache(GetProbeCache());
+        demuxer->SetDeadlines(pending->deadlines);
+        demuxer->SetInterruptFlag(&pending->cancelled);
+        if (!pending->openSource(*demuxer)) {
+            if (!pending->cancelled) {
+                LOG_ERROR("switchSource() - failed to open the new source");
+            }
+            pending->failed = true;
+            pending->ready = true;
+            return;
+        }
+
+        // Different codec or profile: bring up a second decoder now, off the read() path
+        if (!VideoDecoder::IsCompatible(pending->codecId, pending->profile, demuxer->GetCodecParameters())) {
+            DecoderInfo decoderInfo = HardwareDecoder::GetBestDecoder(demuxer->GetCodecID());
+            auto decoder = std::make_unique<VideoDecoder>();
+            if (decoderInfo.type != DecoderType::D3D11VA || !decoderInfo.available ||
+                !decoder->Initialize(demuxer->GetCodecParameters(), decoderInfo, s_d3dDevice, demuxer->GetTimeBase())) {
+                LOG_ERROR("switchSource() - failed to initialize a decoder for the new source");
+                pending->failed = true;
+                pending->ready = true;
+                return;
+            }
+            pending->decoder = std::move(decoder);
+        }
+
+        // Seekable sources: start near the current position instead of reading up to it
+        double position = pending->playbackTime;
+        if (position > 0.0 && demuxer->GetDuration() > 0.0) {
+            demuxer->SeekToTime(position);
+        }
+
+        pending->demuxer = std::move(demuxer);
+    }
+
+    // First keyframe after the current playback position
+    av_packet_free(&pending->keyframe);
+    AVPacket* packet = av_packet_alloc();
+    AVRational timeBase = pending->demuxer->GetTimeBase();
+
+    while (!pending->cancelled) {
+        if (!pending->demuxer->ReadFrame(packet)) {
+            if (pending->cancelled) {
+                break;
+            }
+            LOG_ERROR("switchSource() - new source ended before a keyframe");
+            pending->failed = true;
+            break;
+        }
+
+        int64_t timestamp = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+        double time = timestamp != AV_NOPTS_VALUE ? timestamp * av_q2d(timeBase) : -1.0;
+        if ((packet->flags & AV_PKT_FLAG_KEY) && time > pending->playbackTime) {
+            pending->keyframe = packet;
+            pending->switchTime = time;
+            packet = nullptr;
+            LOG_DEBUG("switchSource() - primed at keyframe ", time, " seconds");
+            break;
+        }
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+    pending->ready = true;
+}
+
+bool VideoCapture::SourceSwitchDue(bool decoded) {
+    const double SWITCH_TOLERANCE = 0.0005; // Half a millisecond of timestamp rounding
+    SourceSwitch& pending = *m_sourceSwitch;
+
+    if (!pending.ready) {
+        if (decoded) {
+            return false;
+        }
+        // The current source ended first: wait for the new one
+        pending.thread.join();
+    }
+
+    if (pending.failed) {
+        LOG_ERROR("switchSource() failed, continuing with the current source");
+        CancelSourceSwitch();
+        return false;
+    }
+
+    if (!decoded) {
+        return true;
+    }
+
+    // Playback already passed the primed keyframe: look for the next one
+    if (pending.switchTime <= pending.playbackTime) {
+        if (pending.thread.joinable()) {
+            pending.thread.join();
+        }
+        pending.ready = false;
+        pending.thread = std::thread(&VideoCapture::PrimeSourceSwitch, this, &pending);
+        return false;
+    }
+
+    // The frame at the switch point comes from the new source instead
+    return m_currentFrame->valid && m_currentFrame->presentationTime + SWITCH_TOLERANCE >= pending.switchTime;
+}
+
+bool VideoCapture::CompleteSourceSwitch() {
+    std::unique_ptr<SourceSwitch> pending = std::move(m_sourceSwitch);
+    if (pending->thread.joinable()) {
+        pending->thread.join();
+    }
+
+    // Primed against the decoder of switchSource() time; a reconnect may have replaced it since
+    bool reused = !pending->decoder;
+    if (reused && !m_decoder->IsCompatible(pending->demuxer->GetCodecParameters())) {
+        LOG_ERROR("switchSource() - decoder changed while priming, continuing with the current source");
+        return false;
+    }
+
+    if (reused) {
+        // Frames still queued in the decoder are at or after the switch point; drop them
+        m_decoder->Flush();
+        m_decoder->SetStreamTimebase(pending->demuxer->GetTimeBase());
+
+        AttachNewExtradata(pending->keyframe, pending->demuxer->GetCodecParameters());
+    } else {
+        m_decoder = std::move(pending->decoder);
+        m_decoder->SetCallMonitor(&m_progress->inDecoder, &m_progress->decoderCalls);
+        m_decoder->SetErrorConcealment(m_decodeErrors->policy.concealErrors);
+        ApplyDecodeTier(m_activeTier);
+    }
+    m_demuxer = std::move(pending->demuxer);
+    m_temporalFilter->Configure(m_demuxer->GetCodecParameters());
+    m_streamOptions.reset();
+    ConfigureDemuxer(*m_demuxer);
+
+    // Decoder and demuxer are already switched: a rejected keyframe is a decode error of the
+    // new source, which then continues at its next keyframe
+    if (!m_decoder->SendPacket(pending->keyframe)) {
+        LOG_WARNING("switchSource() - decoder rejected the first packet of the new source");
+        m_skipToKeyframe = true;
+        HandleDecodeError("first packet of the new source rejected", true);
+    }
+
+    // Leading frames of an open GOP come before the keyframe in presentation order
+    m_seekTargetTime = pending->switchTime;
+    m_eof = false;
+    UpdateFrameCount();
+
+    LOG_INFO("Switched source at ", pending->switchTime, " seconds (", reused ? "decoder reused" : "new decoder", ")");
+    return true;
+}
+
+void VideoCapture::CancelSourceSwitch() {
+    if (!m_sourceSwitch) {
+        return;
+    }
+
+    m_sourceSwitch->cancelled = true;
+    if (m_sourceSwitch->thread.joinable()) {
+        m_sourceSwitch->thread.join();
+    }
+    m_sourceSwitch.reset();
+}
+
+void VideoCapture::RunAsyncDecode() {
+    AsyncDecode& async = *m_async;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(async.mutex);
+            async.changed.wait(lock, [&async]() {
+                return async.stopping || async.delivery == FrameDelivery::Latest ||
+                       async.queue.size() < async.queueDepth;
+            });
+            if (async.stopping) {
+                return;
+            }
+
+            // Each decoded frame is a call of its own for abort()
+            m_abortRequested = false;
+        }
+
+        // Decoder and demuxer belong to this thread until it is suspended
+        AsyncDecode::Entry entry;
+        bool decoded = DecodeFrame();
+        if (!decoded && m_ioStatus != IoStatus::Ok) {
+            // Deadline or abort: the stream has not ended, try again unless the thread is stopping
+            std::lock_guard<std::mutex> lock(async.mutex);
+            if (async.stopping) {
+                return;
+            }
+            continue;
+        }
+        if (decoded) {
+            entry.frame = *m_currentFrame;
+            for (int propId = 0; propId < AsyncDecode::PROPERTY_COUNT; propId++) {
+                if (propId != CAP_PROP_FOURCC) {
+                    entry.properties[propId] = GetProperty(propId);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(async.mutex);
+            if (decoded) {
+                // Latest mode: the mailbox holds one frame, an unread one is replaced
+                while (async.delivery == FrameDelivery::Latest && !async.queue.empty()) {
+                    async.queue.pop_front();
+                    async.overwritten++;
+                }
+                async.queue.push_back(std::move(entry));
+            } else {
+                async.ended = true;
+            }
+            SetEvent(async.readyEvent);
+        }
+        async.changed.notify_all();
+
+        if (!decoded) {
+            LOG_DEBUG("Background decoding reached the end of the stream");
+            return;
+        }
+    }
+}
+
+bool VideoCapture::DequeueFrame(ID3D11Texture2D** outTexture, bool& isYUV, DXGI_FORMAT& format, bool wait) {
+    AsyncDecode& async = *m_async;
+    std::unique_lock<std::mutex> lock(async.mutex);
+
+    if (wait) {
+        async.changed.wait(lock, [&async]() {
+            return !async.queue.empty() || async.ended;
+        });
+    }
+
+    if (async.queue.empty()) {
+        return false;
+    }
+
+    AsyncDecode::Entry entry = std::move(async.queue.front());
+    async.queue.pop_front();
+    if (async.queue.empty() && !async.ended) {
+        ResetEvent(async.readyEvent);
+    }
+    lock.unlock();
+    async.changed.notify_all();
+
+    std::copy(std::begin(entry.properties), std::end(entry.properties), std::begin(async.delivered));
+    m_progress->framesConsumed++;
+
+    *outTexture = entry.frame.texture.Get();
+    if (*outTexture) {
+        (*outTexture)->AddRef(); // Caller must release
+    }
+
+    isYUV = entry.frame.isYUV;
+    format = entry.frame.format;
+    return true;
+}
+
+bool VideoCapture::SuspendAsync() {
+    if (!m_async || !m_async->thread.joinable()) {
+        return false;
+    }
+
+    // Interrupt the frame being decoded so a blocking read or reconnect returns promptly.
+    // Set together with stopping, so the decode thread cannot clear the abort afterwards.
+    {
+        std::lock_guard<std::mutex> lock(m_async->mutex);
+        m_async->stopping = true;
+        m_abortRequested = true;
+    }
+    m_async->changed.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(m_reconnectMutex);
+    }
+    m_reconnectWake.notify_all();
+    m_async->thread.join();
+
+    // The abort was meant for the decode thread, not for what the caller does next
+    m_abortRequested = false;
+    return true;
+}
+
+bool VideoCapture::ResetAbort() {
+    if (m_async) {
+        std::lock_guard<std::mutex> lock(m_async->mutex);
+        if (m_async->stopping) {
+            return false;
+        }
+        m_abortRequested = false;
+        return true;
+    }
+
+    m_abortRequested = false;
+    return true;
+}
+
+void VideoCapture::ResumeAsync(bool discardQueued) {
+    {
+        std::lock_guard<std::mutex> lock(m_async->mutex);
+        if (discardQueued) {
+            m_async->queue.clear();
+        }
+        m_async->stopping = false;
+        m_async->ended = false;
+        if (m_async->queue.empty()) {
+            ResetEvent(m_async->readyEvent);
+        }
+    }
+    m_async->thread = std::thread(&VideoCapture::RunAsyncDecode, this);
+}
+
+OpenHandle VideoCapture::StartAsyncOpen(std::function<bool()> open) {
+    // Only one open at a time; the previous source is closed on the caller's thread
+    CancelPendingOpen();
+    Close();
+
+    auto state = std::make_shared<OpenHandle::State>();
+    m_pendingOpen = state;
+    m_openInterrupt = &state->cancelled;
+
+    state->thread = std::thread([this, state, open = std::move(open)]() {
+        bool opened = open();
+        if (opened) {
+            // The interrupt flag only guards the open, later reads must not see it
+            m_demuxer->SetInterruptFlag(nullptr);
+        }
+        m_openInterrupt = nullptr;
+
+        OpenStatus status = opened ? OpenStatus::Opened
+                          : state->cancelled ? OpenStatus::Cancelled
+                          : OpenStatus::Failed;
+        if (status == OpenStatus::Cancelled) {
+            LOG_INFO("Open cancelled");
+        }
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->status = status;
+        }
+        state->done.notify_all();
+    });
+
+    OpenHandle handle;
+    handle.m_state = state;
+    return handle;
+}
+
+void VideoCapture::CancelPendingOpen() {
+    if (!m_pendingOpen) {
+        return;
+    }
+
+    m_pendingOpen->cancelled = true;
+    if (m_pendingOpen->thread.joinable()) {
+        m_pendingOpen->thread.join();
+    }
+    m_pendingOpen.reset();
+}
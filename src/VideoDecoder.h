@@ -1,85 +1,119 @@
-#pragma once
-
-#include <memory>
-#include <string>
-#include "HardwareDecoder.h"
-
-extern "C" {
-#include <libavcodec/avcodec.h>
-#include <libavutil/frame.h>
-#include <libavutil/hwcontext.h>
-}
-
-#include <d3d11.h>
-#include <wrl/client.h>
-
-using Microsoft::WRL::ComPtr;
-
-struct DecodedFrame {
-    // DirectX 11 texture (hardware-only)
-    ComPtr<ID3D11Texture2D> texture;
-
-    int width = 0;
-    int height = 0;
-
-    double presentationTime;
-    bool valid;
-    bool isYUV;  // True for hardware frames that need YUV->RGB conversion in shader
-    bool keyframe;  // True if this frame is a keyframe (I-frame)
-    DXGI_FORMAT format;
-
-    DecodedFrame() : presentationTime(0.0), valid(false), isYUV(false), keyframe(false), format(DXGI_FORMAT_B8G8R8A8_UNORM) {}
-
-    ~DecodedFrame() = default;
-
-    DecodedFrame(const DecodedFrame& other) = default;
-    DecodedFrame& operator=(const DecodedFrame& other) = default;
-};
-
-class VideoDecoder {
-public:
-    VideoDecoder();
-    ~VideoDecoder();
-
-    bool Initialize(AVCodecParameters* codecParams, const DecoderInfo& decoderInfo, ID3D11Device* d3dDevice, AVRational streamTimebase);
-    void Cleanup();
-
-    bool SendPacket(AVPacket* packet);
-    bool ReceiveFrame(DecodedFrame& frame);
-    void Flush();
-
-    // Getters
-    bool IsInitialized() const { return m_initialized; }
-    bool IsHardwareAccelerated() const { return m_useHardwareDecoding; }
-    const DecoderInfo& GetDecoderInfo() const { return m_decoderInfo; }
-
-private:
-    bool m_initialized;
-    bool m_useHardwareDecoding;
-    DecoderInfo m_decoderInfo;
-
-    // FFmpeg components
-    const AVCodec* m_codec;
-    AVCodecContext* m_codecContext;
-    AVBufferRef* m_hwDeviceContext;
-    AVFrame* m_frame;
-    AVRational m_streamTimebase;
-
-    // DirectX 11 components
-    ComPtr<ID3D11Device> m_d3dDevice;
-    ComPtr<ID3D11DeviceContext> m_d3dContext;
-
-    bool InitializeHardwareDecoder(AVCodecParameters* codecParams);
-    bool CreateHardwareDeviceContext();
-    bool SetupHardwareDecoding();
-
-    // Frame processing
-    bool ProcessHardwareFrame(DecodedFrame& outFrame);
-    bool IsHardwareFrame(AVFrame* frame) const;
-    bool ExtractD3D11Texture(AVFrame* frame, ComPtr<ID3D11Texture2D>& texture);
-
-    // Hardware format callback
-    static enum AVPixelFormat GetHardwareFormat(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts);
-
-    void Reset();
+#pragma once
+
+#include <memory>
+#include <string>
+#include <atomic>
+#include "HardwareDecoder.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+}
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+struct DecodedFrame {
+    // DirectX 11 texture (hardware-only)
+    ComPtr<ID3D11Texture2D> texture;
+
+    int width = 0;
+    int height = 0;
+
+    double presentationTime;
+    bool valid;
+    bool isYUV;  // True for hardware frames that need YUV->RGB conversion in shader
+    bool keyframe;  // True if this frame is a keyframe (I-frame)
+    bool corrupt;   // Decoded with errors (damaged or missing references)
+    DXGI_FORMAT format;
+
+    DecodedFrame() : presentationTime(0.0), valid(false), isYUV(false), keyframe(false), corrupt(false), format(DXGI_FORMAT_B8G8R8A8_UNORM) {}
+
+    ~DecodedFrame() = default;
+
+    DecodedFrame(const DecodedFrame& other) = default;
+    DecodedFrame& operator=(const DecodedFrame& other) = default;
+};
+
+class VideoDecoder {
+public:
+    VideoDecoder();
+    ~VideoDecoder();
+
+    bool Initialize(AVCodecParameters* codecParams, const DecoderInfo& decoderInfo, ID3D11Device* d3dDevice, AVRational streamTimebase);
+    void Cleanup();
+
+    // A packet the decoder cannot take yet (EAGAIN: output must be received first) is held and
+    // submitted by the next ReceiveFrame(); false only if the decoder rejects the packet
+    bool SendPacket(AVPacket* packet);
+    bool ReceiveFrame(DecodedFrame& frame);
+    void Flush();
+
+    // Same codec and profile: after Flush() the decoder can continue with another rendition
+    bool IsCompatible(const AVCodecParameters* codecParams) const;
+    static bool IsCompatible(AVCodecID codecId, int profile, const AVCodecParameters* codecParams);
+    AVCodecID GetCodecId() const { return m_initialized ? m_codecId : AV_CODEC_ID_NONE; }
+    int GetProfile() const { return m_profile; }
+    void SetStreamTimebase(AVRational streamTimebase);
+
+    // Output frames decoded with errors (concealed where the decoder supports it) instead of
+    // holding them back; applies immediately and to later Initialize() calls
+    void SetErrorConcealment(bool enabled);
+
+    // Frames the decoder drops without decoding them (AVDISCARD_NONREF, _BIDIR, ...); decided
+    // per packet, so changes take effect with the next packet. Honoured by H.264 and HEVC.
+    void SetFrameSkip(AVDiscard skip);
+
+    // Flag raised while SendPacket()/ReceiveFrame() run and a count of those calls, so other
+    // threads can tell a decoder call that does not return from one that is never made
+    void SetCallMonitor(std::atomic<bool>* inCall, std::atomic<int64_t>* calls);
+
+    // Getters
+    bool IsInitialized() const { return m_initialized; }
+    bool IsHardwareAccelerated() const { return m_useHardwareDecoding; }
+    const DecoderInfo& GetDecoderInfo() const { return m_decoderInfo; }
+
+private:
+    bool m_initialized;
+    bool m_useHardwareDecoding;
+    DecoderInfo m_decoderInfo;
+
+    // FFmpeg components
+    const AVCodec* m_codec;
+    AVCodecContext* m_codecContext;
+    AVBufferRef* m_hwDeviceContext;
+    AVFrame* m_frame;
+    AVPacket* m_pendingPacket;          // Refused with EAGAIN, sent again after receiving
+    bool m_hasPendingPacket;
+    bool m_pendingDrain;                // Same for the end-of-stream (nullptr) packet
+    AVRational m_streamTimebase;
+    AVCodecID m_codecId;
+    int m_profile;
+    bool m_errorConcealment;
+    AVDiscard m_frameSkip;
+    std::atomic<bool>* m_inCall;
+    std::atomic<int64_t>* m_calls;
+
+    // DirectX 11 components
+    ComPtr<ID3D11Device> m_d3dDevice;
+    ComPtr<ID3D11DeviceContext> m_d3dContext;
+
+    bool InitializeHardwareDecoder(AVCodecParameters* codecParams);
+    void ApplyErrorConcealment();
+    void SendPendingPacket();
+    bool CreateHardwareDeviceContext();
+    bool SetupHardwareDecoding();
+
+    // Frame processing
+    bool ProcessHardwareFrame(DecodedFrame& outFrame);
+    bool IsHardwareFrame(AVFrame* frame) const;
+    bool ExtractD3D11Texture(AVFrame* frame, ComPtr<ID3D11Texture2D>& texture);
+
+    // Hardware format callback
+    static enum AVPixelFormat GetHardwareFormat(AVCodecContext* ctx, const enum AVPixelFormat* pix_fmts);
+
+    void Reset();
 };
\ No newline at end of file
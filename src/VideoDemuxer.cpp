@@ -1,401 +1,636 @@
-#include "VideoDemuxer.h"
-#include "IDataSource.h"
-#include "Logger.h"
-#include <iostream>
-
-extern "C" {
-#include <libavutil/error.h>
-}
-
-VideoDemuxer::VideoDemuxer()
-    : m_formatContext(nullptr)
-    , m_ioContext(nullptr)
-    , m_dataSource(nullptr)
-    , m_ioBuffer(nullptr)
-    , m_videoStreamIndex(-1)
-    , m_videoStream(nullptr) {
-}
-
-VideoDemuxer::~VideoDemuxer() {
-    Close();
-}
-
-bool VideoDemuxer::Open(const std::string& filePath) {
-    Close();
-
-    // Open input file
-    int ret = avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr);
-    if (ret < 0) {
-        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorBuf, sizeof(errorBuf));
-        LOG_ERROR("Cannot open file ", filePath, ": ", errorBuf);
-        return false;
-    }
-
-    // Retrieve stream information
-    ret = avformat_find_stream_info(m_formatContext, nullptr);
-    if (ret < 0) {
-        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorBuf, sizeof(errorBuf));
-        LOG_ERROR("Cannot find stream info for ", filePath, ": ", errorBuf);
-        Close();
-        return false;
-    }
-
-    // Find video stream
-    if (!FindVideoStream()) {
-        LOG_ERROR("No video stream found in ", filePath);
-        Close();
-        return false;
-    }
-
-    LOG_INFO("Successfully opened video file: ", filePath);
-    LOG_INFO("  Resolution: ", GetWidth(), "x", GetHeight());
-    LOG_INFO("  Frame rate: ", GetFrameRate(), " FPS");
-    LOG_INFO("  Duration: ", GetDuration(), " seconds");
-    AVRational timebase = GetTimeBase();
-    LOG_INFO("  Timebase: ", timebase.num, "/", timebase.den,
-              " (", av_q2d(timebase), " seconds per unit)");
-
-    return true;
-}
-
-bool VideoDemuxer::Open(IDataSource* dataSource, const std::string& format) {
-    Close();
-
-    if (!dataSource) {
-        LOG_ERROR("Invalid data source");
-        return false;
-    }
-
-    m_dataSource = dataSource;
-
-    // Setup custom IO
-    if (!SetupCustomIO(dataSource, format)) {
-        LOG_ERROR("Failed to setup custom IO");
-        Close();
-        return false;
-    }
-
-    // Retrieve stream information
-    int ret = avformat_find_stream_info(m_formatContext, nullptr);
-    if (ret < 0) {
-        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorBuf, sizeof(errorBuf));
-        LOG_ERROR("Cannot find stream info: ", errorBuf);
-        Close();
-        return false;
-    }
-
-    // Find video stream
-    if (!FindVideoStream()) {
-        LOG_ERROR("No video stream found");
-        Close();
-        return false;
-    }
-
-    LOG_INFO("Successfully opened video from custom data source");
-    LOG_INFO("  Resolution: ", GetWidth(), "x", GetHeight());
-    LOG_INFO("  Frame rate: ", GetFrameRate(), " FPS");
-    LOG_INFO("  Duration: ", GetDuration(), " seconds");
-    AVRational timebase = GetTimeBase();
-    LOG_INFO("  Timebase: ", timebase.num, "/", timebase.den,
-              " (", av_q2d(timebase), " seconds per unit)");
-
-    return true;
-}
-
-void VideoDemuxer::Close() {
-    Reset();
-}
-
-bool VideoDemuxer::ReadFrame(AVPacket* packet) {
-    if (!m_formatContext || m_videoStreamIndex < 0) {
-        LOG_DEBUG("ReadFrame failed - no format context or invalid video stream index");
-        return false;
-    }
-
-    while (true) {
-        int ret = av_read_frame(m_formatContext, packet);
-        if (ret < 0) {
-            if (ret == AVERROR_EOF) {
-                LOG_DEBUG("End of file reached");
-            } else {
-                char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-                av_strerror(ret, errorBuf, sizeof(errorBuf));
-                LOG_DEBUG("av_read_frame failed: ", errorBuf, " (ret=", ret, ")");
-            }
-            return false;
-        }
-
-        // Only return packets from the video stream
-        if (packet->stream_index == m_videoStreamIndex) {
-            LOG_DEBUG("Read video packet - Size: ", packet->size,
-                     ", PTS: ", packet->pts,
-                     ", DTS: ", packet->dts,
-                     ", Stream: ", packet->stream_index,
-                     ", Flags: ", packet->flags);
-            return true;
-        }
-
-        // Free packet if it's not from the video stream
-        LOG_DEBUG("Skipping non-video packet from stream ", packet->stream_index);
-        av_packet_unref(packet);
-    }
-}
-
-bool VideoDemuxer::SeekToTime(double timeInSeconds) {
-    if (!m_formatContext || !m_videoStream) {
-        return false;
-    }
-
-    int64_t timestamp = SecondsToPacketTime(timeInSeconds);
-
-    LOG_DEBUG("Seeking to time ", timeInSeconds, " seconds (timestamp: ", timestamp, ")");
-
-    int ret = av_seek_frame(m_formatContext, m_videoStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD);
-    if (ret < 0) {
-        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorBuf, sizeof(errorBuf));
-        LOG_ERROR("Seek failed: ", errorBuf);
-        return false;
-    }
-
-    LOG_DEBUG("Seek completed successfully");
-    return true;
-}
-
-bool VideoDemuxer::SeekToFrame(int64_t frameNumber) {
-    if (!m_formatContext || !m_videoStream) {
-        return false;
-    }
-
-    double timeInSeconds = frameNumber / GetFrameRate();
-    return SeekToTime(timeInSeconds);
-}
-
-double VideoDemuxer::GetDuration() const {
-    if (!m_formatContext) {
-        return 0.0;
-    }
-
-    if (m_formatContext->duration != AV_NOPTS_VALUE) {
-        return static_cast<double>(m_formatContext->duration) / AV_TIME_BASE;
-    }
-
-    return 0.0;
-}
-
-double VideoDemuxer::GetFrameRate() const {
-    if (!m_videoStream) {
-        return 0.0;
-    }
-
-    if (m_videoStream->avg_frame_rate.num != 0 && m_videoStream->avg_frame_rate.den != 0) {
-        return av_q2d(m_videoStream->avg_frame_rate);
-    } else if (m_videoStream->r_frame_rate.num != 0 && m_videoStream->r_frame_rate.den != 0) {
-        return av_q2d(m_videoStream->r_frame_rate);
-    }
-
-    return 25.0; // Default fallback
-}
-
-int VideoDemuxer::GetWidth() const {
-    if (!m_videoStream) {
-        return 0;
-    }
-    return m_videoStream->codecpar->width;
-}
-
-int VideoDemuxer::GetHeight() const {
-    if (!m_videoStream) {
-        return 0;
-    }
-    return m_videoStream->codecpar->height;
-}
-
-AVCodecID VideoDemuxer::GetCodecID() const {
-    if (!m_videoStream) {
-        return AV_CODEC_ID_NONE;
-    }
-    return m_videoStream->codecpar->codec_id;
-}
-
-AVCodecParameters* VideoDemuxer::GetCodecParameters() const {
-    if (!m_videoStream) {
-        return nullptr;
-    }
-    return m_videoStream->codecpar;
-}
-
-int VideoDemuxer::GetVideoStreamIndex() const {
-    return m_videoStreamIndex;
-}
-
-AVRational VideoDemuxer::GetTimeBase() const {
-    if (!m_videoStream) {
-        return {0, 1};
-    }
-    return m_videoStream->time_base;
-}
-
-double VideoDemuxer::PacketTimeToSeconds(int64_t pts) const {
-    if (!m_videoStream || pts == AV_NOPTS_VALUE) {
-        return 0.0;
-    }
-    return static_cast<double>(pts) * av_q2d(m_videoStream->time_base);
-}
-
-int64_t VideoDemuxer::SecondsToPacketTime(double seconds) const {
-    if (!m_videoStream) {
-        return 0;
-    }
-    return static_cast<int64_t>(seconds / av_q2d(m_videoStream->time_base));
-}
-
-bool VideoDemuxer::IsValidPacket(const AVPacket* packet) const {
-    return packet && packet->stream_index == m_videoStreamIndex;
-}
-
-bool VideoDemuxer::FindVideoStream() {
-    if (!m_formatContext) {
-        return false;
-    }
-
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            m_videoStreamIndex = i;
-            m_videoStream = m_formatContext->streams[i];
-
-            // Validate codec support (H264/H265/AV1 only)
-            AVCodecID codecId = m_videoStream->codecpar->codec_id;
-            if (codecId != AV_CODEC_ID_H264 && codecId != AV_CODEC_ID_HEVC && codecId != AV_CODEC_ID_AV1) {
-                LOG_ERROR("Unsupported video codec found. Only H264, H265, and AV1 are supported.");
-                return false;
-            }
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-bool VideoDemuxer::SetupCustomIO(IDataSource* dataSource, const std::string& format) {
-    const size_t IO_BUFFER_SIZE = 32768; // 32KB buffer
-
-    // Allocate IO buffer
-    m_ioBuffer = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
-    if (!m_ioBuffer) {
-        LOG_ERROR("Failed to allocate IO buffer");
-        return false;
-    }
-
-    // Create AVIOContext with custom callbacks
-    m_ioContext = avio_alloc_context(
-        m_ioBuffer,
-        IO_BUFFER_SIZE,
-        0,                          // write_flag (0 = read-only)
-        dataSource,                 // opaque user data
-        &VideoDemuxer::ReadPacket,  // read_packet callback
-        nullptr,                    // write_packet callback
-        &VideoDemuxer::Seek         // seek callback
-    );
-
-    if (!m_ioContext) {
-        LOG_ERROR("Failed to allocate AVIOContext");
-        av_free(m_ioBuffer);
-        m_ioBuffer = nullptr;
-        return false;
-    }
-
-    // Allocate format context
-    m_formatContext = avformat_alloc_context();
-    if (!m_formatContext) {
-        LOG_ERROR("Failed to allocate AVFormatContext");
-        return false;
-    }
-
-    // Assign custom IO context
-    m_formatContext->pb = m_ioContext;
-    m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
-
-    // Determine input format
-    const AVInputFormat* inputFormat = nullptr;
-    if (!format.empty()) {
-        inputFormat = av_find_input_format(format.c_str());
-        if (!inputFormat) {
-            LOG_WARNING("Could not find input format: ", format);
-        }
-    }
-
-    // Open input (with empty filename for custom IO)
-    int ret = avformat_open_input(&m_formatContext, "", inputFormat, nullptr);
-    if (ret < 0) {
-        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errorBuf, sizeof(errorBuf));
-        LOG_ERROR("Cannot open custom input: ", errorBuf);
-        return false;
-    }
-
-    LOG_DEBUG("Custom IO setup complete");
-    return true;
-}
-
-void VideoDemuxer::Reset() {
-    if (m_formatContext) {
-        avformat_close_input(&m_formatContext);
-        m_formatContext = nullptr;
-    }
-
-    if (m_ioContext) {
-        // Note: ioContext->buffer is freed by avformat_close_input if the context was used
-        // If not, we need to free it manually
-        if (m_ioBuffer) {
-            av_freep(&m_ioContext->buffer);
-        }
-        avio_context_free(&m_ioContext);
-        m_ioContext = nullptr;
-    }
-
-    if (m_ioBuffer) {
-        // Already freed by avio_context_free or avformat_close_input
-        m_ioBuffer = nullptr;
-    }
-
-    m_dataSource = nullptr;
-    m_videoStreamIndex = -1;
-    m_videoStream = nullptr;
-}
-
-int VideoDemuxer::ReadPacket(void* opaque, uint8_t* buf, int buf_size) {
-    IDataSource* dataSource = static_cast<IDataSource*>(opaque);
-    if (!dataSource) {
-        return AVERROR(EIO);
-    }
-
-    int bytesRead = dataSource->Read(buf, buf_size);
-    if (bytesRead < 0) {
-        // Return FFmpeg error code
-        return bytesRead;
-    }
-    if (bytesRead == 0) {
-        // End of file
-        return AVERROR_EOF;
-    }
-
-    return bytesRead;
-}
-
-int64_t VideoDemuxer::Seek(void* opaque, int64_t offset, int whence) {
-    IDataSource* dataSource = static_cast<IDataSource*>(opaque);
-    if (!dataSource) {
-        return AVERROR(EIO);
-    }
-
-    if (!dataSource->IsSeekable()) {
-        return AVERROR(ENOSYS);
-    }
-
-    return dataSource->Seek(offset, whence);
+#include "VideoDemuxer.h"
+#include "IDataSource.h"
+#include "ProbeCache.h"
+#include "Mp4SampleTable.h"
+#include "FileDataSource.h"
+#include "Logger.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+VideoDemuxer::VideoDemuxer()
+    : m_formatContext(nullptr)
+    , m_ioContext(nullptr)
+    , m_dataSource(nullptr)
+    , m_ioBuffer(nullptr)
+    , m_videoStreamIndex(-1)
+    , m_videoStream(nullptr)
+    , m_interruptFlag(nullptr)
+    , m_abortRequested(false)
+    , m_abortFlag(&m_abortRequested)
+    , m_deadline(std::chrono::steady_clock::time_point::max())
+    , m_lastInterrupt(DemuxInterrupt::None)
+    , m_byteCounter(nullptr)
+    , m_bytesCounted(0) {
+}
+
+VideoDemuxer::~VideoDemuxer() {
+    Close();
+}
+
+bool VideoDemuxer::Open(const std::string& filePath) {
+    return Open(filePath, nullptr);
+}
+
+bool VideoDemuxer::Open(const std::string& filePath, AVDictionary** options) {
+    Close();
+
+    // Allocate the context up front so connecting and probing can be interrupted
+    m_formatContext = avformat_alloc_context();
+    if (!m_formatContext) {
+        LOG_ERROR("Failed to allocate AVFormatContext");
+        return false;
+    }
+    m_formatContext->interrupt_callback.callback = &VideoDemuxer::InterruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+
+    // Open input file (frees the context on failure)
+    BeginOperation(m_deadlines.openMs);
+    int ret = avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, options);
+    EndOperation(ret, "open", m_deadlines.openMs);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Cannot open file ", filePath, ": ", errorBuf);
+        return false;
+    }
+
+    // Retrieve stream information (restored from the probe cache when possible)
+    if (!m_probeCache || !m_probeCache->Restore(filePath, m_formatContext)) {
+        BeginOperation(m_deadlines.probeMs);
+        ret = avformat_find_stream_info(m_formatContext, nullptr);
+        EndOperation(ret, "stream analysis", m_deadlines.probeMs);
+        if (ret < 0) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_ERROR("Cannot find stream info for ", filePath, ": ", errorBuf);
+            Close();
+            return false;
+        }
+
+        if (m_probeCache) {
+            m_probeCache->Store(filePath, m_formatContext);
+        }
+    }
+
+    // Find video stream
+    if (!FindVideoStream()) {
+        LOG_ERROR("No video stream found in ", filePath);
+        Close();
+        return false;
+    }
+
+    // Exact frame table for local MP4/MOV files
+    const char* protocol = avio_find_protocol_name(filePath.c_str());
+    if (protocol && strcmp(protocol, "file") == 0) {
+        FileDataSource fileSource(filePath);
+        if (fileSource.IsOpen()) {
+            LoadSampleTable(&fileSource);
+        }
+    }
+
+    LOG_INFO("Successfully opened video file: ", filePath);
+    LOG_INFO("  Resolution: ", GetWidth(), "x", GetHeight());
+    LOG_INFO("  Frame rate: ", GetFrameRate(), " FPS");
+    LOG_INFO("  Duration: ", GetDuration(), " seconds");
+    AVRational timebase = GetTimeBase();
+    LOG_INFO("  Timebase: ", timebase.num, "/", timebase.den,
+              " (", av_q2d(timebase), " seconds per unit)");
+
+    return true;
+}
+
+bool VideoDemuxer::Open(IDataSource* dataSource, const std::string& format) {
+    Close();
+
+    if (!dataSource) {
+        LOG_ERROR("Invalid data source");
+        return false;
+    }
+
+    m_dataSource = dataSource;
+
+    // Setup custom IO
+    if (!SetupCustomIO(dataSource, format)) {
+        LOG_ERROR("Failed to setup custom IO");
+        Close();
+        return false;
+    }
+
+    // Retrieve stream information, unless the headers already carry the decoder configuration
+    bool headersComplete = dataSource->HasCompleteHeaders() && FindVideoStream() &&
+                           m_videoStream->codecpar->width > 0 && m_videoStream->codecpar->height > 0 &&
+                           m_videoStream->codecpar->extradata_size > 0;
+    if (headersComplete) {
+        LOG_DEBUG("Skipping stream analysis - container headers are complete");
+    } else {
+        BeginOperation(m_deadlines.probeMs);
+        int ret = avformat_find_stream_info(m_formatContext, nullptr);
+        EndOperation(ret, "stream analysis", m_deadlines.probeMs);
+        if (ret < 0) {
+            char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errorBuf, sizeof(errorBuf));
+            LOG_ERROR("Cannot find stream info: ", errorBuf);
+            Close();
+            return false;
+        }
+    }
+
+    // Find video stream
+    if (!FindVideoStream()) {
+        LOG_ERROR("No video stream found");
+        Close();
+        return false;
+    }
+
+    LoadSampleTable(dataSource);
+
+    LOG_INFO("Successfully opened video from custom data source");
+    LOG_INFO("  Resolution: ", GetWidth(), "x", GetHeight());
+    LOG_INFO("  Frame rate: ", GetFrameRate(), " FPS");
+    LOG_INFO("  Duration: ", GetDuration(), " seconds");
+    AVRational timebase = GetTimeBase();
+    LOG_INFO("  Timebase: ", timebase.num, "/", timebase.den,
+              " (", av_q2d(timebase), " seconds per unit)");
+
+    return true;
+}
+
+void VideoDemuxer::Close() {
+    Reset();
+}
+
+void VideoDemuxer::SetProbeCache(std::shared_ptr<ProbeCache> cache) {
+    m_probeCache = std::move(cache);
+}
+
+void VideoDemuxer::SetInterruptFlag(const std::atomic<bool>* flag) {
+    m_interruptFlag = flag;
+}
+
+void VideoDemuxer::SetDeadlines(const DemuxDeadlines& deadlines) {
+    m_deadlines = deadlines;
+}
+
+void VideoDemuxer::Abort() {
+    m_abortFlag->store(true);
+}
+
+void VideoDemuxer::SetAbortFlag(std::atomic<bool>* flag) {
+    m_abortFlag = flag ? flag : &m_abortRequested;
+}
+
+void VideoDemuxer::SetByteCounter(std::atomic<int64_t>* counter) {
+    m_byteCounter = counter;
+}
+
+void VideoDemuxer::UpdateByteCounter() {
+    // Custom I/O counts in ReadPacket; protocols are sampled from their AVIOContext
+    if (!m_byteCounter || m_dataSource || !m_formatContext || !m_formatContext->pb) {
+        return;
+    }
+
+    int64_t total = m_formatContext->pb->bytes_read;
+    if (total > m_bytesCounted) {
+        m_byteCounter->fetch_add(total - m_bytesCounted);
+        m_bytesCounted = total;
+    }
+}
+
+bool VideoDemuxer::IsInterrupted() {
+    if ((m_interruptFlag && m_interruptFlag->load()) || m_abortFlag->load()) {
+        m_lastInterrupt = DemuxInterrupt::Aborted;
+        return true;
+    }
+
+    if (m_deadline != std::chrono::steady_clock::time_point::max() &&
+        std::chrono::steady_clock::now() >= m_deadline) {
+        m_lastInterrupt = DemuxInterrupt::Timeout;
+        return true;
+    }
+    return false;
+}
+
+void VideoDemuxer::BeginOperation(int timeoutMs) {
+    // An abort requested while nothing was running does not carry over. A shared flag
+    // (SetAbortFlag) is left to its owner, which clears it when its own call starts.
+    if (m_abortFlag == &m_abortRequested) {
+        m_abortFlag->store(false);
+    }
+    m_lastInterrupt = DemuxInterrupt::None;
+    m_deadline = timeoutMs > 0
+        ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs)
+        : std::chrono::steady_clock::time_point::max();
+}
+
+bool VideoDemuxer::EndOperation(int result, const char* operation, int timeoutMs) {
+    m_deadline = std::chrono::steady_clock::time_point::max();
+    UpdateByteCounter();
+    if (result >= 0) {
+        // Finished anyway, e.g. from buffered data after the deadline passed
+        m_lastInterrupt = DemuxInterrupt::None;
+    }
+    if (m_lastInterrupt == DemuxInterrupt::None) {
+        return false;
+    }
+
+    if (m_lastInterrupt == DemuxInterrupt::Timeout) {
+        LOG_WARNING("Demuxer ", operation, " timed out after ", timeoutMs, " ms");
+    } else {
+        LOG_WARNING("Demuxer ", operation, " aborted");
+    }
+
+    // An interrupted read marks the byte stream as ended; clear that so the next call retries
+    if (m_formatContext && m_formatContext->pb) {
+        m_formatContext->pb->eof_reached = 0;
+        m_formatContext->pb->error = 0;
+    }
+    return true;
+}
+
+bool VideoDemuxer::ReadFrame(AVPacket* packet) {
+    if (!m_formatContext || m_videoStreamIndex < 0) {
+        LOG_DEBUG("ReadFrame failed - no format context or invalid video stream index");
+        return false;
+    }
+
+    BeginOperation(m_deadlines.readMs);
+    while (true) {
+        int ret = av_read_frame(m_formatContext, packet);
+        if (ret < 0) {
+            if (EndOperation(ret, "read", m_deadlines.readMs)) {
+                return false;
+            }
+            if (ret == AVERROR_EOF) {
+                LOG_DEBUG("End of file reached");
+            } else {
+                char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errorBuf, sizeof(errorBuf));
+                LOG_DEBUG("av_read_frame failed: ", errorBuf, " (ret=", ret, ")");
+            }
+            return false;
+        }
+
+        // Only return packets from the video stream
+        if (packet->stream_index == m_videoStreamIndex) {
+            EndOperation(ret, "read", m_deadlines.readMs);
+            LOG_DEBUG("Read video packet - Size: ", packet->size,
+                     ", PTS: ", packet->pts,
+                     ", DTS: ", packet->dts,
+                     ", Stream: ", packet->stream_index,
+                     ", Flags: ", packet->flags);
+            return true;
+        }
+
+        // Free packet if it's not from the video stream
+        LOG_DEBUG("Skipping non-video packet from stream ", packet->stream_index);
+        av_packet_unref(packet);
+    }
+}
+
+bool VideoDemuxer::SeekToTime(double timeInSeconds) {
+    if (!m_formatContext || !m_videoStream) {
+        return false;
+    }
+
+    int64_t timestamp = SecondsToPacketTime(timeInSeconds);
+
+    LOG_DEBUG("Seeking to time ", timeInSeconds, " seconds (timestamp: ", timestamp, ")");
+
+    BeginOperation(m_deadlines.seekMs);
+    int ret = av_seek_frame(m_formatContext, m_videoStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD);
+    EndOperation(ret, "seek", m_deadlines.seekMs);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Seek failed: ", errorBuf);
+        return false;
+    }
+
+    LOG_DEBUG("Seek completed successfully");
+    return true;
+}
+
+bool VideoDemuxer::SeekToFrame(int64_t frameNumber) {
+    if (!m_formatContext || !m_videoStream) {
+        return false;
+    }
+
+    return SeekToTime(GetFrameTime(frameNumber));
+}
+
+double VideoDemuxer::GetDuration() const {
+    if (!m_formatContext) {
+        return 0.0;
+    }
+
+    if (m_formatContext->duration != AV_NOPTS_VALUE) {
+        return static_cast<double>(m_formatContext->duration) / AV_TIME_BASE;
+    }
+
+    return 0.0;
+}
+
+double VideoDemuxer::GetFrameRate() const {
+    if (!m_videoStream) {
+        return 0.0;
+    }
+
+    if (m_videoStream->avg_frame_rate.num != 0 && m_videoStream->avg_frame_rate.den != 0) {
+        return av_q2d(m_videoStream->avg_frame_rate);
+    } else if (m_videoStream->r_frame_rate.num != 0 && m_videoStream->r_frame_rate.den != 0) {
+        return av_q2d(m_videoStream->r_frame_rate);
+    }
+
+    return 25.0; // Default fallback
+}
+
+int64_t VideoDemuxer::GetFrameCount() const {
+    if (m_sampleTable) {
+        return m_sampleTable->GetFrameCount();
+    }
+    if (!m_videoStream || m_videoStream->nb_frames <= 0) {
+        return 0; // Unknown
+    }
+    return m_videoStream->nb_frames;
+}
+
+double VideoDemuxer::GetFrameTime(int64_t frameNumber) const {
+    if (m_sampleTable) {
+        int64_t timeUs = m_sampleTable->FrameToTimeUs(frameNumber);
+        if (timeUs >= 0) {
+            return static_cast<double>(timeUs) / 1000000.0;
+        }
+    }
+
+    double frameRate = GetFrameRate();
+    return frameRate > 0.0 ? frameNumber / frameRate : 0.0;
+}
+
+int64_t VideoDemuxer::GetFrameNumber(double timeInSeconds) const {
+    if (m_sampleTable) {
+        int64_t frameNumber = m_sampleTable->TimeUsToFrame(static_cast<int64_t>(std::llround(timeInSeconds * 1000000.0)));
+        return frameNumber < 0 ? 0 : frameNumber;
+    }
+
+    return static_cast<int64_t>(std::llround(timeInSeconds * GetFrameRate()));
+}
+
+const Mp4SampleTable* VideoDemuxer::GetSampleTable() const {
+    return m_sampleTable.get();
+}
+
+int VideoDemuxer::GetWidth() const {
+    if (!m_videoStream) {
+        return 0;
+    }
+    return m_videoStream->codecpar->width;
+}
+
+int VideoDemuxer::GetHeight() const {
+    if (!m_videoStream) {
+        return 0;
+    }
+    return m_videoStream->codecpar->height;
+}
+
+AVCodecID VideoDemuxer::GetCodecID() const {
+    if (!m_videoStream) {
+        return AV_CODEC_ID_NONE;
+    }
+    return m_videoStream->codecpar->codec_id;
+}
+
+AVCodecParameters* VideoDemuxer::GetCodecParameters() const {
+    if (!m_videoStream) {
+        return nullptr;
+    }
+    return m_videoStream->codecpar;
+}
+
+int VideoDemuxer::GetVideoStreamIndex() const {
+    return m_videoStreamIndex;
+}
+
+AVRational VideoDemuxer::GetTimeBase() const {
+    if (!m_videoStream) {
+        return {0, 1};
+    }
+    return m_videoStream->time_base;
+}
+
+double VideoDemuxer::PacketTimeToSeconds(int64_t pts) const {
+    if (!m_videoStream || pts == AV_NOPTS_VALUE) {
+        return 0.0;
+    }
+    return static_cast<double>(pts) * av_q2d(m_videoStream->time_base);
+}
+
+int64_t VideoDemuxer::SecondsToPacketTime(double seconds) const {
+    if (!m_videoStream) {
+        return 0;
+    }
+    return static_cast<int64_t>(seconds / av_q2d(m_videoStream->time_base));
+}
+
+bool VideoDemuxer::IsValidPacket(const AVPacket* packet) const {
+    return packet && packet->stream_index == m_videoStreamIndex;
+}
+
+bool VideoDemuxer::FindVideoStream() {
+    if (!m_formatContext) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            m_videoStreamIndex = i;
+            m_videoStream = m_formatContext->streams[i];
+
+            // Validate codec support (H264/H265/AV1 only)
+            AVCodecID codecId = m_videoStream->codecpar->codec_id;
+            if (codecId != AV_CODEC_ID_H264 && codecId != AV_CODEC_ID_HEVC && codecId != AV_CODEC_ID_AV1) {
+                LOG_ERROR("Unsupported video codec found. Only H264, H265, and AV1 are supported.");
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void VideoDemuxer::LoadSampleTable(IDataSource* dataSource) {
+    m_sampleTable.reset();
+
+    if (!m_formatContext || !m_formatContext->iformat || !dataSource || !dataSource->IsSeekable() ||
+        !strstr(m_formatContext->iformat->name, "mp4")) {
+        return;
+    }
+
+    // Parse on the side and restore the position AVIOContext expects
+    int64_t position = dataSource->Seek(0, SEEK_CUR);
+    auto sampleTable = std::make_unique<Mp4SampleTable>();
+    bool parsed = sampleTable->Parse(dataSource);
+    if (position >= 0) {
+        dataSource->Seek(position, SEEK_SET);
+    }
+
+    if (parsed) {
+        m_sampleTable = std::move(sampleTable);
+        LOG_INFO("  Frame table: ", m_sampleTable->GetFrameCount(), " frames, ",
+                 m_sampleTable->GetKeyframes().size(), " keyframes");
+    }
+}
+
+bool VideoDemuxer::SetupCustomIO(IDataSource* dataSource, const std::string& format) {
+    const size_t IO_BUFFER_SIZE = 32768; // 32KB buffer
+
+    // Allocate IO buffer
+    m_ioBuffer = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
+    if (!m_ioBuffer) {
+        LOG_ERROR("Failed to allocate IO buffer");
+        return false;
+    }
+
+    // Create AVIOContext with custom callbacks
+    m_ioContext = avio_alloc_context(
+        m_ioBuffer,
+        IO_BUFFER_SIZE,
+        0,                          // write_flag (0 = read-only)
+        this,                       // opaque user data
+        &VideoDemuxer::ReadPacket,  // read_packet callback
+        nullptr,                    // write_packet callback
+        &VideoDemuxer::Seek         // seek callback
+    );
+
+    if (!m_ioContext) {
+        LOG_ERROR("Failed to allocate AVIOContext");
+        av_free(m_ioBuffer);
+        m_ioBuffer = nullptr;
+        return false;
+    }
+
+    // Allocate format context
+    m_formatContext = avformat_alloc_context();
+    if (!m_formatContext) {
+        LOG_ERROR("Failed to allocate AVFormatContext");
+        return false;
+    }
+
+    // Live sources: keep demuxers from attempting seeks (e.g. looking for an index at the end)
+    if (!dataSource->IsSeekable()) {
+        m_ioContext->seekable = 0;
+    }
+
+    m_formatContext->interrupt_callback.callback = &VideoDemuxer::InterruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+
+    // Assign custom IO context
+    m_formatContext->pb = m_ioContext;
+    m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    // Determine input format
+    const AVInputFormat* inputFormat = nullptr;
+    if (!format.empty()) {
+        inputFormat = av_find_input_format(format.c_str());
+        if (!inputFormat) {
+            LOG_WARNING("Could not find input format: ", format);
+        }
+    }
+
+    // Open input (with empty filename for custom IO)
+    BeginOperation(m_deadlines.openMs);
+    int ret = avformat_open_input(&m_formatContext, "", inputFormat, nullptr);
+    EndOperation(ret, "open", m_deadlines.openMs);
+    if (ret < 0) {
+        char errorBuf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, errorBuf, sizeof(errorBuf));
+        LOG_ERROR("Cannot open custom input: ", errorBuf);
+        return false;
+    }
+
+    LOG_DEBUG("Custom IO setup complete");
+    return true;
+}
+
+void VideoDemuxer::Reset() {
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+        m_formatContext = nullptr;
+    }
+
+    if (m_ioContext) {
+        // Note: ioContext->buffer is freed by avformat_close_input if the context was used
+        // If not, we need to free it manually
+        if (m_ioBuffer) {
+            av_freep(&m_ioContext->buffer);
+        }
+        avio_context_free(&m_ioContext);
+        m_ioContext = nullptr;
+    }
+
+    if (m_ioBuffer) {
+        // Already freed by avio_context_free or avformat_close_input
+        m_ioBuffer = nullptr;
+    }
+
+    m_dataSource = nullptr;
+    m_bytesCounted = 0;
+    m_sampleTable.reset();
+    m_videoStreamIndex = -1;
+    m_videoStream = nullptr;
+}
+
+int VideoDemuxer::InterruptCallback(void* opaque) {
+    // Polled while protocols wait for data, which makes it a good place to publish progress
+    VideoDemuxer* demuxer = static_cast<VideoDemuxer*>(opaque);
+    demuxer->UpdateByteCounter();
+    return demuxer->IsInterrupted() ? 1 : 0;
+}
+
+int VideoDemuxer::ReadPacket(void* opaque, uint8_t* buf, int buf_size) {
+    VideoDemuxer* demuxer = static_cast<VideoDemuxer*>(opaque);
+    IDataSource* dataSource = demuxer->m_dataSource;
+    if (!dataSource) {
+        return AVERROR(EIO);
+    }
+
+    // Custom I/O does not consult the interrupt callback on its own
+    if (demuxer->IsInterrupted()) {
+        return AVERROR_EXIT;
+    }
+
+    int bytesRead = dataSource->Read(buf, buf_size);
+    if (bytesRead < 0) {
+        // Return FFmpeg error code
+        return bytesRead;
+    }
+    if (bytesRead == 0) {
+        // End of file
+        return AVERROR_EOF;
+    }
+
+    if (demuxer->m_byteCounter) {
+        demuxer->m_byteCounter->fetch_add(bytesRead);
+    }
+    return bytesRead;
+}
+
+int64_t VideoDemuxer::Seek(void* opaque, int64_t offset, int whence) {
+    IDataSource* dataSource = static_cast<VideoDemuxer*>(opaque)->m_dataSource;
+    if (!dataSource) {
+        return AVERROR(EIO);
+    }
+
+    if (!dataSource->IsSeekable()) {
+        return AVERROR(ENOSYS);
+    }
+
+    return dataSource->Seek(offset, whence);
 }
\ No newline at end of file
@@ -1,56 +1,123 @@
-#pragma once
-
-#include <string>
-#include <memory>
-
-extern "C" {
-#include <libavformat/avformat.h>
-#include <libavcodec/avcodec.h>
-}
-
-class IDataSource;
-
-class VideoDemuxer {
-public:
-    VideoDemuxer();
-    ~VideoDemuxer();
-
-    bool Open(const std::string& filePath);
-    bool Open(IDataSource* dataSource, const std::string& format = "");
-    void Close();
-
-    bool ReadFrame(AVPacket* packet);
-    bool SeekToTime(double timeInSeconds);
-    bool SeekToFrame(int64_t frameNumber);
-
-    // Getters
-    double GetDuration() const;
-    double GetFrameRate() const;
-    int GetWidth() const;
-    int GetHeight() const;
-    AVCodecID GetCodecID() const;
-    AVCodecParameters* GetCodecParameters() const;
-    int GetVideoStreamIndex() const;
-    AVRational GetTimeBase() const;
-
-    // Utility functions
-    double PacketTimeToSeconds(int64_t pts) const;
-    int64_t SecondsToPacketTime(double seconds) const;
-    bool IsValidPacket(const AVPacket* packet) const;
-
-private:
-    AVFormatContext* m_formatContext;
-    AVIOContext* m_ioContext;
-    IDataSource* m_dataSource;
-    uint8_t* m_ioBuffer;
-    int m_videoStreamIndex;
-    AVStream* m_videoStream;
-
-    bool FindVideoStream();
-    bool SetupCustomIO(IDataSource* dataSource, const std::string& format);
-    void Reset();
-
-    // Static callbacks for AVIOContext
-    static int ReadPacket(void* opaque, uint8_t* buf, int buf_size);
-    static int64_t Seek(void* opaque, int64_t offset, int whence);
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+class IDataSource;
+class ProbeCache;
+class Mp4SampleTable;
+
+// Why the last demuxer operation stopped early
+enum class DemuxInterrupt {
+    None,
+    Timeout,        // Ran past its deadline
+    Aborted         // Abort() or the interrupt flag
+};
+
+// Time limits for blocking operations in milliseconds; 0 = no limit
+struct DemuxDeadlines {
+    int openMs = 0;         // Connect and read the container headers
+    int probeMs = 0;        // Stream analysis
+    int readMs = 0;         // One ReadFrame() call
+    int seekMs = 0;         // One SeekToTime()/SeekToFrame() call
+};
+
+class VideoDemuxer {
+public:
+    VideoDemuxer();
+    ~VideoDemuxer();
+
+    bool Open(const std::string& filePath);
+    bool Open(const std::string& filePath, AVDictionary** options);   // Demuxer/protocol options (e.g. RTSP)
+    bool Open(IDataSource* dataSource, const std::string& format = "");
+    void Close();
+
+    // Optional persistent cache of stream analysis for file opens; the demuxer keeps a reference
+    void SetProbeCache(std::shared_ptr<ProbeCache> cache);
+
+    // Flag that aborts blocking FFmpeg and data source I/O when set (from any thread)
+    void SetInterruptFlag(const std::atomic<bool>* flag);
+
+    void SetDeadlines(const DemuxDeadlines& deadlines);
+
+    /**
+     * Interrupt the operation in progress from any thread; it fails with DemuxInterrupt::Aborted.
+     * Has no effect when no operation is running. The demuxer stays usable either way.
+     */
+    void Abort();
+
+    // Use an abort flag owned by the caller (nullptr restores the demuxer's own), so Abort()
+    // can be requested without reaching the demuxer itself. The demuxer never clears a
+    // caller's flag; the caller resets it before the calls it wants to be abortable.
+    void SetAbortFlag(std::atomic<bool>* flag);
+
+    // Counter that receives the bytes read from the source, for progress monitoring from
+    // other threads (not reported by demuxers without a byte stream, e.g. RTSP)
+    void SetByteCounter(std::atomic<int64_t>* counter);
+
+    // Why the last Open/ReadFrame/Seek call was cut short, None if it was not
+    DemuxInterrupt GetLastInterrupt() const { return m_lastInterrupt; }
+
+    bool ReadFrame(AVPacket* packet);
+    bool SeekToTime(double timeInSeconds);
+    bool SeekToFrame(int64_t frameNumber);
+
+    // Getters
+    double GetDuration() const;
+    double GetFrameRate() const;
+    int64_t GetFrameCount() const;
+    double GetFrameTime(int64_t frameNumber) const;
+    int64_t GetFrameNumber(double timeInSeconds) const;
+    const Mp4SampleTable* GetSampleTable() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    AVCodecID GetCodecID() const;
+    AVCodecParameters* GetCodecParameters() const;
+    int GetVideoStreamIndex() const;
+    AVRational GetTimeBase() const;
+
+    // Utility functions
+    double PacketTimeToSeconds(int64_t pts) const;
+    int64_t SecondsToPacketTime(double seconds) const;
+    bool IsValidPacket(const AVPacket* packet) const;
+
+private:
+    AVFormatContext* m_formatContext;
+    AVIOContext* m_ioContext;
+    IDataSource* m_dataSource;
+    uint8_t* m_ioBuffer;
+    int m_videoStreamIndex;
+    AVStream* m_videoStream;
+    std::shared_ptr<ProbeCache> m_probeCache;
+    const std::atomic<bool>* m_interruptFlag;
+    std::atomic<bool> m_abortRequested;
+    std::atomic<bool>* m_abortFlag;
+    DemuxDeadlines m_deadlines;
+    std::chrono::steady_clock::time_point m_deadline;  // Of the running operation, max() if none
+    DemuxInterrupt m_lastInterrupt;
+    std::atomic<int64_t>* m_byteCounter;
+    int64_t m_bytesCounted;                             // Of the current AVIOContext
+    std::unique_ptr<Mp4SampleTable> m_sampleTable;
+
+    bool FindVideoStream();
+    void LoadSampleTable(IDataSource* dataSource);
+    bool SetupCustomIO(IDataSource* dataSource, const std::string& format);
+    void Reset();
+
+    bool IsInterrupted();
+    void UpdateByteCounter();
+    void BeginOperation(int timeoutMs);
+    bool EndOperation(int result, const char* operation, int timeoutMs);
+
+    // Static callbacks for AVIOContext and AVIOInterruptCB
+    static int InterruptCallback(void* opaque);
+    static int ReadPacket(void* opaque, uint8_t* buf, int buf_size);
+    static int64_t Seek(void* opaque, int64_t offset, int whence);
 };
\ No newline at end of file